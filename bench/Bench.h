@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstddef>
+
+class PackedIR;
+
+// Генерация синтетической корректной программы MiniLang размером не меньше target_bytes
+std::string generateProgram(size_t target_bytes, unsigned seed = 1);
+// depth вложенных циклов while
+std::string generateNestedLoops(int depth);
+// count последовательных циклов с ветвлением в теле
+std::string generateSequentialLoops(int count);
+
+// Однопроходная трансляция с семантическим анализом (без рекурсии по вложенности);
+// false — программа содержит ошибки
+bool translate(const std::string& source, PackedIR& code);
+
+// Простой таймер для замеров
+class BenchTimer {
+private:
+    std::chrono::steady_clock::time_point start_;
+public:
+    BenchTimer() : start_(std::chrono::steady_clock::now()) {}
+    void reset() { start_ = std::chrono::steady_clock::now(); }
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+};
+
+// Бенчмарки по подсистемам (возвращают код завершения)
+int runLexerBenchmark();
+int runParserBenchmark();
+int runIncrementalBenchmark();
+int runTraversalBenchmark();
+int runSerializeBenchmark();
+int runModuleBenchmark();
+int runCfgBenchmark();
+int runDataflowBenchmark();
+int runInductionBenchmark();
@@ -0,0 +1,41 @@
+#include "Bench.h"
+#include <iostream>
+#include <string>
+
+// Точка входа бенчмарков: без аргументов запускаются все, иначе — перечисленные
+int main(int argc, char** argv) {
+    struct Benchmark {
+        const char* name;
+        int (*run)();
+    };
+    const Benchmark benchmarks[] = {
+        {"lexer", runLexerBenchmark},
+        {"parser", runParserBenchmark},
+        {"incremental", runIncrementalBenchmark},
+        {"traversal", runTraversalBenchmark},
+        {"serialize", runSerializeBenchmark},
+        {"module", runModuleBenchmark},
+        {"cfg", runCfgBenchmark},
+        {"dataflow", runDataflowBenchmark},
+        {"induction", runInductionBenchmark}
+    };
+
+    int result = 0;
+    for (const Benchmark& bench : benchmarks) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc; ++i) {
+            if (std::string(argv[i]) == bench.name) {
+                selected = true;
+            }
+        }
+        if (!selected) {
+            continue;
+        }
+        std::cout << "=== " << bench.name << " ===\n";
+        int code = bench.run();
+        if (code != 0) {
+            result = code;
+        }
+    }
+    return result;
+}
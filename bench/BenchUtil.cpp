@@ -0,0 +1,173 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SemanticAnalyzer.h"
+#include "ErrorHandler.h"
+#include "PackedIR.h"
+#include <random>
+
+namespace {
+    // Генератор операторов с ограниченной вложенностью и конечными циклами
+    class ProgramGenerator {
+    private:
+        std::mt19937 rng_;
+        std::string& out_;
+        int var_count_;
+        int counter_id_ = 0;
+        int statement_count_ = 0;
+
+        int random(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng_); }
+
+        void indent(int depth) { out_.append((size_t)depth * 4, ' '); }
+
+        void variable() {
+            out_ += 'v';
+            out_ += std::to_string(random(0, var_count_ - 1));
+        }
+
+        void expression(int depth) {
+            int kind = depth >= 3 ? random(0, 1) : random(0, 4);
+            switch (kind) {
+                case 0: variable(); break;
+                case 1: out_ += std::to_string(random(0, 99)); break;
+                case 2:
+                    expression(depth + 1);
+                    out_ += random(0, 1) ? " + " : " - ";
+                    expression(depth + 1);
+                    break;
+                case 3:
+                    expression(depth + 1);
+                    out_ += " * ";
+                    expression(depth + 1);
+                    break;
+                default:
+                    out_ += '(';
+                    expression(depth + 1);
+                    out_ += ") / ";
+                    out_ += std::to_string(random(1, 9));
+                    break;
+            }
+        }
+
+        void condition() {
+            static const char* const ops[] = {" < ", " > ", " == ", " != "};
+            expression(1);
+            out_ += ops[random(0, 3)];
+            expression(1);
+        }
+
+        void block(int depth, int count) {
+            for (int i = 0; i < count; ++i) {
+                statement(depth);
+            }
+        }
+
+    public:
+        ProgramGenerator(std::string& out, unsigned seed, int var_count)
+            : rng_(seed), out_(out), var_count_(var_count) {}
+
+        void prologue() {
+            for (int i = 0; i < var_count_; ++i) {
+                out_ += "int v" + std::to_string(i) + ";\n";
+            }
+            for (int i = 0; i < var_count_; ++i) {
+                out_ += "v" + std::to_string(i) + " = " + std::to_string(i + 1) + ";\n";
+            }
+        }
+
+        void statement(int depth) {
+            ++statement_count_;
+            if (statement_count_ % 16 == 0) {
+                indent(depth);
+                out_ += "// generated statement " + std::to_string(statement_count_) + "\n";
+            }
+
+            int kind = depth >= 2 ? random(0, 5) : random(0, 7);
+            if (kind <= 3) {
+                indent(depth);
+                variable();
+                out_ += " = ";
+                expression(0);
+                out_ += ";\n";
+            } else if (kind <= 5) {
+                indent(depth);
+                out_ += "print ";
+                expression(0);
+                out_ += ";\n";
+            } else if (kind == 6) {
+                indent(depth);
+                out_ += "if (";
+                condition();
+                out_ += ") {\n";
+                block(depth + 1, random(1, 3));
+                indent(depth);
+                if (random(0, 1)) {
+                    out_ += "} else {\n";
+                    block(depth + 1, random(1, 3));
+                    indent(depth);
+                }
+                out_ += "}\n";
+            } else {
+                std::string counter = "c" + std::to_string(counter_id_++);
+                indent(depth);
+                out_ += "int " + counter + ";\n";
+                indent(depth);
+                out_ += counter + " = 0;\n";
+                indent(depth);
+                out_ += "while (" + counter + " < 3) {\n";
+                block(depth + 1, random(1, 3));
+                indent(depth + 1);
+                out_ += counter + " = " + counter + " + 1;\n";
+                indent(depth);
+                out_ += "}\n";
+            }
+        }
+    };
+}
+
+std::string generateProgram(size_t target_bytes, unsigned seed) {
+    std::string out;
+    out.reserve(target_bytes + 4096);
+
+    ProgramGenerator generator(out, seed, 16);
+    generator.prologue();
+    while (out.size() < target_bytes) {
+        generator.statement(0);
+    }
+    return out;
+}
+
+std::string generateNestedLoops(int depth) {
+    std::string source = "int v;\nv = 0;\n";
+    for (int i = 0; i < depth; ++i) {
+        source += "while (v < 1) {\n";
+    }
+    source += "v = v + 1;\n";
+    for (int i = 0; i < depth; ++i) {
+        source += "}\n";
+    }
+    return source;
+}
+
+std::string generateSequentialLoops(int count) {
+    std::string source = "int v;\nint w;\nv = 0;\nw = 0;\n";
+    for (int i = 0; i < count; ++i) {
+        source += "while (v < 3) { if (w > v) { w = w - 1; } else { w = w + 2; } v = v + 1; }\nv = 0;\n";
+    }
+    return source;
+}
+
+bool translate(const std::string& source, PackedIR& code) {
+    ErrorHandler error_handler;
+    Lexer lexer(source, &error_handler);
+    lexer.runLexer();
+    Parser parser(&lexer, &error_handler);
+    SymbolTable symbols;
+    SemanticAnalyzer semantics(symbols, &error_handler);
+    IRCode generated;
+    if (!parser.translateProgram(generated, &semantics) || error_handler.hasErrors()) {
+        return false;
+    }
+    code = PackedIR::fromCode(generated);
+    return true;
+}
@@ -0,0 +1,125 @@
+#include "Bench.h"
+#include "ControlFlowGraph.h"
+#include "SSAForm.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+// Построение графа потока управления, анализ (предшественники, обратный постпорядок,
+// доминаторы, циклы), построение SSA-формы и выход из неё, линеаризация. Время на
+// инструкцию должно оставаться почти постоянным с ростом программы и глубины
+// вложенности циклов
+int runCfgBenchmark() {
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+
+    struct Input {
+        std::string name;
+        std::string source;
+    };
+    std::vector<Input> inputs;
+    inputs.push_back({"1 MB program", generateProgram(1u << 20)});
+    inputs.push_back({"16 MB program", generateProgram(16u << 20)});
+    inputs.push_back({"10k nested loops", generateNestedLoops(10000)});
+    inputs.push_back({"100k nested loops", generateNestedLoops(100000)});
+    inputs.push_back({"100k sequential loops", generateSequentialLoops(100000)});
+
+    for (const Input& input : inputs) {
+        PackedIR code;
+        std::cout.rdbuf(sink.rdbuf());
+        const bool ok = translate(input.source, code);
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!ok) {
+            std::cerr << "[BENCH] Unexpected errors while compiling " << input.name << ".\n";
+            return 1;
+        }
+        // linearize() оставляет только метки целей переходов, а генератор ставит
+        // метку конца и после if без else: такие метки из ожидаемого кода убираются
+        std::pmr::vector<uint8_t> jumped(code.labels().size(), 0);
+        for (const PackedInstruction& instr : code.code()) {
+            if (instr.op == IROpCode::JMP || instr.op == IROpCode::JMP_IF_ZERO) {
+                const int field = instr.op == IROpCode::JMP ? PackedInstruction::ARG1 : PackedInstruction::ARG2;
+                jumped[instr.operand(field)] = 1;
+            }
+        }
+        PackedIR expected = code;
+        std::erase_if(expected.code(), [&](const PackedInstruction& instr) {
+            return instr.op == IROpCode::LABEL && !jumped[instr.operand(PackedInstruction::ARG1)];
+        });
+        expected.rebuildLabels();
+        std::ostringstream before;
+        expected.print(before);
+
+        double build_seconds = 1e30;
+        double analyze_seconds = 1e30;
+        double linearize_seconds = 1e30;
+        size_t blocks = 0;
+        size_t loops = 0;
+        uint32_t max_depth = 0;
+        for (int it = 0; it < 3; ++it) {
+            PackedIR copy = code;
+            BenchTimer timer;
+            ControlFlowGraph cfg(copy);
+            build_seconds = std::min(build_seconds, timer.seconds());
+            timer.reset();
+            cfg.analyze();
+            analyze_seconds = std::min(analyze_seconds, timer.seconds());
+            timer.reset();
+            cfg.linearize(copy);
+            linearize_seconds = std::min(linearize_seconds, timer.seconds());
+
+            blocks = cfg.blockCount();
+            loops = cfg.loops().size();
+            for (const Loop& loop : cfg.loops()) {
+                max_depth = std::max(max_depth, loop.depth);
+            }
+            std::ostringstream after;
+            copy.print(after);
+            if (after.str() != before.str()) {
+                std::cerr << "[BENCH] Linearized code differs from the original for " << input.name << ".\n";
+                return 1;
+            }
+        }
+
+        const double total = build_seconds + analyze_seconds + linearize_seconds;
+        std::cout << "cfg: " << std::left << std::setw(22) << input.name << std::right << std::setw(9)
+                  << code.size() << " instructions, " << std::setw(8) << blocks << " blocks, " << std::setw(7)
+                  << loops << " loops (depth " << max_depth << "); " << std::fixed << std::setprecision(2)
+                  << "build " << build_seconds * 1e3 << " ms, analyze " << analyze_seconds * 1e3
+                  << " ms, linearize " << linearize_seconds * 1e3 << " ms, " << std::setprecision(1)
+                  << total * 1e9 / (double)code.size() << " ns/instruction\n";
+
+        // SSA-форма: без промежуточных преобразований все копии φ-функций сливаются
+        double ssa_seconds = 1e30;
+        double destruct_seconds = 1e30;
+        size_t phis = 0;
+        size_t values = 0;
+        size_t copies_inserted = 0;
+        size_t copies_coalesced = 0;
+        for (int it = 0; it < 3; ++it) {
+            PackedIR copy = code;
+            ControlFlowGraph cfg(copy);
+            cfg.analyze();
+            BenchTimer timer;
+            SSAForm ssa(cfg, copy);
+            ssa_seconds = std::min(ssa_seconds, timer.seconds());
+            timer.reset();
+            ssa.destruct();
+            destruct_seconds = std::min(destruct_seconds, timer.seconds());
+            phis = ssa.phiCount();
+            values = ssa.valueCount();
+            copies_inserted = ssa.copiesInserted();
+            copies_coalesced = ssa.copiesCoalesced();
+        }
+        std::cout << "ssa: " << std::left << std::setw(22) << input.name << std::right << std::setw(9) << phis
+                  << " phis, " << std::setw(8) << values << " values, copies " << copies_coalesced << "/"
+                  << copies_inserted << " coalesced; " << std::fixed << std::setprecision(2) << "build "
+                  << ssa_seconds * 1e3 << " ms, out of SSA " << destruct_seconds * 1e3 << " ms, "
+                  << std::setprecision(1) << (ssa_seconds + destruct_seconds) * 1e9 / (double)code.size()
+                  << " ns/instruction\n";
+    }
+    return 0;
+}
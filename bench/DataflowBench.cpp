@@ -0,0 +1,79 @@
+#include "Bench.h"
+#include "Dataflow.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Лучшее из трёх время построения задачи и решения до неподвижной точки
+    template <typename Analysis>
+    void measure(const char* input, const char* name, const ControlFlowGraph& cfg, const PackedIR& code) {
+        double seconds = 1e30;
+        size_t bits = 0;
+        size_t words = 0;
+        size_t visits = 0;
+        size_t bytes = 0;
+        for (int it = 0; it < 3; ++it) {
+            BenchTimer timer;
+            Analysis analysis(cfg, code.slotCount());
+            seconds = std::min(seconds, timer.seconds());
+            bits = analysis.solution().bitCount();
+            words = analysis.solution().wordCount();
+            visits = analysis.solution().visits();
+            bytes = analysis.solution().memoryBytes();
+        }
+        const double block_words = (double)cfg.blockCount() * (double)std::max<size_t>(words, 1);
+        std::cout << "dataflow: " << std::left << std::setw(22) << input << std::setw(11) << name << std::right
+                  << std::setw(7) << bits << " bits, " << std::fixed << std::setprecision(2)
+                  << (double)visits / (double)cfg.reversePostorder().size() << " visits/block, " << std::setw(7)
+                  << (double)bytes / (1024.0 * 1024.0) << " MB; " << std::setw(8) << seconds * 1e3 << " ms, "
+                  << std::setprecision(1) << std::setw(6) << seconds * 1e9 / (double)code.size()
+                  << " ns/instruction, " << std::setprecision(2) << seconds * 1e9 / block_words
+                  << " ns/(block*word)\n";
+    }
+}
+
+// Живые переменные, достигающие определения и доступные выражения на больших
+// программах. Плотные множества стоят O(блоки × размер множества): в сгенерированных
+// программах у каждого цикла свой счётчик, и число глобальных имён растёт вместе с
+// программой, поэтому постоянным должно оставаться время на слово строки блока;
+// на циклах с фиксированным набором переменных — и время на инструкцию
+int runDataflowBenchmark() {
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+
+    struct Input {
+        std::string name;
+        std::string source;
+    };
+    std::vector<Input> inputs;
+    inputs.push_back({"64 KB program", generateProgram(64u << 10)});
+    inputs.push_back({"256 KB program", generateProgram(256u << 10)});
+    inputs.push_back({"1 MB program", generateProgram(1u << 20)});
+    inputs.push_back({"10k nested loops", generateNestedLoops(10000)});
+    inputs.push_back({"100k nested loops", generateNestedLoops(100000)});
+    inputs.push_back({"1k sequential loops", generateSequentialLoops(1000)});
+    inputs.push_back({"4k sequential loops", generateSequentialLoops(4000)});
+
+    for (const Input& input : inputs) {
+        PackedIR code;
+        std::cout.rdbuf(sink.rdbuf());
+        const bool ok = translate(input.source, code);
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!ok) {
+            std::cerr << "[BENCH] Unexpected errors while compiling " << input.name << ".\n";
+            return 1;
+        }
+        ControlFlowGraph cfg(code);
+        cfg.analyze();
+        std::cout << "dataflow: " << input.name << ": " << code.size() << " instructions, " << cfg.blockCount()
+                  << " blocks\n";
+        measure<LivenessAnalysis>(input.name.c_str(), "liveness", cfg, code);
+        measure<ReachingDefinitions>(input.name.c_str(), "reaching", cfg, code);
+        measure<AvailableExpressions>(input.name.c_str(), "available", cfg, code);
+    }
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "ASTSerializer.h"
+#include "ErrorHandler.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <vector>
+
+namespace {
+    // Правка, заданная поиском образца после середины документа
+    // (anchor == nullptr — в месте предыдущей правки, пустой образец — начало файла)
+    struct EditCase {
+        const char* name;
+        const char* anchor;       // Образец, в начале которого применяется правка
+        size_t skip;              // Сдвиг от начала образца
+        size_t removed;
+        const char* inserted;
+    };
+
+    const EditCase EDIT_CASES[] = {
+        {"insert statement", "\n", 1, 0, "print 42;\n"},
+        {"delete statement", nullptr, 0, 10, ""},
+        {"grow literal", " = 1", 3, 0, "7"},
+        {"change operator", " + ", 1, 1, "*"},
+        {"break braces", "\n", 1, 0, "{\n"},
+        {"restore braces", nullptr, 0, 2, ""},
+        {"insert at start", "", 0, 0, "int c;\n"}
+    };
+
+    // Двоичный дамп AST: компактен и на 16 МБ и включает разметку токенов блоков
+    std::string dumpAst(ASTNode* root) {
+        std::ostringstream out;
+        if (root) {
+            OutputSink sink(out);
+            ASTSerializer::writeBinary(*root, sink);
+        }
+        return out.str();
+    }
+
+    // Потоки токенов сравниваются попарно, без промежуточного текста
+    bool sameTokens(Lexer& expected, Lexer& actual) {
+        expected.seekToken(0);
+        actual.seekToken(0);
+        for (;;) {
+            const Token& a = expected.getNextToken();
+            const Token& b = actual.getNextToken();
+            if (a.type != b.type || a.value != b.value || a.line != b.line || a.position != b.position) {
+                return false;
+            }
+            if (a.type == TokenType::TOKEN_EOF) {
+                return true;
+            }
+        }
+    }
+
+    // Документ с лексером и деревом, обновляемыми инкрементально
+    struct Document {
+        std::string text;
+        ErrorHandler errors;
+        std::unique_ptr<Lexer> lexer;
+        std::unique_ptr<Parser> parser;
+        std::unique_ptr<ASTNode> ast;
+
+        explicit Document(std::string source) : text(std::move(source)) {
+            lexer = std::make_unique<Lexer>(text, &errors);
+            lexer->runLexer();
+            parser = std::make_unique<Parser>(lexer.get(), &errors);
+            ast = parser->parseProgram();
+        }
+    };
+
+    // Разбор с нуля для сравнения
+    std::unique_ptr<ASTNode> fullParse(Lexer& lexer, ErrorHandler& errors) {
+        lexer.runLexer();
+        Parser parser(&lexer, &errors);
+        return parser.parseProgram();
+    }
+}
+
+// Задержка инкрементального анализа правки против полного повторного анализа
+int runIncrementalBenchmark() {
+    const size_t sizes[] = {1u << 20, 16u << 20};
+
+    // Парсер сообщает о ходе разбора в std::cout и std::cerr — на время замеров вывод подавляется
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+    std::streambuf* console_err = std::cerr.rdbuf(sink.rdbuf());
+
+    for (size_t size : sizes) {
+        std::cout.rdbuf(sink.rdbuf());
+        Document doc(generateProgram(size));
+
+        BenchTimer full_timer;
+        {
+            ErrorHandler errors;
+            Lexer lexer(doc.text, &errors);
+            fullParse(lexer, errors);
+        }
+        const double full = full_timer.seconds();
+        std::cout.rdbuf(console);
+
+        double mb = (double)doc.text.size() / (1024.0 * 1024.0);
+        std::cout << "incremental: " << std::fixed << std::setprecision(1) << mb << " MB, full lex+parse "
+                  << std::setprecision(2) << full * 1e3 << " ms\n";
+
+        size_t previous_offset = 0;
+        for (const EditCase& edit_case : EDIT_CASES) {
+            size_t at = previous_offset;
+            if (edit_case.anchor && !*edit_case.anchor) {
+                at = 0;
+            } else if (edit_case.anchor) {
+                at = doc.text.find(edit_case.anchor, doc.text.size() / 2);
+                if (at == std::string::npos) {
+                    std::cerr.rdbuf(console_err);
+                    std::cerr << "[BENCH] Anchor not found for edit '" << edit_case.name << "'.\n";
+                    return 1;
+                }
+                at += edit_case.skip;
+            }
+            previous_offset = at;
+
+            std::string new_text = doc.text;
+            TextEdit edit;
+            edit.offset = at;
+            edit.removed_length = edit_case.removed;
+            edit.inserted_text = edit_case.inserted;
+            new_text.replace(edit.offset, edit.removed_length, edit.inserted_text);
+
+            std::cout.rdbuf(sink.rdbuf());
+            BenchTimer timer;
+            RelexResult damage = doc.lexer->relex(new_text, edit);
+            bool reused = doc.parser->reparse(doc.ast, damage);
+            const double elapsed = timer.seconds();
+            doc.text = std::move(new_text);  // Буфер строки переходит без копирования: токены остаются действительными
+            std::cout.rdbuf(console);
+
+            std::cout << "  " << std::left << std::setw(18) << edit_case.name << std::right
+                      << std::setw(9) << std::setprecision(3) << elapsed * 1e3 << " ms, "
+                      << (reused ? "partial" : "full fallback")
+                      << ", tokens " << damage.old_end_token - damage.first_token
+                      << " -> " << damage.new_end_token - damage.first_token << "\n";
+
+            // Результат сверяется с полным разбором на обоих размерах
+            std::cout.rdbuf(sink.rdbuf());
+            ErrorHandler errors;
+            Lexer lexer(doc.text, &errors);
+            std::unique_ptr<ASTNode> expected = fullParse(lexer, errors);
+            const bool same = sameTokens(lexer, *doc.lexer) && dumpAst(expected.get()) == dumpAst(doc.ast.get());
+            std::cout.rdbuf(console);
+            if (!same) {
+                std::cerr.rdbuf(console_err);
+                std::cerr << "[BENCH] Incremental result differs from full parse after '"
+                          << edit_case.name << "'.\n";
+                return 1;
+            }
+            sink.str("");
+        }
+    }
+    std::cerr.rdbuf(console_err);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "Bench.h"
+#include "IROptimizer.h"
+#include "IRInterpreter.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Состав выполненных инструкций одного запуска по группам операций
+    struct Mix {
+        size_t total = 0;
+        size_t mul = 0;
+        size_t add = 0;      // ADD и SUB
+        size_t compare = 0;
+        size_t copy = 0;     // ASSIGN и LOAD_IMM
+        size_t jump = 0;     // JMP, JMP_IF_ZERO и проход через LABEL
+        std::string prints;
+    };
+
+    Mix run(const PackedIR& code) {
+        std::ostringstream trace;
+        std::streambuf* console = std::cout.rdbuf(trace.rdbuf());
+        IRInterpreter interpreter;
+        interpreter.execute(code);
+        std::cout.rdbuf(console);
+
+        Mix mix;
+        mix.total = interpreter.executedCount();
+        mix.mul = interpreter.executedCount(IROpCode::MUL);
+        mix.add = interpreter.executedCount(IROpCode::ADD) + interpreter.executedCount(IROpCode::SUB);
+        for (IROpCode op : {IROpCode::CMP_EQ, IROpCode::CMP_NE, IROpCode::CMP_LT, IROpCode::CMP_GT}) {
+            mix.compare += interpreter.executedCount(op);
+        }
+        mix.copy = interpreter.executedCount(IROpCode::ASSIGN) + interpreter.executedCount(IROpCode::LOAD_IMM);
+        for (IROpCode op : {IROpCode::JMP, IROpCode::JMP_IF_ZERO, IROpCode::LABEL}) {
+            mix.jump += interpreter.executedCount(op);
+        }
+        std::istringstream lines(trace.str());
+        for (std::string line; std::getline(lines, line);) {
+            if (line.rfind(">>> PRINT OUTPUT:", 0) == 0) {
+                mix.prints += line + '\n';
+            }
+        }
+        return mix;
+    }
+
+    // Адресация двумерного массива: base = row * width + col, смещение base * 4
+    std::string generateStridedLoops(int rows, int width) {
+        return "int row;\nint col;\nint base;\nint offset;\nint sum;\nsum = 0;\nrow = 0;\n"
+               "while (row < " + std::to_string(rows) + ") {\n"
+               "    col = 0;\n"
+               "    while (col < " + std::to_string(width) + ") {\n"
+               "        base = row * " + std::to_string(width) + " + col;\n"
+               "        offset = base * 4;\n"
+               "        sum = sum + offset;\n"
+               "        col = col + 1;\n"
+               "    }\n"
+               "    row = row + 1;\n"
+               "}\nprint sum;\n";
+    }
+
+    // Счётчик, который нужен только как множитель: после замены проверки выхода он исчезает
+    std::string generateScaledCounter(int count) {
+        return "int i;\nint t;\nint sum;\nsum = 0;\ni = 0;\n"
+               "while (i < " + std::to_string(count) + ") {\n"
+               "    t = i * 8;\n"
+               "    sum = sum + t;\n"
+               "    i = i + 1;\n"
+               "}\nprint sum;\n";
+    }
+}
+
+// Понижение силы умножений на индуктивные переменные: состав выполненных инструкций
+// до и после оптимизации. Умножения в циклах должны смениться сложениями; вывод
+// программы не меняется
+int runInductionBenchmark() {
+    struct Input {
+        std::string name;
+        std::string source;
+    };
+    std::vector<Input> inputs;
+    inputs.push_back({"test_3 (3x3 table)",
+                      "int row;\nint col;\nint result;\nrow = 1;\n"
+                      "while (row < 4) {\n    col = 1;\n    while (col < 4) {\n"
+                      "        result = row * col;\n        print result;\n        col = col + 1;\n    }\n"
+                      "    row = row + 1;\n}\n"});
+    inputs.push_back({"strided 100x100", generateStridedLoops(100, 100)});
+    inputs.push_back({"scaled counter 10k", generateScaledCounter(10000)});
+    inputs.push_back({"64 KB program", generateProgram(64u << 10)});
+
+    for (const Input& input : inputs) {
+        PackedIR code;
+        std::ostringstream sink;
+        std::streambuf* console = std::cout.rdbuf(sink.rdbuf());
+        const bool ok = translate(input.source, code);
+        std::cout.rdbuf(console);
+        if (!ok) {
+            std::cerr << "[BENCH] Unexpected errors while compiling " << input.name << ".\n";
+            return 1;
+        }
+        const Mix before = run(code);
+
+        PackedIR optimized = code;
+        console = std::cout.rdbuf(sink.rdbuf());
+        BenchTimer timer;
+        IROptimizer optimizer;
+        optimizer.optimize(optimized);
+        const double seconds = timer.seconds();
+        std::cout.rdbuf(console);
+        const Mix after = run(optimized);
+        if (after.prints != before.prints) {
+            std::cerr << "[BENCH] Optimized program prints different values for " << input.name << ".\n";
+            return 1;
+        }
+
+        std::cout << "induction: " << std::left << std::setw(20) << input.name << std::right << " executed "
+                  << std::setw(7) << before.total << " -> " << std::setw(7) << after.total << "; MUL "
+                  << before.mul << " -> " << after.mul << ", ADD/SUB " << before.add << " -> " << after.add
+                  << ", CMP " << before.compare << " -> " << after.compare << ", copies " << before.copy << " -> "
+                  << after.copy << ", jumps " << before.jump << " -> " << after.jump << "; optimize " << std::fixed
+                  << std::setprecision(2) << seconds * 1e3 << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "ErrorHandler.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Пропускная способность лексера (МБ/с) на синтетических программах разного размера
+int runLexerBenchmark() {
+    const size_t sizes[] = {1u << 20, 16u << 20, 64u << 20};
+    const int ITERATIONS = 5;
+
+    for (size_t size : sizes) {
+        std::string source = generateProgram(size);
+        double best = 1e30;
+        size_t token_count = 0;
+
+        for (int it = 0; it < ITERATIONS; ++it) {
+            ErrorHandler error_handler;
+            BenchTimer timer;
+            Lexer lexer(source, &error_handler);
+            lexer.runLexer();
+            best = std::min(best, timer.seconds());
+
+            if (error_handler.hasErrors()) {
+                std::cerr << "[BENCH] Unexpected lexical errors in generated program.\n";
+                return 1;
+            }
+            token_count = 0;
+            while (lexer.getNextToken().type != TokenType::TOKEN_EOF) {
+                ++token_count;
+            }
+        }
+
+        double mb = (double)source.size() / (1024.0 * 1024.0);
+        std::cout << "lexer: " << std::fixed << std::setprecision(1) << std::setw(6) << mb << " MB, "
+                  << std::setw(9) << token_count << " tokens, "
+                  << std::setw(8) << std::setprecision(1) << mb / best << " MB/s, "
+                  << std::setw(7) << std::setprecision(1) << (double)token_count / best / 1e6 << " Mtok/s\n";
+    }
+
+    // Масштабирование параллельного режима по числу потоков
+    std::string source = generateProgram(sizes[2]);
+    double mb = (double)source.size() / (1024.0 * 1024.0);
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> thread_counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    double single = 0.0;
+    for (unsigned threads : thread_counts) {
+        double best = 1e30;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            ErrorHandler error_handler;
+            BenchTimer timer;
+            Lexer lexer(source, &error_handler);
+            lexer.runLexerParallel(threads);
+            best = std::min(best, timer.seconds());
+        }
+        if (threads == 1) {
+            single = best;
+        }
+        std::cout << "lexer-parallel: " << std::setw(3) << threads << " threads, "
+                  << std::fixed << std::setprecision(1) << std::setw(8) << mb / best << " MB/s, speedup x"
+                  << std::setprecision(2) << single / best << "\n";
+    }
+    return 0;
+}
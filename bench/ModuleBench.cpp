@@ -0,0 +1,103 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SemanticAnalyzer.h"
+#include "IRGenerator.h"
+#include "IROptimizer.h"
+#include "IRModule.h"
+#include "ErrorHandler.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Полная компиляция до оптимизированного упакованного кода
+    PackedIR compile(const std::string& source, bool& ok) {
+        ErrorHandler error_handler;
+        Lexer lexer(source, &error_handler);
+        lexer.runLexer();
+        Parser parser(&lexer, &error_handler);
+        std::unique_ptr<ASTNode> ast = parser.parseProgram();
+        SymbolTable symbols;
+        SemanticAnalyzer semantics(symbols, &error_handler);
+        ok = ast && semantics.analyze(*ast);
+        if (!ok) {
+            return {};
+        }
+        IRGenerator generator(&error_handler, &symbols);
+        PackedIR code = PackedIR::fromCode(generator.generate(ast.get()));
+        IROptimizer optimizer;
+        optimizer.optimize(code);
+        return code;
+    }
+}
+
+// Холодный старт готовой программы: компиляция из исходного кода против загрузки
+// сохранённого модуля IR (отображение файла и проверка заголовка, без разбора инструкций)
+int runModuleBenchmark() {
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+    const std::string path = (std::filesystem::temp_directory_path() / "ltlab_bench_module.bin").string();
+
+    for (size_t size : {64u << 10, 1u << 20, 16u << 20}) {
+        const std::string name = size < (1u << 20) ? std::to_string(size >> 10) + " KB program"
+                                                   : std::to_string(size >> 20) + " MB program";
+        const std::string source = generateProgram(size);
+
+        bool ok = false;
+        PackedIR code;
+        std::cout.rdbuf(sink.rdbuf());
+        double compile_seconds = 1e30;
+        for (int it = 0; it < 3; ++it) {
+            BenchTimer timer;
+            code = compile(source, ok);
+            compile_seconds = std::min(compile_seconds, timer.seconds());
+        }
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!ok) {
+            std::cerr << "[BENCH] Unexpected errors while compiling " << name << ".\n";
+            return 1;
+        }
+
+        BenchTimer timer;
+        {
+            std::ofstream out(path, std::ios::binary);
+            IRModule::write(code, out);
+        }
+        const double write_seconds = timer.seconds();
+
+        double load_seconds = 1e30;
+        for (int it = 0; it < 20; ++it) {
+            IRModule module;
+            timer.reset();
+            module.load(path);
+            load_seconds = std::min(load_seconds, timer.seconds());
+        }
+
+        // Код модуля печатается так же, как исходный упакованный код
+        IRModule module;
+        module.load(path);
+        std::ostringstream expected;
+        std::ostringstream loaded;
+        code.print(expected);
+        module.view().print(loaded);
+        if (expected.str() != loaded.str()) {
+            std::cerr << "[BENCH] IR module differs from the compiled code for " << name << ".\n";
+            return 1;
+        }
+
+        std::cout << "module: " << std::left << std::setw(14) << name << std::right << std::fixed
+                  << std::setw(9) << code.size() << " instructions, " << std::setprecision(1)
+                  << std::setw(5) << std::filesystem::file_size(path) / (1024.0 * 1024.0) << " MB; compile "
+                  << std::setprecision(2) << std::setw(8) << compile_seconds * 1e3 << " ms, write "
+                  << std::setw(6) << write_seconds * 1e3 << " ms, load " << std::setprecision(1)
+                  << std::setw(6) << load_seconds * 1e6 << " us\n";
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
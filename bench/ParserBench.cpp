@@ -0,0 +1,283 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "IRGenerator.h"
+#include "IROptimizer.h"
+#include "PackedIR.h"
+#include "SemanticAnalyzer.h"
+#include "ErrorHandler.h"
+#include "SessionArena.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Лучшее время разбора (лексер отрабатывает до замера)
+    double timeParse(const std::string& source, bool& ok) {
+        const int ITERATIONS = 3;
+        double best = 1e30;
+        ok = true;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            ErrorHandler error_handler;
+            Lexer lexer(source, &error_handler);
+            lexer.runLexer();
+
+            BenchTimer timer;
+            Parser parser(&lexer, &error_handler);
+            std::unique_ptr<ASTNode> ast = parser.parseProgram();
+            ast.reset();
+            best = std::min(best, timer.seconds());
+            ok = ok && !error_handler.hasErrors();
+        }
+        return best;
+    }
+
+    // Фронтенд до IR: разбор в AST + IRGenerator либо однопроходная трансляция
+    double timeFrontend(const std::string& source, bool single_pass, IRCode& code) {
+        const int ITERATIONS = 3;
+        double best = 1e30;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            ErrorHandler error_handler;
+            Lexer lexer(source, &error_handler);
+            lexer.runLexer();
+
+            BenchTimer timer;
+            Parser parser(&lexer, &error_handler);
+            if (single_pass) {
+                parser.translateProgram(code);
+            } else {
+                std::unique_ptr<ASTNode> ast = parser.parseProgram();
+                IRGenerator generator(&error_handler);
+                code = generator.generate(ast.get());
+            }
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+
+    // Текст IR вне арены (для сравнения после её освобождения)
+    std::vector<std::string> listCode(const IRCode& code) {
+        std::vector<std::string> listing;
+        listing.reserve(code.size());
+        for (const Instruction& instr : code) {
+            listing.push_back(instr.toString());
+        }
+        return listing;
+    }
+
+    // Дерево узлов против плоского AST: память представления, время разбора и генерации IR.
+    // Память дерева — байты, размещённые парсером в арене (узлы и списки операторов)
+    struct LayoutResult {
+        size_t bytes = 0;
+        double parse_seconds = 1e30;
+        double generate_seconds = 1e30;
+        size_t nodes = 0;
+    };
+
+    LayoutResult measureLayout(const std::string& source, bool flat, std::vector<std::string>& listing) {
+        const int ITERATIONS = 3;
+        LayoutResult result;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            ErrorHandler error_handler;
+            Lexer lexer(source, &error_handler);
+            lexer.runLexer();
+            Parser parser(&lexer, &error_handler);
+            IRGenerator generator(&error_handler);
+
+            SessionArena arena;
+            SessionArena::Scope scope(arena);
+            if (flat) {
+                FlatAST ast;
+                BenchTimer timer;
+                parser.parseProgramFlat(ast);
+                result.parse_seconds = std::min(result.parse_seconds, timer.seconds());
+                result.bytes = ast.memoryBytes();
+                result.nodes = ast.nodeCount();
+
+                timer.reset();
+                IRCode generated = generator.generate(ast);
+                result.generate_seconds = std::min(result.generate_seconds, timer.seconds());
+                listing = listCode(generated);
+            } else {
+                BenchTimer timer;
+                std::unique_ptr<ASTNode> ast = parser.parseProgram();
+                result.parse_seconds = std::min(result.parse_seconds, timer.seconds());
+                result.bytes = arena.bytesUsed();
+
+                timer.reset();
+                IRCode generated = generator.generate(ast.get());
+                result.generate_seconds = std::min(result.generate_seconds, timer.seconds());
+                listing = listCode(generated);
+            }
+        }
+        return result;
+    }
+
+    bool sameCode(const IRCode& a, const IRCode& b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].toString() != b[i].toString()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Развёрнутый IR против упакованного: память, время упаковки, копирования и оптимизации
+    struct IRLayoutResult {
+        size_t instructions = 0;
+        size_t unpacked_bytes = 0;
+        size_t packed_bytes = 0;
+        double pack_seconds = 1e30;
+        double copy_seconds = 1e30;
+        double packed_copy_seconds = 1e30;
+        double optimize_seconds = 1e30;
+        bool round_trip = true;
+    };
+
+    IRLayoutResult measureIRLayout(const std::string& source) {
+        const int ITERATIONS = 3;
+        IRLayoutResult result;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            ErrorHandler error_handler;
+            Lexer lexer(source, &error_handler);
+            lexer.runLexer();
+            Parser parser(&lexer, &error_handler);
+            std::unique_ptr<ASTNode> ast = parser.parseProgram();
+            SymbolTable symbols;
+            SemanticAnalyzer semantics(symbols, &error_handler);
+            semantics.analyze(*ast);
+            IRGenerator generator(&error_handler, &symbols);
+            IRCode generated = generator.generate(ast.get());
+
+            BenchTimer timer;
+            PackedIR packed = PackedIR::fromCode(generated);
+            result.pack_seconds = std::min(result.pack_seconds, timer.seconds());
+
+            timer.reset();
+            IRCode copy = generated;
+            result.copy_seconds = std::min(result.copy_seconds, timer.seconds());
+            timer.reset();
+            PackedIR packed_copy = packed;
+            result.packed_copy_seconds = std::min(result.packed_copy_seconds, timer.seconds());
+
+            timer.reset();
+            IROptimizer optimizer;
+            optimizer.optimize(packed_copy);
+            result.optimize_seconds = std::min(result.optimize_seconds, timer.seconds());
+
+            result.instructions = generated.size();
+            result.unpacked_bytes = generated.size() * sizeof(Instruction);
+            result.packed_bytes = packed.memoryBytes();
+            result.round_trip = result.round_trip && sameCode(packed.toCode(), generated);
+        }
+        return result;
+    }
+}
+
+// Скорость синтаксического анализа (включая освобождение AST) на длинных программах
+// и длинных цепочках операций
+int runParserBenchmark() {
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+
+    struct Input {
+        std::string name;
+        std::string source;
+    };
+    std::vector<Input> inputs;
+    for (size_t size : {1u << 20, 16u << 20, 64u << 20}) {
+        inputs.push_back({std::to_string(size >> 20) + " MB program", generateProgram(size)});
+    }
+    // Выражение a + b * c + ... из 100 тыс. операций в одном операторе
+    std::string chain = "int a;\na = 1";
+    for (int i = 0; i < 100000; ++i) {
+        chain += (i % 2) ? " + a" : " * 2";
+    }
+    chain += ";\nprint a;\n";
+    inputs.push_back({"100k-operator chain", chain});
+
+    for (const Input& input : inputs) {
+        bool ok = false;
+        std::cout.rdbuf(sink.rdbuf());
+        const double best = timeParse(input.source, ok);
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!ok) {
+            std::cerr << "[BENCH] Unexpected errors while parsing " << input.name << ".\n";
+            return 1;
+        }
+        const double mb = (double)input.source.size() / (1024.0 * 1024.0);
+        std::cout << "parser: " << std::left << std::setw(20) << input.name << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(9) << best * 1e3 << " ms, "
+                  << std::setprecision(1) << std::setw(7) << mb / best << " MB/s\n";
+    }
+
+    // Однопроходная трансляция против AST + IRGenerator
+    for (size_t i = 0; i < 2; ++i) {
+        const Input& input = inputs[i];
+        IRCode via_ast;
+        IRCode single_pass;
+        std::cout.rdbuf(sink.rdbuf());
+        const double two_pass = timeFrontend(input.source, false, via_ast);
+        const double one_pass = timeFrontend(input.source, true, single_pass);
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!sameCode(via_ast, single_pass)) {
+            std::cerr << "[BENCH] Single-pass IR differs from IRGenerator output for " << input.name << ".\n";
+            return 1;
+        }
+        std::cout << "frontend: " << std::left << std::setw(18) << input.name << std::right
+                  << std::fixed << std::setprecision(2) << " AST+IRGenerator " << std::setw(9) << two_pass * 1e3
+                  << " ms, single-pass " << std::setw(9) << one_pass * 1e3 << " ms, speedup x"
+                  << two_pass / one_pass << "\n";
+    }
+
+    // Представление AST: дерево объектов против структуры массивов
+    for (size_t i = 0; i < 2; ++i) {
+        const Input& input = inputs[i];
+        std::vector<std::string> tree_code;
+        std::vector<std::string> flat_code;
+        std::cout.rdbuf(sink.rdbuf());
+        const LayoutResult tree = measureLayout(input.source, false, tree_code);
+        const LayoutResult flat = measureLayout(input.source, true, flat_code);
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (tree_code != flat_code) {
+            std::cerr << "[BENCH] Flat AST IR differs from tree AST IR for " << input.name << ".\n";
+            return 1;
+        }
+        std::cout << "ast layout: " << std::left << std::setw(16) << input.name << std::right << std::fixed
+                  << std::setprecision(1) << " tree " << std::setw(7) << tree.bytes / (1024.0 * 1024.0)
+                  << " MB, flat " << std::setw(6) << flat.bytes / (1024.0 * 1024.0) << " MB ("
+                  << flat.nodes << " nodes, x" << (double)tree.bytes / flat.bytes << " smaller); "
+                  << std::setprecision(2) << "parse " << tree.parse_seconds * 1e3 << " / "
+                  << flat.parse_seconds * 1e3 << " ms, IR generation " << tree.generate_seconds * 1e3
+                  << " / " << flat.generate_seconds * 1e3 << " ms\n";
+    }
+
+    // Представление IR: развёрнутые инструкции против 16-байтных упакованных
+    for (size_t i = 0; i < 2; ++i) {
+        const Input& input = inputs[i];
+        std::cout.rdbuf(sink.rdbuf());
+        const IRLayoutResult layout = measureIRLayout(input.source);
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!layout.round_trip) {
+            std::cerr << "[BENCH] Packed IR does not convert back to the generated IR for " << input.name << ".\n";
+            return 1;
+        }
+        std::cout << "ir layout: " << std::left << std::setw(17) << input.name << std::right << std::fixed
+                  << std::setprecision(1) << " unpacked " << std::setw(6) << layout.unpacked_bytes / (1024.0 * 1024.0)
+                  << " MB, packed " << std::setw(5) << layout.packed_bytes / (1024.0 * 1024.0) << " MB ("
+                  << layout.instructions << " instructions, x" << (double)layout.unpacked_bytes / layout.packed_bytes
+                  << " smaller); " << std::setprecision(2) << "pack " << layout.pack_seconds * 1e3
+                  << " ms, copy " << layout.copy_seconds * 1e3 << " / " << layout.packed_copy_seconds * 1e3
+                  << " ms, optimize " << layout.optimize_seconds * 1e3 << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "AST.h"
+#include "ASTVisualizer.h"
+#include "ASTSerializer.h"
+#include "ErrorHandler.h"
+#include "SessionArena.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // Лучшее время записи и результат последнего прохода
+    template <typename Write>
+    double bestOf(Write write, std::string& output) {
+        const int ITERATIONS = 3;
+        double best = 1e30;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            std::ostringstream out;
+            BenchTimer timer;
+            write(out);
+            best = std::min(best, timer.seconds());
+            output = out.str();
+        }
+        return best;
+    }
+
+    void report(const char* name, double seconds, size_t bytes) {
+        const double mb = (double)bytes / (1024.0 * 1024.0);
+        std::cout << "  " << std::left << std::setw(20) << name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(9) << seconds * 1e3 << " ms, "
+                  << std::setprecision(1) << std::setw(7) << mb << " MB, "
+                  << std::setw(7) << mb / seconds << " MB/s\n";
+    }
+}
+
+// Запись AST в текст визуализатора, JSON, DOT и двоичный формат и загрузка двоичного
+// дампа. Программы 5 и 10 МБ показывают линейный рост времени с числом узлов, цепочка
+// из 100 тыс. операций — что потоковые форматы не зависят от глубины дерева
+// (рекурсивный визуализатор для неё не запускается)
+int runSerializeBenchmark() {
+    struct Input {
+        std::string name;
+        std::string source;
+        bool deep;
+    };
+    std::vector<Input> inputs;
+    for (size_t size : {5u << 20, 10u << 20}) {
+        inputs.push_back({std::to_string(size >> 20) + " MB program", generateProgram(size), false});
+    }
+    std::string chain = "int a;\na = 1";
+    for (int i = 0; i < 100000; ++i) {
+        chain += (i % 2) ? " + a" : " * 2";
+    }
+    chain += ";\nprint a;\n";
+    inputs.push_back({"100k-operator chain", chain, true});
+
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+
+    for (const Input& input : inputs) {
+        SessionArena arena;
+        SessionArena::Scope scope(arena);
+
+        ErrorHandler error_handler;
+        Lexer lexer(input.source, &error_handler);
+        lexer.runLexer();
+        std::cout.rdbuf(sink.rdbuf());
+        Parser parser(&lexer, &error_handler);
+        std::unique_ptr<ASTNode> tree = parser.parseProgram();
+        std::cout.rdbuf(console);
+        sink.str("");
+        if (!tree || error_handler.hasErrors()) {
+            std::cerr << "[BENCH] Unexpected errors while parsing " << input.name << ".\n";
+            return 1;
+        }
+
+        std::cout << "serialize: " << input.name << "\n";
+        std::string text;
+        if (!input.deep) {
+            const double seconds = bestOf([&](std::ostream& out) {
+                ASTVisualizer visualizer(out);
+                visualizer.dispatch(*tree);
+            }, text);
+            report("text (visualizer)", seconds, text.size());
+        }
+
+        std::string json;
+        const double json_seconds = bestOf([&](std::ostream& out) {
+            OutputSink output(out);
+            ASTSerializer::writeJson(*tree, output);
+        }, json);
+        report("JSON", json_seconds, json.size());
+
+        std::string dot;
+        const double dot_seconds = bestOf([&](std::ostream& out) {
+            OutputSink output(out);
+            ASTSerializer::writeDot(*tree, output);
+        }, dot);
+        report("DOT", dot_seconds, dot.size());
+
+        std::string binary;
+        const double binary_seconds = bestOf([&](std::ostream& out) {
+            OutputSink output(out);
+            ASTSerializer::writeBinary(*tree, output);
+        }, binary);
+        report("binary", binary_seconds, binary.size());
+
+        // Загрузка: дерево из двоичного дампа должно совпасть с исходным
+        std::unique_ptr<ASTNode> loaded;
+        double load_seconds = 1e30;
+        for (int it = 0; it < 3; ++it) {
+            loaded.reset();
+            BenchTimer timer;
+            loaded = ASTSerializer::readBinary(binary);
+            load_seconds = std::min(load_seconds, timer.seconds());
+        }
+        report("binary load", load_seconds, binary.size());
+
+        std::ostringstream reloaded;
+        if (input.deep) {
+            OutputSink output(reloaded);
+            ASTSerializer::writeBinary(*loaded, output);
+        } else {
+            ASTVisualizer visualizer(reloaded);
+            visualizer.dispatch(*loaded);
+        }
+        if (reloaded.str() != (input.deep ? binary : text)) {
+            std::cerr << "[BENCH] AST loaded from the binary dump differs from the original for " << input.name << ".\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+#include "Bench.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "AST.h"
+#include "FlatAST.h"
+#include "ErrorHandler.h"
+#include "SessionArena.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+    // Итог обхода: число узлов и контрольная сумма (обход не может быть выброшен оптимизатором)
+    struct Totals {
+        size_t nodes = 0;
+        long long checksum = 0;
+
+        bool operator==(const Totals& other) const {
+            return nodes == other.nodes && checksum == other.checksum;
+        }
+    };
+
+    // Обход через виртуальный ASTVisitor: accept + visit (двойная диспетчеризация)
+    class VirtualCounter : public ASTVisitor {
+    public:
+        Totals totals;
+
+        void visit(ProgramNode& node) override {
+            ++totals.nodes;
+            for (const auto& stmt : node.statements) {
+                stmt->accept(*this);
+            }
+        }
+        void visit(VarDeclNode& node) override { ++totals.nodes; totals.checksum += (long long)node.name; }
+        void visit(AssignStmtNode& node) override {
+            ++totals.nodes;
+            totals.checksum += (long long)node.identifier_name;
+            node.expression->accept(*this);
+        }
+        void visit(PrintStmtNode& node) override { ++totals.nodes; node.expression->accept(*this); }
+        void visit(IfStmtNode& node) override {
+            ++totals.nodes;
+            node.condition->accept(*this);
+            node.then_body->accept(*this);
+            if (node.else_body) {
+                node.else_body->accept(*this);
+            }
+        }
+        void visit(WhileStmtNode& node) override {
+            ++totals.nodes;
+            node.condition->accept(*this);
+            node.body->accept(*this);
+        }
+        void visit(BinaryOpNode& node) override {
+            ++totals.nodes;
+            totals.checksum += (long long)node.op;
+            node.left->accept(*this);
+            node.right->accept(*this);
+        }
+        void visit(IntLiteralNode& node) override { ++totals.nodes; totals.checksum += node.value; }
+        void visit(IdentifierNode& node) override { ++totals.nodes; totals.checksum += (long long)node.name; }
+        void visit(TerminalNode&) override { ++totals.nodes; }
+    };
+
+    // Тот же обход на StaticASTVisitor: переход по метке вида узла, visit встраивается
+    class StaticCounter : public StaticASTVisitor<StaticCounter> {
+    public:
+        Totals totals;
+
+        void visit(ProgramNode& node) {
+            ++totals.nodes;
+            for (const auto& stmt : node.statements) {
+                dispatch(*stmt);
+            }
+        }
+        void visit(VarDeclNode& node) { ++totals.nodes; totals.checksum += (long long)node.name; }
+        void visit(AssignStmtNode& node) {
+            ++totals.nodes;
+            totals.checksum += (long long)node.identifier_name;
+            dispatch(*node.expression);
+        }
+        void visit(PrintStmtNode& node) { ++totals.nodes; dispatch(*node.expression); }
+        void visit(IfStmtNode& node) {
+            ++totals.nodes;
+            dispatch(*node.condition);
+            visit(*node.then_body);
+            if (node.else_body) {
+                visit(*node.else_body);
+            }
+        }
+        void visit(WhileStmtNode& node) {
+            ++totals.nodes;
+            dispatch(*node.condition);
+            visit(*node.body);
+        }
+        void visit(BinaryOpNode& node) {
+            ++totals.nodes;
+            totals.checksum += (long long)node.op;
+            dispatch(*node.left);
+            dispatch(*node.right);
+        }
+        void visit(IntLiteralNode& node) { ++totals.nodes; totals.checksum += node.value; }
+        void visit(IdentifierNode& node) { ++totals.nodes; totals.checksum += (long long)node.name; }
+        void visit(TerminalNode&) { ++totals.nodes; }
+    };
+
+    // Тот же обход плоского AST (для сравнения с представлением из массивов)
+    void countFlat(const FlatAST& ast, FlatAST::NodeIndex node, Totals& totals) {
+        ++totals.nodes;
+        switch (ast.kind(node)) {
+            case FlatNodeKind::PROGRAM:
+                for (FlatAST::NodeIndex stmt : ast.statements(node)) {
+                    countFlat(ast, stmt, totals);
+                }
+                break;
+            case FlatNodeKind::VAR_DECL:
+            case FlatNodeKind::IDENTIFIER:
+                totals.checksum += (long long)ast.symbol(node);
+                break;
+            case FlatNodeKind::ASSIGN_STMT:
+                totals.checksum += (long long)ast.symbol(node);
+                countFlat(ast, ast.second(node), totals);
+                break;
+            case FlatNodeKind::PRINT_STMT:
+                countFlat(ast, ast.first(node), totals);
+                break;
+            case FlatNodeKind::IF_STMT:
+            case FlatNodeKind::WHILE_STMT:
+                countFlat(ast, ast.first(node), totals);
+                countFlat(ast, ast.second(node), totals);
+                if (ast.kind(node) == FlatNodeKind::IF_STMT && ast.third(node) != FlatAST::NO_NODE) {
+                    countFlat(ast, ast.third(node), totals);
+                }
+                break;
+            case FlatNodeKind::BINARY_OP:
+                totals.checksum += (long long)ast.op(node);
+                countFlat(ast, ast.first(node), totals);
+                countFlat(ast, ast.second(node), totals);
+                break;
+            case FlatNodeKind::INT_LITERAL:
+                totals.checksum += ast.literal(node);
+                break;
+        }
+    }
+
+    // Лучшее время из нескольких обходов
+    template <typename Traverse>
+    double bestOf(Traverse traverse, Totals& totals) {
+        const int ITERATIONS = 7;
+        double best = 1e30;
+        for (int it = 0; it < ITERATIONS; ++it) {
+            BenchTimer timer;
+            totals = traverse();
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+}
+
+// Обход AST: виртуальный посетитель против статической диспетчеризации и плоского AST.
+// Деревья размещаются в арене сеанса, как в основном конвейере. Малое дерево помещается
+// в кэш и обходится многократно (видна стоимость диспетчеризации), большое — больше
+// миллиона узлов (заметна стоимость обращений к памяти)
+int runTraversalBenchmark() {
+    struct Input {
+        const char* name;
+        size_t bytes;
+        int repeats;
+    };
+    const Input inputs[] = {
+        {"8 KB program (x800)", 8u << 10, 800},
+        {"5 MB program", 5u << 20, 1}
+    };
+
+    std::ostringstream sink;
+    std::streambuf* console = std::cout.rdbuf();
+
+    for (const Input& input : inputs) {
+        const std::string source = generateProgram(input.bytes);
+
+        SessionArena arena;
+        SessionArena::Scope scope(arena);
+
+        ErrorHandler error_handler;
+        Lexer lexer(source, &error_handler);
+        lexer.runLexer();
+
+        std::cout.rdbuf(sink.rdbuf());
+        Parser parser(&lexer, &error_handler);
+        std::unique_ptr<ASTNode> tree = parser.parseProgram();
+        lexer.seekToken(0);
+        Parser flat_parser(&lexer, &error_handler);
+        FlatAST flat;
+        const bool flat_ok = flat_parser.parseProgramFlat(flat);
+        std::cout.rdbuf(console);
+        sink.str("");
+
+        if (!tree || !flat_ok || error_handler.hasErrors()) {
+            std::cerr << "[BENCH] Unexpected errors while parsing the traversal input.\n";
+            return 1;
+        }
+
+        Totals virtual_totals;
+        Totals static_totals;
+        Totals flat_totals;
+        const double virtual_time = bestOf([&]() {
+            VirtualCounter counter;
+            for (int r = 0; r < input.repeats; ++r) {
+                tree->accept(counter);
+            }
+            return counter.totals;
+        }, virtual_totals);
+        const double static_time = bestOf([&]() {
+            StaticCounter counter;
+            for (int r = 0; r < input.repeats; ++r) {
+                counter.dispatch(*tree);
+            }
+            return counter.totals;
+        }, static_totals);
+        const double flat_time = bestOf([&]() {
+            Totals totals;
+            for (int r = 0; r < input.repeats; ++r) {
+                countFlat(flat, flat.root(), totals);
+            }
+            return totals;
+        }, flat_totals);
+
+        if (!(virtual_totals == static_totals) || !(virtual_totals == flat_totals)) {
+            std::cerr << "[BENCH] Traversals disagree on node count or checksum.\n";
+            return 1;
+        }
+
+        const double visits = (double)virtual_totals.nodes;
+        std::cout << "traversal: " << input.name << ", " << virtual_totals.nodes / input.repeats << " nodes\n";
+        auto report = [&](const char* name, double seconds) {
+            std::cout << "  " << std::left << std::setw(26) << name << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(8) << seconds * 1e3 << " ms, "
+                      << std::setw(5) << seconds * 1e9 / visits << " ns/node, x"
+                      << virtual_time / seconds << "\n";
+        };
+        report("virtual ASTVisitor", virtual_time);
+        report("StaticASTVisitor (CRTP)", static_time);
+        report("flat AST", flat_time);
+    }
+    return 0;
+}
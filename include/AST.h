@@ -3,16 +3,41 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
 #include "Token.h"
 
 class ASTVisitor;
 class ProgramNode;
 
+// Вид узла AST: метка для статической диспетчеризации (StaticASTVisitor)
+enum class ASTNodeKind : uint8_t {
+    PROGRAM,
+    VAR_DECL,
+    ASSIGN_STMT,
+    PRINT_STMT,
+    IF_STMT,
+    WHILE_STMT,
+    BINARY_OP,
+    INT_LITERAL,
+    IDENTIFIER,
+    TERMINAL
+};
+
 // Базовый класс для всех узлов AST
 class ASTNode {
 public:
+    const ASTNodeKind node_kind;  // Конкретный тип узла (задаётся конструктором)
+
+    explicit ASTNode(ASTNodeKind kind) : node_kind(kind) {}
     virtual ~ASTNode() = default;
     virtual void accept(ASTVisitor& visitor) = 0;
+
+    // Узлы размещаются в активной арене сеанса (SessionArena), иначе в куче.
+    // Перед узлом хранится признак источника памяти, поэтому delete корректен в обоих случаях
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr) noexcept;
 };
 
 // Узел для лексемы
@@ -21,13 +46,14 @@ public:
     TokenType type;
     std::string value;
 
-    TerminalNode(TokenType t, const std::string& v = "") : type(t), value(v) {}
+    TerminalNode(TokenType t, const std::string& v = "") : ASTNode(ASTNodeKind::TERMINAL), type(t), value(v) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Базовый класс для выражений
 class ExpressionNode : public ASTNode {
 public:
+    explicit ExpressionNode(ASTNodeKind kind) : ASTNode(kind) {}
     virtual ~ExpressionNode() = default;
 };
 
@@ -35,15 +61,18 @@ public:
 class IntLiteralNode : public ExpressionNode {
 public:
     int value;
-    IntLiteralNode(int v) : value(v) {}
+    IntLiteralNode(int v) : ExpressionNode(ASTNodeKind::INT_LITERAL), value(v) {}
     void accept(ASTVisitor& visitor) override;
 };
 
-// Узел для идентификатора
+// Узел для идентификатора (имя — номер в SymbolInterner::global()).
+// Позиция имени нужна для сообщений семантического анализа; у поддеревьев, которые
+// инкрементальный разбор переиспользовал, она сдвигается вместе с их токенами
 class IdentifierNode : public ExpressionNode {
 public:
-    std::string name;
-    IdentifierNode(const std::string& n) : name(n) {}
+    SymbolId name;
+    SourcePos pos;
+    IdentifierNode(SymbolId n, SourcePos p = {}) : ExpressionNode(ASTNodeKind::IDENTIFIER), name(n), pos(p) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -55,7 +84,8 @@ public:
     std::unique_ptr<ASTNode> right;
 
     BinaryOpNode(TokenType op_type, std::unique_ptr<ASTNode> l, std::unique_ptr<ASTNode> r)
-        : op(op_type), left(std::move(l)), right(std::move(r)) {}
+        : ExpressionNode(ASTNodeKind::BINARY_OP), op(op_type), left(std::move(l)), right(std::move(r)) {}
+    ~BinaryOpNode() override;
 
     std::string op_type_to_string() const;
     void accept(ASTVisitor& visitor) override;
@@ -64,10 +94,11 @@ public:
 // Узел для объявления переменной
 class VarDeclNode : public ASTNode {
 public:
-    std::string name;
+    SymbolId name;
     TokenType type;
+    SourcePos pos;                // Позиция имени
 
-    VarDeclNode(const std::string& n, TokenType t) : name(n), type(t) {}
+    VarDeclNode(SymbolId n, TokenType t, SourcePos p = {}) : ASTNode(ASTNodeKind::VAR_DECL), name(n), type(t), pos(p) {}
     std::string typeToString() const;
     void accept(ASTVisitor& visitor) override;
 };
@@ -75,11 +106,12 @@ public:
 // Узел для оператора присваивания
 class AssignStmtNode : public ASTNode {
 public:
-    std::string identifier_name;
+    SymbolId identifier_name;
     std::unique_ptr<ASTNode> expression;
+    SourcePos pos;                // Позиция имени слева от '='
 
-    AssignStmtNode(const std::string& n, std::unique_ptr<ASTNode> expr)
-        : identifier_name(n), expression(std::move(expr)) {}
+    AssignStmtNode(SymbolId n, std::unique_ptr<ASTNode> expr, SourcePos p = {})
+        : ASTNode(ASTNodeKind::ASSIGN_STMT), identifier_name(n), expression(std::move(expr)), pos(p) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -87,7 +119,7 @@ public:
 class PrintStmtNode : public ASTNode {
 public:
     std::unique_ptr<ASTNode> expression;
-    PrintStmtNode(std::unique_ptr<ASTNode> expr) : expression(std::move(expr)) {}
+    PrintStmtNode(std::unique_ptr<ASTNode> expr) : ASTNode(ASTNodeKind::PRINT_STMT), expression(std::move(expr)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -98,7 +130,7 @@ public:
     std::unique_ptr<ProgramNode> then_body;
     std::unique_ptr<ProgramNode> else_body;
 
-    IfStmtNode() = default;
+    IfStmtNode() : ASTNode(ASTNodeKind::IF_STMT) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -108,14 +140,141 @@ public:
     std::unique_ptr<ASTNode> condition;
     std::unique_ptr<ProgramNode> body;
 
-    WhileStmtNode() = default;
+    WhileStmtNode() : ASTNode(ASTNodeKind::WHILE_STMT) {}
     void accept(ASTVisitor& visitor) override;
 };
 
+// Операторы блока с числом токенов каждого (разметка для инкрементального разбора;
+// 0 — разметки нет). Операторы лежат кусками не больше 2 * CHUNK_STATEMENTS, и у куска
+// хранится сумма токенов: поиск оператора по номеру токена идёт по суммам кусков,
+// а замена операторов перестраивает только задетые куски. Сдвиг строк после правки
+// копится в заголовках кусков и применяется к позициям при первом обращении к куску
+class StatementList {
+private:
+    struct Entry {
+        std::unique_ptr<ASTNode> statement;
+        uint32_t token_count = 0;
+    };
+    struct Chunk {
+        size_t first = 0;                    // Номер первого оператора куска
+        size_t tokens = 0;                   // Сумма token_count куска
+        int line_shift = 0;                  // Ещё не применённый к позициям сдвиг строк
+        std::pmr::vector<Entry> entries;
+    };
+
+    mutable std::pmr::vector<Chunk> chunks_;
+    size_t size_ = 0;
+
+    Entry& entry(size_t index);
+    const Entry& entry(size_t index) const;
+    size_t chunkOf(size_t index) const;
+    void settle(size_t chunk) const {
+        if (chunks_[chunk].line_shift != 0) {
+            applyLineShift(chunk);
+        }
+    }
+    void settleAll() const {
+        for (size_t c = 0; c < chunks_.size(); ++c) {
+            settle(c);
+        }
+    }
+    void applyLineShift(size_t chunk) const;
+    static void shiftStatementLines(ASTNode* statement, int line_delta, std::pmr::vector<ASTNode*>& pending);
+    void restart(size_t from_chunk);         // Пересчёт номеров первых операторов кусков
+
+    // Обход по порядку операторов: указатель на запись и конец её куска (end — nullptr)
+    template <typename ChunkT, typename EntryT, typename Statement>
+    class Iterator {
+    private:
+        ChunkT* chunk_;
+        ChunkT* chunks_end_;
+        EntryT* entry_ = nullptr;
+        EntryT* entries_end_ = nullptr;
+
+        void enter() {
+            for (; chunk_ != chunks_end_; ++chunk_) {
+                if (!chunk_->entries.empty()) {
+                    entry_ = chunk_->entries.data();
+                    entries_end_ = entry_ + chunk_->entries.size();
+                    return;
+                }
+            }
+            entry_ = nullptr;
+        }
+
+    public:
+        Iterator(ChunkT* chunk, ChunkT* chunks_end) : chunk_(chunk), chunks_end_(chunks_end) { enter(); }
+        Statement& operator*() const { return entry_->statement; }
+        uint32_t tokenCount() const { return entry_->token_count; }
+        Iterator& operator++() {
+            if (++entry_ == entries_end_) {
+                ++chunk_;
+                enter();
+            }
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return entry_ != other.entry_; }
+    };
+
+public:
+    static constexpr size_t CHUNK_STATEMENTS = 256;
+
+    using iterator = Iterator<Chunk, Entry, std::unique_ptr<ASTNode>>;
+    using const_iterator = Iterator<const Chunk, const Entry, const std::unique_ptr<ASTNode>>;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    iterator begin() {
+        settleAll();
+        return iterator(chunks_.data(), chunks_.data() + chunks_.size());
+    }
+    iterator end() { return iterator(nullptr, nullptr); }
+    const_iterator begin() const {
+        settleAll();
+        return const_iterator(chunks_.data(), chunks_.data() + chunks_.size());
+    }
+    const_iterator end() const { return const_iterator(nullptr, nullptr); }
+
+    std::unique_ptr<ASTNode>& operator[](size_t index) { return entry(index).statement; }
+    const std::unique_ptr<ASTNode>& operator[](size_t index) const { return entry(index).statement; }
+    std::unique_ptr<ASTNode>& front() {
+        settle(0);
+        return chunks_.front().entries.front().statement;
+    }
+
+    void push_back(std::unique_ptr<ASTNode> statement, uint32_t token_count = 0);
+
+    uint32_t tokenCount(size_t index) const { return entry(index).token_count; }
+    void setTokenCount(size_t index, uint32_t token_count);
+    size_t tokenCount() const;               // Всего токенов (по суммам кусков)
+
+    // Оператор, содержащий токен с номером token от начала блока, и номер его первого
+    // токена; size(), если токен за концом разметки
+    size_t find(size_t token, size_t& statement_start) const;
+
+    // Замена операторов [first, last) операторами fresh с числом токенов counts
+    void replace(size_t first, size_t last, std::vector<std::unique_ptr<ASTNode>>& fresh,
+                 const std::vector<uint32_t>& counts);
+
+    // Сдвиг строк позиций операторов начиная с from (вместе с вложенными блоками):
+    // кусок оператора from правится сразу, следующие — через заголовки
+    void shiftLines(size_t from, int line_delta);
+    // Сдвиг позиций в строке line у операторов начиная с from, пока их первый токен
+    // (token — номер первого токена оператора from) левее line_end_token
+    void shiftColumns(size_t from, size_t token, size_t line_end_token, int line, int column_delta);
+};
+
 // Узел для блока программы
 class ProgramNode : public ASTNode {
 public:
-    std::vector<std::unique_ptr<ASTNode>> statements;
+    // Разметка токенов для инкрементального разбора (заполняется парсером).
+    // Хранятся только длины и относительные смещения: правка меняет записи
+    // лишь на пути от корня к изменённому оператору
+    StatementList statements;
+    uint32_t token_offset = 0;                     // Первый токен блока относительно начала владеющего оператора
+
+    ProgramNode() : ASTNode(ASTNodeKind::PROGRAM) {}
+    size_t tokenCount() const { return statements.tokenCount(); }
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -137,4 +296,31 @@ public:
     virtual void visit(IntLiteralNode& node) = 0;
     virtual void visit(IdentifierNode& node) = 0;
     virtual void visit(TerminalNode& node) = 0;
-};
\ No newline at end of file
+};
+
+// Посетитель со статической диспетчеризацией (CRTP): вид узла определяется по метке
+// node_kind, а вызов visit производного класса не виртуальный и может быть встроен.
+// Derived реализует visit(...) для всех видов узлов; обход потомков — через dispatch()
+template <typename Derived, typename Result = void>
+class StaticASTVisitor {
+public:
+#if defined(__GNUC__)
+    [[gnu::always_inline]]
+#endif
+    Result dispatch(ASTNode& node) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (node.node_kind) {
+            case ASTNodeKind::PROGRAM:     return self.visit(static_cast<ProgramNode&>(node));
+            case ASTNodeKind::VAR_DECL:    return self.visit(static_cast<VarDeclNode&>(node));
+            case ASTNodeKind::ASSIGN_STMT: return self.visit(static_cast<AssignStmtNode&>(node));
+            case ASTNodeKind::PRINT_STMT:  return self.visit(static_cast<PrintStmtNode&>(node));
+            case ASTNodeKind::IF_STMT:     return self.visit(static_cast<IfStmtNode&>(node));
+            case ASTNodeKind::WHILE_STMT:  return self.visit(static_cast<WhileStmtNode&>(node));
+            case ASTNodeKind::BINARY_OP:   return self.visit(static_cast<BinaryOpNode&>(node));
+            case ASTNodeKind::INT_LITERAL: return self.visit(static_cast<IntLiteralNode&>(node));
+            case ASTNodeKind::IDENTIFIER:  return self.visit(static_cast<IdentifierNode&>(node));
+            case ASTNodeKind::TERMINAL:    break;
+        }
+        return self.visit(static_cast<TerminalNode&>(node));
+    }
+};
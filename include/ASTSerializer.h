@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "AST.h"
+
+// Буферизованный приёмник вывода: данные копятся в собственном буфере и
+// передаются в поток вызывающего крупными блоками (без форматирования iostream)
+class OutputSink {
+private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    std::ostream& out_;
+    std::unique_ptr<char[]> buffer_;
+    size_t used_ = 0;
+    size_t total_ = 0;                   // Всего записано байт
+
+public:
+    explicit OutputSink(std::ostream& out);
+    ~OutputSink();
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    void put(char c) {
+        if (used_ == BUFFER_SIZE) {
+            flush();
+        }
+        buffer_[used_++] = c;
+    }
+    void write(std::string_view text);
+    void writeDecimal(long long value);  // Десятичная запись целого
+    void writeVarint(uint64_t value);    // LEB128 (двоичный формат)
+
+    void flush();
+    size_t bytesWritten() const { return total_ + used_; }
+};
+
+// Потоковые сериализаторы AST. Обход выполняется на явном стеке, поэтому глубина
+// дерева не ограничена стеком вызовов, а время записи линейно по числу узлов
+namespace ASTSerializer {
+    // Компактный JSON: {"kind":"BinaryOp","op":"PLUS","left":{...},"right":{...}}
+    void writeJson(const ASTNode& root, OutputSink& sink);
+
+    // Graphviz DOT: узел на строку, рёбра подписаны именами полей
+    void writeDot(const ASTNode& root, OutputSink& sink);
+
+    // Компактный двоичный формат: заголовок, затем узлы в прямом порядке обхода
+    // (вид узла, поля в LEB128, имена — через таблицу уже встреченных строк).
+    // Разметка токенов блоков сохраняется, поэтому загруженное дерево пригодно
+    // для инкрементального разбора
+    void writeBinary(const ASTNode& root, OutputSink& sink);
+
+    // Восстановление AST из двоичного формата без повторного разбора.
+    // Повреждённые данные — std::runtime_error
+    std::unique_ptr<ASTNode> readBinary(std::string_view data);
+}
@@ -1,23 +1,37 @@
 #pragma once
 #include "AST.h"
+#include "FlatAST.h"
 #include <string>
+#include <ostream>
+#include <iostream>
+#include <memory_resource>
 
-// Визуализатор AST: печатает дерево в удобочитаемом формате
-class ASTVisualizer : public ASTVisitor {
+// Визуализатор AST: печатает дерево в удобочитаемом формате в переданный поток
+class ASTVisualizer : public StaticASTVisitor<ASTVisualizer> {
 private:
-    std::string indent_;  // Текущий отступ для вложенных узлов
+    std::ostream& out_;  // Поток вывода (задаёт вызывающий)
+
+    // Текущий отступ: при входе в уровень дописывается, при выходе усекается до
+    // прежней длины, поэтому стоимость построения отступов линейна по объёму вывода.
+    // Размещается в арене сеанса, если она активна
+    std::pmr::string indent_;
+
+    void printFlat(const FlatAST& ast, FlatAST::NodeIndex node);
 public:
-    ASTVisualizer() : indent_("") {}
+    explicit ASTVisualizer(std::ostream& out = std::cout) : out_(out) {}
 
     // Методы обхода узлов AST
-    void visit(ProgramNode& node) override;
-    void visit(VarDeclNode& node) override;
-    void visit(AssignStmtNode& node) override;
-    void visit(PrintStmtNode& node) override;
-    void visit(IfStmtNode& node) override;
-    void visit(WhileStmtNode& node) override;
-    void visit(BinaryOpNode& node) override;
-    void visit(IntLiteralNode& node) override;
-    void visit(IdentifierNode& node) override;
-    void visit(TerminalNode& node) override;
+    void visit(ProgramNode& node);
+    void visit(VarDeclNode& node);
+    void visit(AssignStmtNode& node);
+    void visit(PrintStmtNode& node);
+    void visit(IfStmtNode& node);
+    void visit(WhileStmtNode& node);
+    void visit(BinaryOpNode& node);
+    void visit(IntLiteralNode& node);
+    void visit(IdentifierNode& node);
+    void visit(TerminalNode& node);
+
+    // Печать плоского AST в том же формате (обход по виду узла, без виртуальных вызовов)
+    void print(const FlatAST& ast);
 };
\ No newline at end of file
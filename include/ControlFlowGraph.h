@@ -0,0 +1,132 @@
+#pragma once
+
+#include "PackedIR.h"
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+// Аргумент φ-функции: значение SSA (SLOT) или константа (CONST)
+struct PhiOperand {
+    PackedKind kind = PackedKind::SLOT;
+    uint32_t value = 0;
+};
+
+// φ-функция в начале блока: args[i] приходит по ребру из predecessors(b)[i]
+struct PhiNode {
+    uint32_t result;
+    std::pmr::vector<PhiOperand> args;
+};
+
+// Базовый блок: тело без меток и переходов и явный выход из блока
+struct BasicBlock {
+    static constexpr uint32_t NO_LABEL = UINT32_MAX;
+
+    std::pmr::vector<PackedInstruction> code;  // Инструкции тела (без LABEL, JMP, JMP_IF_ZERO)
+    std::pmr::vector<PhiNode> phis;            // Только в SSA-форме (SSAForm)
+    uint32_t label = NO_LABEL;                 // Исходная метка начала блока
+    // Выход: JMP — всегда в next; JMP_IF_ZERO (условие в ARG1) — в next при ненулевом
+    // условии и в target при нулевом. У блока выхода из программы next = NO_BLOCK
+    PackedInstruction branch;
+    uint32_t next;
+    uint32_t target;
+
+    BasicBlock();
+
+    bool isConditional() const { return branch.op == IROpCode::JMP_IF_ZERO; }
+};
+
+// Естественный цикл: заголовок, объемлющий цикл и глубина вложенности (1 — внешний).
+// Предзаголовок — единственный внешний предшественник заголовка, который безусловно
+// переходит в него (NO_BLOCK, если такого нет; см. ensurePreheaders)
+struct Loop {
+    uint32_t header;
+    uint32_t parent;
+    uint32_t depth;
+    uint32_t preheader;
+};
+
+// Граф потока управления над упакованным IR. Блок 0 — вход (без предшественников),
+// последний построенный блок — пустой выход из программы. Рёбра задаются полями
+// next/target блоков; предшественники, обратный постпорядок, дерево доминаторов
+// (Cooper–Harvey–Kennedy) и естественные циклы вычисляет analyze() и после изменения
+// графа их нужно пересчитать. Кратные рёбра (оба выхода условного перехода в один
+// блок) сохраняются: у блока-приёмника предшественник записан дважды.
+// Неструктурные (несводимые) циклы в MiniLang не возникают и циклами не считаются
+class ControlFlowGraph {
+public:
+    static constexpr uint32_t NO_BLOCK = UINT32_MAX;
+    static constexpr uint32_t NO_LOOP = UINT32_MAX;
+
+private:
+    std::pmr::vector<BasicBlock> blocks_;
+    std::pmr::vector<uint32_t> layout_;        // Порядок вывода блоков (созданные блоки — перед заголовком)
+    uint32_t exit_ = NO_BLOCK;
+
+    // Результаты analyze()
+    std::pmr::vector<uint32_t> pred_offsets_;  // Предшественники блока b: [pred_offsets_[b], pred_offsets_[b + 1])
+    std::pmr::vector<uint32_t> preds_;
+    std::pmr::vector<uint32_t> rpo_;           // Достижимые блоки в обратном постпорядке
+    std::pmr::vector<uint32_t> rpo_index_;     // Позиция в rpo_ (NO_BLOCK — недостижим)
+    std::pmr::vector<uint32_t> idom_;          // Непосредственный доминатор (у входа — сам вход)
+    std::pmr::vector<uint32_t> dom_child_offsets_;  // Потомки в дереве доминаторов (как у предшественников)
+    std::pmr::vector<uint32_t> dom_children_;
+    std::pmr::vector<uint32_t> dom_pre_;       // Номера входа и выхода при обходе дерева доминаторов
+    std::pmr::vector<uint32_t> dom_post_;
+    std::pmr::vector<Loop> loops_;             // Внутренние циклы раньше объемлющих
+    std::pmr::vector<uint32_t> block_loop_;    // Самый внутренний цикл блока
+
+    void computePredecessors();
+    void computeReversePostorder();
+    void computeDominators();
+    void computeLoops();
+
+public:
+    // Построение блоков по коду; переход на неопределённую метку — runtime_error
+    explicit ControlFlowGraph(const PackedIR& code);
+
+    size_t blockCount() const { return blocks_.size(); }
+    BasicBlock& block(uint32_t b) { return blocks_[b]; }
+    const BasicBlock& block(uint32_t b) const { return blocks_[b]; }
+    uint32_t entry() const { return 0; }
+    uint32_t exit() const { return exit_; }
+    size_t instructionCount() const;
+
+    // Пересчёт предшественников, порядка обхода, доминаторов и циклов
+    void analyze();
+
+    std::span<const uint32_t> predecessors(uint32_t b) const {
+        return std::span<const uint32_t>(preds_.data() + pred_offsets_[b], pred_offsets_[b + 1] - pred_offsets_[b]);
+    }
+    const std::pmr::vector<uint32_t>& reversePostorder() const { return rpo_; }
+    bool reachable(uint32_t b) const { return rpo_index_[b] != NO_BLOCK; }
+
+    uint32_t idom(uint32_t b) const { return idom_[b]; }
+    std::span<const uint32_t> dominatorChildren(uint32_t b) const {
+        return std::span<const uint32_t>(dom_children_.data() + dom_child_offsets_[b],
+                                         dom_child_offsets_[b + 1] - dom_child_offsets_[b]);
+    }
+    // a доминирует над b (каждый блок доминирует над собой); для недостижимых — false
+    bool dominates(uint32_t a, uint32_t b) const {
+        return reachable(a) && reachable(b) && dom_pre_[a] <= dom_pre_[b] && dom_post_[b] <= dom_post_[a];
+    }
+
+    const std::pmr::vector<Loop>& loops() const { return loops_; }
+    uint32_t loopOf(uint32_t b) const { return block_loop_[b]; }
+    uint32_t loopDepth(uint32_t b) const {
+        return block_loop_[b] == NO_LOOP ? 0 : loops_[block_loop_[b]].depth;
+    }
+
+    // Создание недостающих предзаголовков: если в заголовок ведёт ровно одно внешнее
+    // ребро из блока с условным переходом, на ребро ставится пустой блок. При нескольких
+    // внешних рёбрах предзаголовка нет (аргументы φ-функций пришлось бы сливать в новые
+    // значения). Аргументы φ-функций заголовка переставляются под новый порядок
+    // предшественников, затем вызывается analyze(). Возвращает число созданных блоков
+    size_t ensurePreheaders();
+
+    // Запись блоков обратно в код: достижимые блоки идут в порядке исходного кода
+    // (созданный предзаголовок — перед своим заголовком), выход — последним; переход
+    // пропускается, если его цель следует сразу за блоком. Метки получают только цели
+    // переходов. Нужен актуальный analyze(), φ-функции должны быть уже удалены
+    void linearize(PackedIR& code) const;
+};
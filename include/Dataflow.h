@@ -0,0 +1,416 @@
+#pragma once
+
+#include "ControlFlowGraph.h"
+#include "PackedIR.h"
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+// Строка плотного битового множества только для чтения: слова по 64 бита
+class ConstBitRow {
+protected:
+    const uint64_t* words_;
+    size_t word_count_;
+
+public:
+    ConstBitRow(const uint64_t* words, size_t word_count) : words_(words), word_count_(word_count) {}
+
+    const uint64_t* words() const { return words_; }
+    size_t wordCount() const { return word_count_; }
+
+    bool test(uint32_t bit) const { return (words_[bit >> 6] >> (bit & 63)) & 1; }
+
+    size_t count() const {
+        size_t total = 0;
+        for (size_t i = 0; i < word_count_; ++i) {
+            total += (size_t)std::popcount(words_[i]);
+        }
+        return total;
+    }
+
+    bool operator==(ConstBitRow other) const {
+        for (size_t i = 0; i < word_count_; ++i) {
+            if (words_[i] != other.words_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Обход установленных битов по возрастанию
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t i = 0; i < word_count_; ++i) {
+            for (uint64_t word = words_[i]; word != 0; word &= word - 1) {
+                f((uint32_t)(i * 64 + (size_t)std::countr_zero(word)));
+            }
+        }
+    }
+};
+
+// Изменяемая строка плотного битового множества; строки одного решения имеют одну длину
+class BitRow {
+private:
+    uint64_t* words_;
+    size_t word_count_;
+
+public:
+    BitRow(uint64_t* words, size_t word_count) : words_(words), word_count_(word_count) {}
+    operator ConstBitRow() const { return ConstBitRow(words_, word_count_); }
+
+    bool test(uint32_t bit) const { return (words_[bit >> 6] >> (bit & 63)) & 1; }
+    void set(uint32_t bit) { words_[bit >> 6] |= uint64_t{1} << (bit & 63); }
+    void reset(uint32_t bit) { words_[bit >> 6] &= ~(uint64_t{1} << (bit & 63)); }
+
+    // Сброс битов [first, last)
+    void resetRange(uint32_t first, uint32_t last) {
+        if (first >= last) {
+            return;
+        }
+        const size_t lo = first >> 6;
+        const size_t hi = (last - 1) >> 6;
+        const uint64_t lo_mask = ~uint64_t{0} << (first & 63);
+        const uint64_t hi_mask = ~uint64_t{0} >> (63 - ((last - 1) & 63));
+        if (lo == hi) {
+            words_[lo] &= ~(lo_mask & hi_mask);
+            return;
+        }
+        words_[lo] &= ~lo_mask;
+        for (size_t i = lo + 1; i < hi; ++i) {
+            words_[i] = 0;
+        }
+        words_[hi] &= ~hi_mask;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < word_count_; ++i) {
+            words_[i] = 0;
+        }
+    }
+    // Все биты [0, bit_count); хвост последнего слова остаётся нулевым
+    void fill(size_t bit_count) {
+        for (size_t i = 0; i < word_count_; ++i) {
+            words_[i] = ~uint64_t{0};
+        }
+        if (bit_count % 64 != 0) {
+            words_[word_count_ - 1] = (uint64_t{1} << (bit_count % 64)) - 1;
+        }
+    }
+
+    void assign(ConstBitRow other) {
+        for (size_t i = 0; i < word_count_; ++i) {
+            words_[i] = other.words()[i];
+        }
+    }
+    void unionWith(ConstBitRow other) {
+        for (size_t i = 0; i < word_count_; ++i) {
+            words_[i] |= other.words()[i];
+        }
+    }
+    void intersectWith(ConstBitRow other) {
+        for (size_t i = 0; i < word_count_; ++i) {
+            words_[i] &= other.words()[i];
+        }
+    }
+};
+
+// Направление задачи: прямая (от входа, значение на входе блока — встреча выходов
+// предшественников) или обратная (от выхода, по преемникам)
+enum class DataflowDirection {
+    FORWARD,
+    BACKWARD
+};
+
+// Решётка «может быть»: встреча — объединение, начальное значение — пустое множество
+struct UnionLattice {
+    static void top(BitRow value, size_t) { value.clear(); }
+    static void meet(BitRow into, ConstBitRow from) { into.unionWith(from); }
+};
+
+// Решётка «обязательно»: встреча — пересечение, начальное значение — все биты
+struct IntersectionLattice {
+    static void top(BitRow value, size_t bit_count) { value.fill(bit_count); }
+    static void meet(BitRow into, ConstBitRow from) { into.intersectWith(from); }
+};
+
+// Решение задачи потока данных: плотные множества на входе и выходе каждого блока,
+// по строке на блок. У недостижимых блоков остаётся начальное значение решётки
+class DataflowSolution {
+private:
+    size_t bit_count_ = 0;
+    size_t word_count_ = 0;
+    std::pmr::vector<uint64_t> in_;
+    std::pmr::vector<uint64_t> out_;
+    size_t visits_ = 0;
+
+    template <typename Problem>
+    friend DataflowSolution solveDataflow(const ControlFlowGraph& cfg, const Problem& problem);
+
+public:
+    size_t bitCount() const { return bit_count_; }
+    size_t wordCount() const { return word_count_; }
+    // Число применений передаточной функции до неподвижной точки
+    size_t visits() const { return visits_; }
+
+    ConstBitRow in(uint32_t b) const { return ConstBitRow(in_.data() + b * word_count_, word_count_); }
+    ConstBitRow out(uint32_t b) const { return ConstBitRow(out_.data() + b * word_count_, word_count_); }
+
+    size_t memoryBytes() const { return (in_.capacity() + out_.capacity()) * sizeof(uint64_t); }
+};
+
+// Решение задачи потока данных рабочим списком в обратном постпорядке (для обратных
+// задач — в обратном ему порядке): блок извлекается с наименьшей позицией, поэтому
+// каждый проход по циклу видит уже обновлённые значения его входа. Задача описывает:
+//   using Lattice = UnionLattice | IntersectionLattice;
+//   static constexpr DataflowDirection DIRECTION;
+//   size_t bitCount() const;
+//   void boundary(BitRow value) const;   // вход программы (прямая) или выход (обратная)
+//   void transfer(uint32_t b, ConstBitRow input, BitRow output) const;
+// Передаточная функция переводит значение на входе блока в значение на выходе (для
+// обратной задачи — с выхода на вход) и должна быть монотонной
+template <typename Problem>
+DataflowSolution solveDataflow(const ControlFlowGraph& cfg, const Problem& problem) {
+    using Lattice = typename Problem::Lattice;
+    constexpr bool forward = Problem::DIRECTION == DataflowDirection::FORWARD;
+
+    DataflowSolution solution;
+    const size_t bit_count = problem.bitCount();
+    const size_t words = (bit_count + 63) / 64;
+    const size_t block_count = cfg.blockCount();
+    solution.bit_count_ = bit_count;
+    solution.word_count_ = words;
+    solution.in_.assign(block_count * words, 0);
+    solution.out_.assign(block_count * words, 0);
+    auto row = [words](std::pmr::vector<uint64_t>& data, uint32_t b) { return BitRow(data.data() + b * words, words); };
+    // Вход передаточной функции (source) и её результат (result) по направлению задачи
+    std::pmr::vector<uint64_t>& source = forward ? solution.in_ : solution.out_;
+    std::pmr::vector<uint64_t>& result = forward ? solution.out_ : solution.in_;
+    for (uint32_t b = 0; b < block_count; ++b) {
+        Lattice::top(row(source, b), bit_count);
+        Lattice::top(row(result, b), bit_count);
+    }
+
+    const auto& rpo = cfg.reversePostorder();
+    const uint32_t count = (uint32_t)rpo.size();
+    std::pmr::vector<uint32_t> position(block_count, ControlFlowGraph::NO_BLOCK);
+    for (uint32_t i = 0; i < count; ++i) {
+        position[rpo[i]] = forward ? i : count - 1 - i;
+    }
+    auto blockAt = [&rpo, count](uint32_t p) { return forward ? rpo[p] : rpo[count - 1 - p]; };
+
+    // Рабочий список: позиции блоков без повторов, сначала все достижимые блоки
+    std::priority_queue<uint32_t, std::pmr::vector<uint32_t>, std::greater<uint32_t>> worklist;
+    std::pmr::vector<uint8_t> queued(count, 1);
+    for (uint32_t p = 0; p < count; ++p) {
+        worklist.push(p);
+    }
+    auto enqueue = [&](uint32_t b) {
+        if (b == ControlFlowGraph::NO_BLOCK) {
+            return;
+        }
+        const uint32_t p = position[b];
+        if (p != ControlFlowGraph::NO_BLOCK && !queued[p]) {
+            queued[p] = 1;
+            worklist.push(p);
+        }
+    };
+
+    std::pmr::vector<uint64_t> scratch(words);
+    const BitRow next_value(scratch.data(), words);
+    while (!worklist.empty()) {
+        const uint32_t p = worklist.top();
+        worklist.pop();
+        queued[p] = 0;
+        const uint32_t b = blockAt(p);
+        const BasicBlock& block = cfg.block(b);
+
+        // Встреча значений соседей по направлению; граница — у блока без соседей
+        BitRow input = row(source, b);
+        bool has_neighbour = false;
+        auto meetWith = [&](uint32_t neighbour) {
+            if (neighbour == ControlFlowGraph::NO_BLOCK || !cfg.reachable(neighbour)) {
+                return;
+            }
+            if (!has_neighbour) {
+                input.assign(row(result, neighbour));
+                has_neighbour = true;
+            } else {
+                Lattice::meet(input, row(result, neighbour));
+            }
+        };
+        if constexpr (forward) {
+            for (uint32_t pred : cfg.predecessors(b)) {
+                meetWith(pred);
+            }
+        } else {
+            meetWith(block.next);
+            if (block.isConditional()) {
+                meetWith(block.target);
+            }
+        }
+        if (!has_neighbour) {
+            problem.boundary(input);
+        }
+
+        problem.transfer(b, input, next_value);
+        ++solution.visits_;
+        BitRow output = row(result, b);
+        if (ConstBitRow(output) == ConstBitRow(next_value)) {
+            continue;
+        }
+        output.assign(next_value);
+        if constexpr (forward) {
+            enqueue(block.next);
+            if (block.isConditional()) {
+                enqueue(block.target);
+            }
+        } else {
+            for (uint32_t pred : cfg.predecessors(b)) {
+                enqueue(pred);
+            }
+        }
+    }
+    return solution;
+}
+
+// Клиенты работают над графом без φ-функций. Множества индексируются только
+// глобальными именами — слотами, которые читаются в каком-либо блоке до записи в нём:
+// остальные (как большинство временных) не живут дольше своего блока, и плотные строки
+// по всем слотам были бы в десятки раз длиннее
+
+// Живые переменные (обратная задача, объединение): бит — глобальное имя
+class LivenessAnalysis {
+public:
+    static constexpr uint32_t NO_BIT = UINT32_MAX;
+
+    using Lattice = UnionLattice;
+    static constexpr DataflowDirection DIRECTION = DataflowDirection::BACKWARD;
+
+private:
+    std::pmr::vector<uint32_t> slot_bits_;     // Бит по слоту (NO_BIT — слот локален в блоках)
+    std::pmr::vector<uint32_t> bit_slots_;     // Слот по биту
+    std::pmr::vector<uint32_t> gen_offsets_;   // Чтения до записи в блоке b: [gen_offsets_[b], gen_offsets_[b + 1])
+    std::pmr::vector<uint32_t> gen_;
+    std::pmr::vector<uint32_t> kill_offsets_;  // Записи в блоке (как у gen)
+    std::pmr::vector<uint32_t> kill_;
+    DataflowSolution solution_;
+
+public:
+    LivenessAnalysis(const ControlFlowGraph& cfg, size_t slot_count);
+
+    uint32_t bitOf(uint32_t slot) const { return slot_bits_[slot]; }
+    uint32_t slotOf(uint32_t bit) const { return bit_slots_[bit]; }
+    const DataflowSolution& solution() const { return solution_; }
+
+    ConstBitRow liveIn(uint32_t b) const { return solution_.in(b); }
+    ConstBitRow liveOut(uint32_t b) const { return solution_.out(b); }
+    bool isLiveIn(uint32_t b, uint32_t slot) const { return slot_bits_[slot] != NO_BIT && liveIn(b).test(slot_bits_[slot]); }
+    bool isLiveOut(uint32_t b, uint32_t slot) const { return slot_bits_[slot] != NO_BIT && liveOut(b).test(slot_bits_[slot]); }
+
+    // Описание задачи для solveDataflow
+    size_t bitCount() const { return bit_slots_.size(); }
+    void boundary(BitRow value) const { value.clear(); }
+    void transfer(uint32_t b, ConstBitRow live_out, BitRow live_in) const;
+};
+
+// Место определения: блок и позиция инструкции в его теле
+struct DefinitionSite {
+    uint32_t block;
+    uint32_t index;
+};
+
+// Достигающие определения (прямая задача, объединение): бит — определение глобального
+// имени. Определения одного слота нумеруются подряд, и запись слота в блоке сбрасывает
+// их одним диапазоном
+class ReachingDefinitions {
+public:
+    using Lattice = UnionLattice;
+    static constexpr DataflowDirection DIRECTION = DataflowDirection::FORWARD;
+
+private:
+    std::pmr::vector<DefinitionSite> definitions_;
+    std::pmr::vector<uint32_t> slot_offsets_;  // Определения слота s: [slot_offsets_[s], slot_offsets_[s + 1])
+    std::pmr::vector<uint32_t> gen_offsets_;   // Последние в блоке определения слотов
+    std::pmr::vector<uint32_t> gen_;
+    std::pmr::vector<uint32_t> kill_offsets_;  // Слоты, записанные в блоке
+    std::pmr::vector<uint32_t> kill_;
+    DataflowSolution solution_;
+
+public:
+    ReachingDefinitions(const ControlFlowGraph& cfg, size_t slot_count);
+
+    size_t definitionCount() const { return definitions_.size(); }
+    const DefinitionSite& definition(uint32_t d) const { return definitions_[d]; }
+    // Номера определений слота: [first, last)
+    std::pair<uint32_t, uint32_t> definitionsOf(uint32_t slot) const {
+        return {slot_offsets_[slot], slot_offsets_[slot + 1]};
+    }
+    const DataflowSolution& solution() const { return solution_; }
+
+    ConstBitRow reachIn(uint32_t b) const { return solution_.in(b); }
+    ConstBitRow reachOut(uint32_t b) const { return solution_.out(b); }
+
+    // Описание задачи для solveDataflow
+    size_t bitCount() const { return definitions_.size(); }
+    void boundary(BitRow value) const { value.clear(); }
+    void transfer(uint32_t b, ConstBitRow reach_in, BitRow reach_out) const;
+};
+
+// Доступные выражения (прямая задача, пересечение): бит — бинарное выражение
+// (операция и операнды-константы или глобальные имена). Выражение доступно на входе
+// блока, если вычислено на каждом пути к нему и операнды после этого не менялись
+class AvailableExpressions {
+public:
+    static constexpr uint32_t NO_EXPRESSION = UINT32_MAX;
+
+    using Lattice = IntersectionLattice;
+    static constexpr DataflowDirection DIRECTION = DataflowDirection::FORWARD;
+
+private:
+    struct ExpressionKey {
+        IROpCode op;
+        uint8_t kinds;
+        uint32_t arg1;
+        uint32_t arg2;
+
+        bool operator==(const ExpressionKey&) const = default;
+    };
+    struct ExpressionKeyHash {
+        size_t operator()(const ExpressionKey& key) const {
+            return std::hash<uint64_t>()(((uint64_t)key.arg1 << 32 | key.arg2) * 31 + ((uint64_t)key.op << 8 | key.kinds));
+        }
+    };
+
+    std::pmr::vector<PackedInstruction> expressions_;  // Представитель выражения (без RESULT)
+    std::pmr::unordered_map<ExpressionKey, uint32_t, ExpressionKeyHash> expression_ids_;
+    std::pmr::vector<uint32_t> use_offsets_;   // Выражения с операндом-слотом s
+    std::pmr::vector<uint32_t> uses_;
+    std::pmr::vector<uint32_t> gen_offsets_;   // Выражения, доступные на выходе блока
+    std::pmr::vector<uint32_t> gen_;
+    std::pmr::vector<uint32_t> kill_offsets_;  // Слоты, записанные в блоке
+    std::pmr::vector<uint32_t> kill_;
+    DataflowSolution solution_;
+
+    static ExpressionKey keyOf(const PackedInstruction& instr);
+
+public:
+    AvailableExpressions(const ControlFlowGraph& cfg, size_t slot_count);
+
+    size_t expressionCount() const { return expressions_.size(); }
+    const PackedInstruction& expression(uint32_t e) const { return expressions_[e]; }
+    // Номер выражения, которое вычисляет инструкция (NO_EXPRESSION — не отслеживается)
+    uint32_t expressionOf(const PackedInstruction& instr) const;
+    const DataflowSolution& solution() const { return solution_; }
+
+    ConstBitRow availableIn(uint32_t b) const { return solution_.in(b); }
+    ConstBitRow availableOut(uint32_t b) const { return solution_.out(b); }
+
+    // Описание задачи для solveDataflow
+    size_t bitCount() const { return expressions_.size(); }
+    void boundary(BitRow value) const { value.clear(); }
+    void transfer(uint32_t b, ConstBitRow available_in, BitRow available_out) const;
+};
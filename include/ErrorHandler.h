@@ -12,10 +12,12 @@ struct CompilerError {
     int position;
 };
 
-// Обработчик ошибок компиляции
+// Обработчик ошибок компиляции. Предупреждения хранятся отдельно и не останавливают
+// компиляцию
 class ErrorHandler {
 private:
     std::vector<CompilerError> errors_;
+    std::vector<CompilerError> warnings_;
     bool has_errors_;
 
 public:
@@ -24,4 +26,16 @@ public:
     bool hasErrors() const;
     const std::vector<CompilerError>& getErrors() const;
     void printErrors(std::ostream& os = std::cerr) const;
+
+    // Инкрементальный анализ: ошибки вида type в заменённом окне [from, to) старого текста
+    // удаляются, а ошибки за окном сдвигаются так же, как токены после правки (номер строки
+    // на line_delta, позиция в строке to_line — на column_delta)
+    void retractErrors(const std::string& type, int from_line, int from_position, int to_line, int to_position,
+                       int line_delta, int column_delta);
+    // Удаление всех ошибок вида type (перед повторным полным проходом)
+    void retractErrors(const std::string& type);
+
+    void registerWarning(const std::string& type, const std::string& message, int line, int position);
+    const std::vector<CompilerError>& getWarnings() const;
+    void printWarnings(std::ostream& os = std::cerr) const;
 };
\ No newline at end of file
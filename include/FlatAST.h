@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+#include "Token.h"
+#include "SymbolInterner.h"
+
+// Вид узла плоского AST
+enum class FlatNodeKind : uint8_t {
+    PROGRAM,
+    VAR_DECL,
+    ASSIGN_STMT,
+    PRINT_STMT,
+    IF_STMT,
+    WHILE_STMT,
+    BINARY_OP,
+    INT_LITERAL,
+    IDENTIFIER
+};
+
+// Плоское представление AST (структура массивов): вид узла и три 32-битных поля
+// хранятся в параллельных массивах, потомки задаются индексами, литералы и списки
+// операторов вынесены в отдельные массивы, имена — номера SymbolInterner. Поля по видам узлов:
+//   PROGRAM      first — начало списка в statementLists, second — число операторов
+//   VAR_DECL     first — имя, second — тип (TokenType), third — номер позиции имени
+//   ASSIGN_STMT  first — имя, second — выражение, third — номер позиции имени
+//   PRINT_STMT   first — выражение
+//   IF_STMT      first — условие, second — блок then, third — блок else или NO_NODE
+//   WHILE_STMT   first — условие, second — тело
+//   BINARY_OP    first — левый операнд, second — правый, third — операция (TokenType)
+//   INT_LITERAL  first — индекс в массиве литералов
+//   IDENTIFIER   first — имя, third — номер позиции имени
+// Позиции имён (для сообщений семантического анализа) лежат в отдельном массиве
+// Потомки создаются раньше родителя, поэтому корень программы добавляется последним
+class FlatAST {
+public:
+    using NodeIndex = uint32_t;
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+private:
+    std::pmr::vector<FlatNodeKind> kinds_;
+    std::pmr::vector<uint32_t> first_;
+    std::pmr::vector<uint32_t> second_;
+    std::pmr::vector<uint32_t> third_;
+
+    std::pmr::vector<NodeIndex> statement_lists_;  // Операторы блоков подряд
+    std::pmr::vector<int> literals_;               // Значения целочисленных литералов
+    std::pmr::vector<SourcePos> positions_;        // Позиции имён узлов VAR_DECL, ASSIGN_STMT, IDENTIFIER
+    NodeIndex root_ = NO_NODE;
+
+public:
+    FlatAST();
+
+    void clear();
+
+    // Построение
+    NodeIndex addNode(FlatNodeKind kind, uint32_t first, uint32_t second = 0, uint32_t third = NO_NODE);
+    NodeIndex addLiteral(int value);
+    NodeIndex addIdentifier(SymbolId name, SourcePos pos);
+    // VAR_DECL (second — тип) или ASSIGN_STMT (second — выражение) с позицией имени
+    NodeIndex addNamed(FlatNodeKind kind, SymbolId name, uint32_t second, SourcePos pos);
+    NodeIndex addProgram(std::span<const NodeIndex> statements);
+    void setRoot(NodeIndex root) { root_ = root; }
+
+    // Доступ к узлам
+    NodeIndex root() const { return root_; }
+    size_t nodeCount() const { return kinds_.size(); }
+    FlatNodeKind kind(NodeIndex node) const { return kinds_[node]; }
+    uint32_t first(NodeIndex node) const { return first_[node]; }
+    uint32_t second(NodeIndex node) const { return second_[node]; }
+    uint32_t third(NodeIndex node) const { return third_[node]; }
+
+    int literal(NodeIndex node) const { return literals_[first_[node]]; }
+    SymbolId symbol(NodeIndex node) const { return first_[node]; }  // VAR_DECL, ASSIGN_STMT, IDENTIFIER
+    SourcePos position(NodeIndex node) const { return positions_[third_[node]]; }  // Те же виды узлов
+    std::span<const NodeIndex> statements(NodeIndex program) const {
+        return std::span<const NodeIndex>(statement_lists_).subspan(first_[program], second_[program]);
+    }
+    TokenType op(NodeIndex node) const { return (TokenType)third_[node]; }
+
+    // Занятая массивами память в байтах (по ёмкости)
+    size_t memoryBytes() const;
+};
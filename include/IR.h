@@ -3,9 +3,12 @@
 #include <string>
 #include <vector>
 #include <ostream>
+#include <cstdint>
+#include <memory_resource>
+#include "SymbolInterner.h"
 
 // Типы операндов в трёхадресном коде
-enum class OperandType {
+enum class OperandType : uint8_t {
     NONE,           // Без операнда
     VARIABLE,       // Переменная исходного кода
     TEMPORARY,      // Временная переменная
@@ -14,7 +17,7 @@ enum class OperandType {
 };
 
 // Типы операций трёхадресного кода
-enum class IROpCode {
+enum class IROpCode : uint8_t {
     // Арифметические операции
     ADD,
     SUB,
@@ -37,26 +40,30 @@ enum class IROpCode {
     JMP_IF_ZERO,
 
     // Ввод/вывод
-    PRINT
+    PRINT,
+
+    // Проверка при выполнении: arg1 — флаг присваивания (0 — ошибка), arg2 — литерал со
+    // слотом переменной для сообщения (не чтение: оптимизатор его не трогает). Ставится
+    // перед чтениями переменных, присваивание которых анализ не доказал (SymbolTable::checkedSlots)
+    CHECK_ASSIGNED
 };
 
 // Вспомогательные функции для вывода
 std::string opCodeToString(IROpCode op);
 std::string operandTypeToString(OperandType type);
 
-// Структура операнда
+// Структура операнда. Имени операнд не хранит: у переменной это номер имени в
+// SymbolInterner::global(), у временной и метки — порядковый номер (печатаются как T<n>, L<n>)
 struct Operand {
     OperandType type = OperandType::NONE;
-    std::string name;    // Имя переменной/метки
+    uint32_t id = 0;     // Имя переменной или номер временной/метки
     int value = 0;       // Значение литерала
+    int slot = -1;       // Ячейка памяти переменной/временной (назначается при семантическом анализе)
 
     Operand() = default;
 
-    // Конструктор для переменных и меток
-    Operand(OperandType t, const std::string& n) : type(t), name(n) {
-        if (t != OperandType::VARIABLE && t != OperandType::TEMPORARY && t != OperandType::LABEL) {
-        }
-    }
+    // Конструктор для переменных, временных и меток
+    Operand(OperandType t, uint32_t n, int s = -1) : type(t), id(n), slot(s) {}
 
     // Конструктор для литералов
     Operand(int v) : type(OperandType::LITERAL), value(v) {}
@@ -77,8 +84,9 @@ struct Instruction {
         : op(op_code), result(res), arg1(a1), arg2(a2) {}
 
     std::string toString() const;
+    void print(std::ostream& os) const;  // Вывод без промежуточной строки
     friend std::ostream& operator<<(std::ostream& os, const Instruction& instr);
 };
 
-// Контейнер для IR-кода
-using IRCode = std::vector<Instruction>;
\ No newline at end of file
+// Контейнер для IR-кода (в арене сеанса, если она активна)
+using IRCode = std::pmr::vector<Instruction>;
\ No newline at end of file
@@ -1,39 +1,79 @@
 #pragma once
 
 #include "AST.h"
+#include "FlatAST.h"
 #include "IR.h"
 #include "ErrorHandler.h"
 
-// Генератор трёхадресного кода из AST
-class IRGenerator : public ASTVisitor {
+class SymbolTable;
+
+// Построитель трёхадресного кода: общая нумерация временных переменных и меток
+// для генератора по AST и для однопроходной трансляции в парсере
+class IRBuilder {
 private:
     IRCode ir_code_;                 // Сгенерированный IR-код
-    ErrorHandler* error_handler_;    // Обработчик ошибок
     int temp_counter_ = 0;           // Счётчик временных переменных
     int label_counter_ = 0;          // Счётчик меток
-    Operand result_operand_;         // Результат последнего посещённого выражения
+    SymbolTable* symbols_ = nullptr; // Слоты переменных (nullptr — операнды без слотов)
+
+    void instrumentChecks();         // CHECK_ASSIGNED перед чтениями переменных из SymbolTable::checkedSlots
 
-    // Вспомогательные методы
-    Operand makeTemp();              // Создание временной переменной
+public:
+    void setSymbols(SymbolTable* symbols) { symbols_ = symbols; }
+
+    Operand makeTemp();              // Создание временной переменной (в новом слоте)
+    Operand makeVariable(SymbolId name) const; // Переменная со слотом из таблицы символов
     Operand makeLabel();             // Создание метки
     void emit(IROpCode op, const Operand& result, const Operand& arg1 = {}, const Operand& arg2 = {}); // Добавление инструкции
-    IROpCode tokenTypeToIROpCode(TokenType type) const; // Конвертация типа токена в IR-операцию
+
+    // Бинарная операция в новую временную переменную
+    Operand emitBinary(TokenType op, const Operand& left, const Operand& right);
+    // Присваивание: литерал загружается через LOAD_IMM, остальное — ASSIGN
+    void emitAssign(const Operand& target, const Operand& value);
+
+    void reset();                    // Сброс кода и счётчиков
+    IRCode finish();                 // Проверки чтений, индексы инструкций и выдача кода
+
+    static IROpCode tokenTypeToIROpCode(TokenType type); // Конвертация типа токена в IR-операцию
+};
+
+// Генератор трёхадресного кода из AST
+class IRGenerator : public StaticASTVisitor<IRGenerator> {
+private:
+    IRBuilder builder_;              // Сгенерированный IR-код и счётчики
+    ErrorHandler* error_handler_;    // Обработчик ошибок
+    Operand result_operand_;         // Результат последнего посещённого выражения
+
+    // Обход плоского AST: выражения вычисляются на явных стеках
+    struct FlatFrame {
+        FlatAST::NodeIndex node;
+        bool operands_ready;         // Оба операнда уже вычислены
+    };
+    std::vector<FlatFrame> flat_frames_;
+    std::vector<Operand> flat_operands_;
+
+    void generateStatement(const FlatAST& ast, FlatAST::NodeIndex node);
+    Operand generateExpression(const FlatAST& ast, FlatAST::NodeIndex node);
 
 public:
-    IRGenerator(ErrorHandler* handler);
+    // symbols — таблица после семантического анализа: операнды получают слоты
+    IRGenerator(ErrorHandler* handler, SymbolTable* symbols = nullptr);
 
     // Основной метод генерации
     IRCode generate(ASTNode* root);
 
+    // Генерация по плоскому AST (без виртуальных вызовов); код совпадает с обходом дерева
+    IRCode generate(const FlatAST& ast);
+
     // Методы обхода AST
-    void visit(ProgramNode& node) override;
-    void visit(VarDeclNode& node) override;
-    void visit(AssignStmtNode& node) override;
-    void visit(PrintStmtNode& node) override;
-    void visit(IfStmtNode& node) override;
-    void visit(WhileStmtNode& node) override;
-    void visit(BinaryOpNode& node) override;
-    void visit(IntLiteralNode& node) override;
-    void visit(IdentifierNode& node) override;
-    void visit(TerminalNode& node) override;
+    void visit(ProgramNode& node);
+    void visit(VarDeclNode& node);
+    void visit(AssignStmtNode& node);
+    void visit(PrintStmtNode& node);
+    void visit(IfStmtNode& node);
+    void visit(WhileStmtNode& node);
+    void visit(BinaryOpNode& node);
+    void visit(IntLiteralNode& node);
+    void visit(IdentifierNode& node);
+    void visit(TerminalNode& node);
 };
\ No newline at end of file
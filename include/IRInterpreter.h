@@ -1,28 +1,47 @@
 #pragma once
 
-#include "IR.h"
-#include <map>
+#include "PackedIR.h"
 #include <string>
+#include <vector>
+#include <array>
 #include <iostream>
 
-// Интерпретатор трёхадресного кода
+// Интерпретатор упакованного трёхадресного кода. Переменные и временные адресуются
+// по слотам, назначенным семантическим анализом, литералы — по таблице констант,
+// цели переходов берутся из таблицы меток, поэтому в цикле выполнения нет поиска
+// по именам. Семантический анализ гарантирует присваивание до чтения, и ячейки при
+// чтении не проверяются; переменные, присваивание которых он доказать не смог, читаются
+// после явной проверки CHECK_ASSIGNED
 class IRInterpreter {
 private:
-    std::map<std::string, int> memory_;      // Память для переменных
-    std::map<std::string, int> label_map_;   // Карта меток
+    std::pmr::vector<int> memory_;         // Значения по слотам
+    const int* constants_ = nullptr;       // Таблица констант выполняемого кода
+    size_t executed_ = 0;                  // Число выполненных инструкций последнего запуска
+    std::array<size_t, (size_t)IROpCode::CHECK_ASSIGNED + 1> executed_by_op_{};  // То же по кодам операций
 
     // Получение значения операнда
-    int getValue(const Operand& op) const;
+    int getValue(const PackedInstruction& instr, int field) const {
+        const uint32_t value = instr.operand(field);
+        return instr.kind(field) == PackedKind::CONST ? constants_[value] : memory_[value];
+    }
 
-    // Сохранение значения в переменную
-    void setValue(const Operand& target, int value);
+    // Сохранение значения в ячейку результата
+    void setValue(const PackedInstruction& instr, int value) {
+        memory_[instr.operand(PackedInstruction::RESULT)] = value;
+    }
 
-    // Построение карты меток
-    void buildLabelMap(const IRCode& code);
+    // Проверка операндов и меток, выделение памяти по слотам
+    void prepare(const PackedIRView& code);
 
 public:
     IRInterpreter() = default;
 
-    // Выполнение IR-кода
-    void execute(const IRCode& code);
-};
\ No newline at end of file
+    // Выполнение IR-кода (в том числе прямо из отображённого модуля IRModule)
+    void execute(const PackedIRView& code);
+    void execute(const PackedIR& code) { execute(code.view()); }
+
+    // Динамическое число инструкций: мера выигрыша оптимизатора на конкретном входе
+    size_t executedCount() const { return executed_; }
+    // Состав выполненных инструкций: сколько раз выполнялась операция op
+    size_t executedCount(IROpCode op) const { return executed_by_op_[(size_t)op]; }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "PackedIR.h"
+#include "SourceBuffer.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Двоичный модуль IR: упакованный код сохраняется в файл и загружается через mmap
+// без разбора инструкций — таблицы модуля используются на месте.
+//
+// Формат (версия 1, порядок байт записавшей машины, разделы выровнены на 8 байт):
+//   заголовок IRModuleHeader (72 байта)
+//   инструкции   — PackedInstruction[instruction_count]
+//   слоты        — PackedSlot[slot_count] (у переменной id — номер имени модуля)
+//   константы    — int32[constant_count]
+//   метки        — uint32[label_count]: позиция LABEL по номеру метки (цели переходов)
+//   имена        — uint32[name_count + 1] смещений и name_bytes байт символов
+struct IRModuleHeader {
+    char magic[4];                 // "MLIR"
+    uint16_t version;
+    uint16_t byte_order;           // 0x0102, записанное в порядке байт машины
+    uint32_t instruction_count;
+    uint32_t slot_count;
+    uint32_t constant_count;
+    uint32_t label_count;
+    uint32_t name_count;
+    uint32_t name_bytes;
+    uint64_t instruction_offset;
+    uint64_t slot_offset;
+    uint64_t constant_offset;
+    uint64_t label_offset;
+    uint64_t name_offset;          // Таблица смещений имён, за ней — символы
+};
+
+static_assert(sizeof(IRModuleHeader) == 72, "IRModuleHeader layout is part of the file format");
+
+class IRModule {
+private:
+    SourceBuffer file_;                      // Отображённый файл модуля
+    std::vector<std::string_view> names_;    // Имена переменных (ссылаются на файл)
+    PackedIRView view_;
+
+public:
+    static constexpr uint16_t VERSION = 2;   // 2 — операция CHECK_ASSIGNED
+
+    IRModule() = default;
+    IRModule(const IRModule&) = delete;
+    IRModule& operator=(const IRModule&) = delete;
+
+    // Сохранение упакованного кода в модуль
+    static void write(const PackedIR& code, std::ostream& out);
+
+    // Загрузка модуля; при ошибке формата — runtime_error ("IR Module Error: ...")
+    void load(const std::string& path);
+
+    // Код модуля: указатели на данные отображённого файла
+    const PackedIRView& view() const { return view_; }
+};
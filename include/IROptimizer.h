@@ -1,22 +1,30 @@
 #pragma once
 
-#include "IR.h"
+#include "PackedIR.h"
 #include <vector>
 
-// Оптимизатор трёхадресного кода
+class ControlFlowGraph;
+class SSAForm;
+
+// Оптимизатор трёхадресного кода (работает на упакованном представлении)
 class IROptimizer {
 private:
     // Основные проходы оптимизации
-    void constantFoldingPass(IRCode& code);          // Свёртка констант
-    void redundantControlFlowPass(IRCode& code);     // Упрощение потока управления
+    void constantFoldingPass(PackedIR& code);        // Свёртка констант
+    void sparseConditionalConstantPass(ControlFlowGraph& cfg, SSAForm& ssa, PackedIR& code);  // SCCP на SSA-форме
+    void globalValueNumberingPass(ControlFlowGraph& cfg, SSAForm& ssa);  // Нумерация значений по дереву доминаторов
+    void copyPropagationPass(ControlFlowGraph& cfg, SSAForm& ssa);  // Распространение копий на SSA-форме
+    void deadCodeEliminationPass(ControlFlowGraph& cfg, SSAForm& ssa, const PackedIR& code);  // Удаление мёртвого кода и недостижимых блоков
+    void loopInvariantCodeMotionPass(ControlFlowGraph& cfg, SSAForm& ssa, const PackedIR& code);  // Вынос инвариантов циклов
+    void inductionVariablePass(ControlFlowGraph& cfg, SSAForm& ssa, PackedIR& code);  // Понижение силы умножений на индуктивные переменные
+    void controlFlowSimplificationPass(ControlFlowGraph& cfg, PackedIR& code);  // Упрощение потока управления
 
-    // Вспомогательные методы
-    bool isLiteral(const Operand& op) const { return op.type == OperandType::LITERAL; }
-    Operand evaluateConstant(IROpCode op, const Operand& arg1, const Operand& arg2); // Вычисление константных выражений
+    // Вычисление константных выражений
+    static int evaluateConstant(IROpCode op, int val1, int val2);
 
 public:
     IROptimizer() = default;
 
-    // Основной метод оптимизации
-    IRCode optimize(const IRCode& code);
-};
\ No newline at end of file
+    // Основной метод оптимизации (код изменяется на месте)
+    void optimize(PackedIR& code);
+};
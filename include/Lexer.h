@@ -1,59 +1,116 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <ostream>
+#include <istream>
+#include <cstddef>
+#include <memory_resource>
 #include "Token.h"
+#include "TokenStore.h"
 #include "ErrorHandler.h"
 
-// Лексический анализатор: преобразует исходный код в поток токенов
+// Правка исходного кода для инкрементального анализа
+struct TextEdit {
+    size_t offset = 0;               // Начало правки в старом исходном коде
+    size_t removed_length = 0;       // Длина удалённого фрагмента
+    std::string_view inserted_text;  // Вставленный текст
+};
+
+// Окно токенов, изменённое инкрементальным анализом:
+// старые токены [first_token, old_end_token) заменены новыми [first_token, new_end_token).
+// Позиции токенов после окна сдвинуты: номера строк — на line_delta, а в строке sync_line
+// (новая нумерация) токены [new_end_token, line_end_token) сдвинуты ещё и на column_delta
+struct RelexResult {
+    size_t first_token = 0;
+    size_t old_end_token = 0;
+    size_t new_end_token = 0;
+    int line_delta = 0;
+    int sync_line = 0;
+    int column_delta = 0;
+    size_t line_end_token = 0;
+};
+
+// Лексический анализатор: преобразует исходный код в поток токенов.
+// Режим буфера: весь исходный код доступен сразу, runLexer() строит tokens_.
+// Потоковый режим: исходный код читается фрагментами, getNextToken() распознаёт
+// токены по запросу, а память ограничена окном размера порядка chunk_size.
 class Lexer {
 private:
-    const std::string source_code_;      // Исходный код программы
-    std::vector<Token> tokens_;          // Список распознанных токенов
+    std::string_view source_code_;       // Исходный код (буфер вызывающего или окно потока)
+    TokenStore tokens_;                  // Распознанные токены блоками (режим буфера; в арене сеанса)
     ErrorHandler* error_handler_;        // Обработчик ошибок
+    SymbolInterner* interner_ = &SymbolInterner::global();  // Интернирование идентификаторов
 
-    size_t current_index_ = 0;           // Текущая позиция в исходном коде
+    size_t current_index_ = 0;           // Текущая позиция в source_code_
     int current_line_ = 1;               // Текущий номер строки
-    size_t line_start_pos_ = 0;          // Начало текущей строки
+    size_t line_start_pos_ = 0;          // Начало текущей строки (абсолютное смещение)
     size_t token_index_ = 0;             // Индекс текущего токена (для парсера)
 
+    // Состояние потокового режима
+    std::istream* input_ = nullptr;      // Источник фрагментов (nullptr в режиме буфера)
+    std::vector<char> window_;           // Переиспользуемое окно чтения
+    size_t chunk_size_ = 0;              // Размер читаемого фрагмента
+    size_t window_offset_ = 0;           // Абсолютное смещение начала окна
+    bool input_exhausted_ = false;       // Поток прочитан до конца
+    bool stream_finished_ = false;       // Выдан токен EOF
+    Token stream_token_;                 // Последний выданный токен
+    std::ostream* token_table_stream_ = nullptr; // Побочный вывод таблицы токенов
+
     // Вспомогательные методы для работы с исходным кодом
     char peek(size_t offset = 0) const;
-    void advance(size_t count = 1);
+    void advance(size_t count = 1);        // Сдвиг внутри строки (без перевода строки)
+    void countLines(size_t from, size_t to); // Учёт переводов строк в диапазоне [from, to)
+    bool refill(size_t keep_from);         // Подкачка фрагмента потока
+    void ensureLookahead(size_t count);    // Предпросмотр count байт через границу фрагмента
     void skipWhitespace();
     void skipComment();
+    void skipTrivia();                     // Пробелы и комментарии до следующего токена
 
-    // Методы проверки символов
     bool isAtEnd() const;
-    bool isDigit(char c) const;
-    bool isAlpha(char c) const;
-    bool isAlphaNumeric(char c) const;
 
     // Методы сканирования токенов
-    void scanNumber();
-    void scanIdentifierOrKeyword();
-    void scanStringLiteral();
-    void scanToken();
-
-    // Таблица ключевых слов
-    const std::map<std::string, TokenType> keywords_ = {
-        {"int", TokenType::TOKEN_INT},
-        {"if", TokenType::TOKEN_IF},
-        {"else", TokenType::TOKEN_ELSE},
-        {"while", TokenType::TOKEN_WHILE},
-        {"print", TokenType::TOKEN_PRINT}
-    };
+    template <typename RunFn>
+    size_t scanRun(RunFn run);
+    bool scanNumber(Token& token);
+    bool scanIdentifierOrKeyword(Token& token);
+    bool scanToken(Token& token);
+    Token makeEofToken() const;
+    const Token& pullToken();
 
 public:
-    Lexer(const std::string& source_code, ErrorHandler* handler);
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t PARALLEL_MIN_CHUNK_BYTES = 256 * 1024;  // Меньшие входы лексируются последовательно
+    static constexpr unsigned CHUNKS_PER_THREAD = 4;                // Фрагментов на поток (балансировка)
+
+    Lexer(std::string_view source_code, ErrorHandler* handler);
+    Lexer(std::istream& input, ErrorHandler* handler, size_t chunk_size = DEFAULT_CHUNK_SIZE);
 
-    // Основной метод лексического анализа
+    // Основной метод лексического анализа (только режим буфера)
     void runLexer();
 
-    // Получение следующего токена (для парсера)
-    Token getNextToken();
+    // Параллельный анализ по фрагментам (режим буфера); результат совпадает с runLexer().
+    // thread_count == 0 — по числу аппаратных потоков
+    void runLexerParallel(unsigned thread_count = 0, size_t min_chunk_bytes = PARALLEL_MIN_CHUNK_BYTES);
+
+    // Инкрементальный анализ после правки (режим буфера, после runLexer()).
+    // new_source — исходный код после применения edit. Повторно лексируется только окно
+    // от токена перед правкой до первого токена, совпавшего со старым потоком; остальные
+    // токены переиспользуются, а сдвиг их смещений и строк применяется лениво по блокам
+    // (TokenStore), поэтому время зависит от размера правки, а не файла. Лексические
+    // ошибки заменённого окна снимаются, ошибки после него сдвигаются вместе с токенами
+    RelexResult relex(std::string_view new_source, const TextEdit& edit);
+
+    // Переход к токену с заданным индексом (режим буфера; для повторного разбора)
+    void seekToken(size_t index) { token_index_ = index; }
+
+    // Получение следующего токена (для парсера). В режиме буфера ссылка действительна,
+    // пока жив лексер; в потоковом режиме — до следующего вызова getNextToken()
+    const Token& getNextToken();
+
+    // Потоковый вывод таблицы токенов (nullptr — отключить)
+    void setTokenTableStream(std::ostream* os);
 
     // Вывод таблицы токенов
     void printTokenTable(std::ostream& os) const;
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// Учёт памяти для отчётов по файлам: число вызовов глобального operator new
+// и пиковый размер резидентной памяти процесса. Считающие operator new/delete
+// (src/HeapCounter.cpp) собираются только в исполняемый файл LTLab, поэтому
+// остальные программы с библиотекой LTLabCore работают с обычной кучей, а
+// heapAllocations() у них остаётся нулём
+namespace MemoryStats {
+    void countHeapAllocation() noexcept;  // Вызывается считающим operator new
+    size_t heapAllocations();   // Число выделений через operator new с начала работы
+    size_t peakRssKb();         // Пиковый RSS процесса в КБ (0, если недоступен)
+    void resetPeakRss();        // Сброс пика RSS перед следующим файлом (Linux), если поддерживается
+}
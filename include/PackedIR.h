@@ -0,0 +1,188 @@
+#pragma once
+
+#include "IR.h"
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+// Вид операнда упакованной инструкции (2 бита)
+enum class PackedKind : uint8_t {
+    NONE = 0,       // Без операнда
+    SLOT = 1,       // Ячейка памяти: номер слота
+    CONST = 2,      // Литерал: номер в таблице констант
+    LABEL = 3       // Метка: номер метки
+};
+
+std::string packedKindToString(PackedKind kind);
+
+// Упакованная инструкция: код операции, виды операндов по 2 бита и три 32-битных
+// значения, которые индексируют таблицы слотов, констант и меток. 16 байт без
+// указателей и строк: копирование кода — копирование памяти
+struct PackedInstruction {
+    static constexpr int RESULT = 0;
+    static constexpr int ARG1 = 1;
+    static constexpr int ARG2 = 2;
+
+    IROpCode op = IROpCode::LABEL;
+    uint8_t kinds = 0;                   // Виды операндов: RESULT — биты 0-1, ARG1 — 2-3, ARG2 — 4-5
+    uint16_t reserved = 0;
+    uint32_t operands[3] = {0, 0, 0};    // Значения операндов RESULT, ARG1, ARG2
+
+    PackedKind kind(int field) const { return (PackedKind)((kinds >> (2 * field)) & 3); }
+    uint32_t operand(int field) const { return operands[field]; }
+
+    void set(int field, PackedKind kind, uint32_t value) {
+        kinds = (uint8_t)((kinds & ~(3 << (2 * field))) | ((int)kind << (2 * field)));
+        operands[field] = value;
+    }
+    void clear(int field) { set(field, PackedKind::NONE, 0); }
+};
+
+static_assert(sizeof(PackedInstruction) == 16, "PackedInstruction must stay 16 bytes");
+
+// Описание слота для печати: переменная (номер имени) или временная (номер T<n>)
+struct PackedSlot {
+    OperandType type = OperandType::NONE;
+    uint32_t id = 0;
+};
+
+static_assert(sizeof(PackedSlot) == 8, "PackedSlot is stored as-is in IR modules");
+
+// Упакованный код без владения: таблицы могут лежать в PackedIR или прямо в
+// отображённом файле модуля (IRModule). Интерпретатор и вывод работают через него
+struct PackedIRView {
+    static constexpr uint32_t NO_TARGET = UINT32_MAX;
+
+    const PackedInstruction* code = nullptr;
+    size_t size = 0;
+    const PackedSlot* slots = nullptr;
+    size_t slot_count = 0;
+    const int* constants = nullptr;
+    size_t constant_count = 0;
+    const uint32_t* labels = nullptr;          // Позиция LABEL по номеру метки
+    size_t label_count = 0;
+    const std::string_view* names = nullptr;   // Имя переменной по PackedSlot::id
+    size_t name_count = 0;
+
+    uint32_t labelTarget(uint32_t label) const {
+        return label < label_count ? labels[label] : NO_TARGET;
+    }
+
+    // Вывод инструкции в том же формате, что и Instruction::print
+    void print(std::ostream& os, size_t index) const;
+    // Вывод всего кода, по инструкции в строке
+    void print(std::ostream& os) const;
+
+    // Имя слота: переменная или T<n>
+    void printSlot(std::ostream& os, uint32_t slot) const;
+
+    // Текст инструкции без индекса (кроме LABEL); операнды выводит operand(os, instr, field)
+    template <typename OperandPrinter>
+    static void printInstruction(std::ostream& os, const PackedInstruction& instr, const OperandPrinter& operand);
+
+private:
+    void printOperand(std::ostream& os, const PackedInstruction& instr, int field) const;
+};
+
+template <typename OperandPrinter>
+void PackedIRView::printInstruction(std::ostream& os, const PackedInstruction& instr, const OperandPrinter& operand) {
+    using P = PackedInstruction;
+    switch (instr.op) {
+        case IROpCode::ADD:
+        case IROpCode::SUB:
+        case IROpCode::MUL:
+        case IROpCode::DIV:
+        case IROpCode::CMP_EQ:
+        case IROpCode::CMP_NE:
+        case IROpCode::CMP_LT:
+        case IROpCode::CMP_GT:
+            operand(os, instr, P::RESULT);
+            os << " = ";
+            operand(os, instr, P::ARG1);
+            os << " " << opCodeToString(instr.op) << " ";
+            operand(os, instr, P::ARG2);
+            break;
+
+        case IROpCode::ASSIGN:
+        case IROpCode::LOAD_IMM:
+            operand(os, instr, P::RESULT);
+            os << " = ";
+            operand(os, instr, P::ARG1);
+            break;
+
+        case IROpCode::JMP:
+        case IROpCode::PRINT:
+            os << opCodeToString(instr.op) << " ";
+            operand(os, instr, P::ARG1);
+            break;
+
+        case IROpCode::JMP_IF_ZERO:
+        case IROpCode::CHECK_ASSIGNED:
+            os << opCodeToString(instr.op) << " ";
+            operand(os, instr, P::ARG1);
+            os << ", ";
+            operand(os, instr, P::ARG2);
+            break;
+
+        default:
+            os << "UNKNOWN INSTRUCTION";
+            break;
+    }
+}
+
+// Упакованный IR-код с таблицами слотов, констант и меток.
+// Позиция инструкции в коде служит её индексом; таблица меток хранит позицию
+// инструкции LABEL и после удаления или вставки инструкций перестраивается
+class PackedIR {
+private:
+    std::pmr::vector<PackedInstruction> code_;
+    std::pmr::vector<PackedSlot> slots_;       // Описание по номеру слота
+    std::pmr::vector<int> constants_;          // Значение по номеру константы
+    std::pmr::vector<uint32_t> labels_;        // Позиция LABEL по номеру метки
+    std::pmr::unordered_map<int, uint32_t> constant_ids_;  // Номер константы по значению
+
+public:
+    static constexpr uint32_t NO_TARGET = PackedIRView::NO_TARGET;
+
+    // Преобразование из развёрнутого IR; операнды переменных должны иметь слоты
+    static PackedIR fromCode(const IRCode& code);
+    // Обратное преобразование (индексы инструкций — позиции)
+    IRCode toCode() const;
+
+    std::pmr::vector<PackedInstruction>& code() { return code_; }
+    const std::pmr::vector<PackedInstruction>& code() const { return code_; }
+    size_t size() const { return code_.size(); }
+    bool empty() const { return code_.empty(); }
+
+    size_t slotCount() const { return slots_.size(); }
+    const std::pmr::vector<PackedSlot>& slots() const { return slots_; }
+    const std::pmr::vector<uint32_t>& labels() const { return labels_; }
+    const PackedSlot& slot(uint32_t index) const { return slots_[index]; }
+    const std::pmr::vector<int>& constants() const { return constants_; }
+    int constant(uint32_t index) const { return constants_[index]; }
+
+    // Номер константы (одинаковые значения разделяют номер)
+    uint32_t addConstant(int value);
+    // Номер нового слота
+    uint32_t addSlot(PackedSlot slot);
+
+    // Позиция инструкции LABEL метки (NO_TARGET — метка не определена)
+    uint32_t labelTarget(uint32_t label) const {
+        return label < labels_.size() ? labels_[label] : NO_TARGET;
+    }
+    // Пересчёт таблицы меток по текущему коду
+    void rebuildLabels();
+    // Номер новой метки (больше всех известных; позиция появится после rebuildLabels)
+    uint32_t newLabel();
+
+    size_t memoryBytes() const;
+
+    // Представление для интерпретатора и вывода; имена переменных — из SymbolInterner::global()
+    PackedIRView view() const;
+
+    void print(std::ostream& os, size_t index) const { view().print(os, index); }
+    void print(std::ostream& os) const { view().print(os); }
+};
@@ -1,39 +1,77 @@
 #pragma once
 
 #include <memory>
+#include <cstddef>
+#include <vector>
 #include "Token.h"
 #include "Lexer.h"
 #include "ErrorHandler.h"
 #include "AST.h"
+#include "FlatAST.h"
+#include "IR.h"
 
-// Синтаксический анализатор (нисходящий рекурсивный парсер)
+class SemanticAnalyzer;
+
+// Синтаксический анализатор (нисходящий разбор на явных стеках)
 class Parser {
 private:
     Lexer* lexer_;
     ErrorHandler* error_handler_;
-    Token current_token_;
+    const Token* current_token_;   // Текущий токен (ссылка в поток токенов лексера)
+    size_t token_position_ = 0;    // Индекс текущего токена в потоке
+    bool speculative_ = false;     // Пробный разбор: ошибки не регистрируются
 
     // Основные методы парсера
     void match(TokenType expected_type);     // Проверка и потребление токена
     bool check(TokenType type);              // Проверка типа текущего токена
     void parseError(const std::string& message); // Сообщение об ошибке
     void consume();                          // Переход к следующему токену
+    void seek(size_t token_index);           // Переход к токену (режим буфера)
+    bool isStatementStart();                 // Текущий токен начинает оператор
+
+    // Открытый блок на явном стеке разбора операторов
+    enum class BlockKind { OUTER, IF_THEN, IF_ELSE, WHILE };
+    struct BlockFrame {
+        BlockKind kind;
+        size_t owner_start;                  // Индекс первого токена оператора-владельца
+        size_t statement_count;              // Разобрано операторов в блоке
+    };
 
-    // Рекурсивные методы разбора
+    // Стек операций выражения (переиспользуется между выражениями)
+    std::vector<TokenType> expr_operators_;
+
+    // Методы разбора (без рекурсии по длине входа). Builder получает события разбора:
+    // построитель AST или генератор IR при однопроходной трансляции
+    template <typename Builder> void parseStatementsWith(Builder& builder, bool single_statement);
+    template <typename Builder> typename Builder::Value parseConditionWith(Builder& builder);
+    template <typename Builder> typename Builder::Value parseExprWith(Builder& builder);
+    template <typename Builder> typename Builder::Value parseFactorWith(Builder& builder);
     std::unique_ptr<ASTNode> parseStmtList();        // Список операторов
-    std::unique_ptr<ASTNode> parseStmtListRest(std::unique_ptr<ASTNode> current_list);
-    std::unique_ptr<ASTNode> parseStmt();            // Оператор
-    std::unique_ptr<ASTNode> parseCondition();       // Условие
-    std::unique_ptr<ASTNode> parseExpr();            // Выражение
-    std::unique_ptr<ASTNode> parseExprRest(std::unique_ptr<ASTNode> left_expr);
-    std::unique_ptr<ASTNode> parseTerm();            // Терм
-    std::unique_ptr<ASTNode> parseTermRest(std::unique_ptr<ASTNode> left_term);
-    std::unique_ptr<ASTNode> parseFactor();          // Фактор
-    std::unique_ptr<ASTNode> parseStmtElse();        // Else-ветка
+    std::unique_ptr<ASTNode> parseStmt();            // Один оператор
+
+    // Повторный разбор наименьшего блока, содержащего изменённые старые токены
+    bool reparseBlock(ProgramNode& block, size_t block_begin, const RelexResult& damage);
 
 public:
     Parser(Lexer* lexer, ErrorHandler* handler);
 
     // Основной метод парсинга программы
     std::unique_ptr<ASTNode> parseProgram();
+
+    // Разбор в плоское представление AST (без узлов-объектов в куче).
+    // false — синтаксическая ошибка (ошибка зарегистрирована в обработчике)
+    bool parseProgramFlat(FlatAST& ast);
+
+    // Инкрементальный разбор после Lexer::relex(): повторно разбираются только операторы
+    // наименьшего блока {} (или программы), содержащего изменённые токены; остальные
+    // поддеревья переиспользуются. Если локальный разбор невозможен (например, правка
+    // нарушила баланс скобок), root заменяется результатом полного разбора и возвращается false;
+    // синтаксические ошибки прежнего полного разбора перед ним снимаются
+    bool reparse(std::unique_ptr<ASTNode>& root, const RelexResult& damage);
+
+    // Однопроходная трансляция: инструкции выдаются по мере распознавания конструкций,
+    // AST не строится. Нумерация временных переменных и меток совпадает с IRGenerator.
+    // semantics — семантический анализ по ходу трансляции (операнды получают слоты).
+    // false — синтаксическая ошибка (ошибка зарегистрирована в обработчике)
+    bool translateProgram(IRCode& ir_code, SemanticAnalyzer* semantics = nullptr);
 };
\ No newline at end of file
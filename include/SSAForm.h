@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ControlFlowGraph.h"
+#include "PackedIR.h"
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <vector>
+
+// Значение SSA: слот исходного кода и номер версии. Версия 0 — содержимое слота на
+// входе в программу; номер такого значения совпадает с номером слота
+struct SSAValue {
+    uint32_t slot;
+    uint32_t version;
+};
+
+// Усечённая (pruned) SSA-форма над графом потока управления. Пока форма построена,
+// операнды SLOT в блоках графа — номера значений SSA, а не слотов: у каждого значения
+// ровно одно определение. φ-функции ставятся на итерированной границе доминирования
+// только там, где слот жив на входе в блок.
+//
+// Выход из SSA (destruct): каждая φ-функция заменяется копиями в конце предшественников
+// и копией в начале блока (метод I Sreedhar и др.), затем копии сливаются, если
+// интервалы жизни значений не пересекаются. Слившиеся значения получают общий слот
+// (по возможности исходный), слившиеся копии удаляются
+class SSAForm {
+public:
+    static constexpr uint32_t NO_VALUE = UINT32_MAX;
+
+private:
+    ControlFlowGraph& cfg_;
+    PackedIR& code_;
+    std::pmr::vector<SSAValue> values_;
+    std::pmr::vector<uint32_t> next_version_;   // Следующая версия по слоту
+    uint32_t entry_values_ = 0;                 // Значения версии 0: слоты на момент построения
+    uint32_t next_temp_ = 0;                    // Номер следующей временной для addTemporary()
+    size_t phi_count_ = 0;
+    size_t copies_inserted_ = 0;
+    size_t copies_coalesced_ = 0;
+
+    uint32_t newValue(uint32_t slot);
+    void placePhis();
+    void rename();
+
+public:
+    // Построение по графу после cfg.analyze(); код даёт таблицы слотов и констант
+    SSAForm(ControlFlowGraph& cfg, PackedIR& code);
+    SSAForm(const SSAForm&) = delete;
+    SSAForm& operator=(const SSAForm&) = delete;
+
+    size_t valueCount() const { return values_.size(); }
+    const SSAValue& value(uint32_t v) const { return values_[v]; }
+    size_t phiCount() const { return phi_count_; }
+
+    // Новое значение в новом временном слоте: для проходов, которые добавляют вычисления.
+    // Определить его (инструкцией или φ-функцией) должен сам проход
+    uint32_t addTemporary();
+
+    // Вывод по блокам: значения печатаются как имя.версия
+    void print(std::ostream& os) const;
+
+    // Возврат к слотам; после него граф можно линеаризовать
+    void destruct();
+    size_t copiesInserted() const { return copies_inserted_; }
+    size_t copiesCoalesced() const { return copies_coalesced_; }
+};
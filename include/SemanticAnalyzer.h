@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory_resource>
+#include "SymbolInterner.h"
+#include "AST.h"
+#include "FlatAST.h"
+#include "ErrorHandler.h"
+
+// Таблица символов: каждой переменной и временной переменной назначается плотный
+// номер ячейки (слот), по которому интерпретатор обращается к памяти без поиска по имени.
+// Слоты переменных хранятся в массиве по номеру имени (SymbolId), без хеширования
+class SymbolTable {
+private:
+    std::pmr::vector<int> slots_;        // Слот по номеру имени (NO_SLOT — не объявлено)
+    std::pmr::vector<int> checked_;      // Слоты переменных с проверкой чтения при выполнении
+    size_t variable_count_ = 0;
+    int slot_count_ = 0;
+
+public:
+    static constexpr int NO_SLOT = -1;
+
+    // Новая переменная; NO_SLOT — имя уже объявлено
+    int declare(SymbolId name);
+    // Слот переменной; NO_SLOT — имя не объявлено
+    int find(SymbolId name) const {
+        return name < slots_.size() ? slots_[name] : NO_SLOT;
+    }
+    // Слот для временной переменной (без имени в таблице)
+    int newSlot() { return slot_count_++; }
+
+    // Переменная может читаться до присваивания на части путей: генератор IR ставит
+    // перед её чтениями проверку флага присваивания (слот добавляется один раз)
+    void requireCheck(int slot) { checked_.push_back(slot); }
+    const std::pmr::vector<int>& checkedSlots() const { return checked_; }
+
+    int slotCount() const { return slot_count_; }
+    size_t variableCount() const { return variable_count_; }
+    void clear();
+};
+
+// Семантический анализ: объявления переменных до использования и присваивание до чтения.
+// Чтение переменной, которой не присвоено значение ни на одном пути к нему (с учётом
+// обратных дуг циклов), — ошибка. Если значение присвоено лишь на части путей, выдаётся
+// предупреждение, а переменная попадает в SymbolTable::checkedSlots: её чтения проверяются
+// при выполнении, как до появления анализа. Остальные чтения гарантированно видят
+// записанное значение, и интерпретатор их не проверяет.
+// Чтение внутри цикла без присваивания на путях до него откладывается до конца цикла:
+// присваивание ниже по телу достигает его по обратной дуге.
+// Области видимости нет: объявление действует до конца программы.
+// Анализ управляется событиями разбора (declare/use/assign и границы ветвлений), поэтому
+// одинаково работает по дереву, по плоскому AST и при однопроходной трансляции
+class SemanticAnalyzer : public StaticASTVisitor<SemanticAnalyzer> {
+private:
+    SymbolTable& symbols_;
+    ErrorHandler* error_handler_;
+
+    // Состояние по слотам переменных
+    std::vector<uint8_t> assigned_;          // Значение определённо присвоено
+    std::vector<uint8_t> maybe_;             // Значение присвоено хотя бы на одном пути
+    std::vector<uint8_t> reported_;          // Выданные по переменной сообщения (REPORTED_*)
+    std::vector<uint32_t> marks_;            // Метки для пересечения множеств ветвей
+    uint32_t mark_epoch_ = 0;
+
+    static constexpr uint8_t REPORTED_ERROR = 1;
+    static constexpr uint8_t REPORTED_WARNING = 2;
+
+    // Журналы присваиваний: слоты, ставшие (возможно) присвоенными, в порядке записи.
+    // При выходе из ветви её записи откатываются, поэтому анализ линеен по размеру программы
+    std::vector<int> trail_;
+    std::vector<int> saved_;                 // Присвоенное в ветвях then (до конца if)
+    std::vector<int> maybe_trail_;
+    std::vector<int> maybe_saved_;           // Возможно присвоенное в ветвях then
+    struct Branch {
+        size_t trail_start;
+        size_t saved_start;
+        size_t maybe_start;
+        size_t maybe_saved_start;
+        size_t pending_start;
+        bool has_else;
+    };
+    std::vector<Branch> branches_;
+
+    // Чтения в циклах, не присвоенные ни на одном пути до них: решаются в конце цикла
+    struct PendingRead {
+        int slot;
+        SymbolId name;
+        SourcePos pos;
+    };
+    std::vector<PendingRead> pending_;
+    size_t loop_depth_ = 0;
+
+    // Обход выражений без рекурсии
+    std::vector<const ASTNode*> expression_stack_;
+    std::vector<FlatAST::NodeIndex> flat_stack_;
+
+    void errorOnce(int slot, SourcePos pos, const std::string& message);
+    void warnOnce(int slot, SymbolId name, SourcePos pos);
+    void resize();
+    void markAssigned(int slot);
+    void markMaybe(int slot);
+    void rollback(size_t trail_start);
+    void rollbackMaybe(size_t maybe_start);
+
+public:
+    SemanticAnalyzer(SymbolTable& symbols, ErrorHandler* handler);
+
+    SymbolTable& symbols() { return symbols_; }
+
+    // События разбора; pos — позиция имени для сообщений. use/assign возвращают слот
+    // переменной (для необъявленной после сообщения об ошибке создаётся слот, чтобы не
+    // повторять ошибку)
+    void declare(SymbolId name, SourcePos pos);
+    int use(SymbolId name, SourcePos pos);
+    int assign(SymbolId name, SourcePos pos);
+    void beginBranch();                  // Тело then (после условия)
+    void beginElse();
+    void endIf();
+    void beginLoop();                    // Тело цикла (после условия)
+    void endWhile();
+    // Конец программы: отложенные чтения, так и не присвоенные, становятся ошибками
+    void finish();
+
+    // Анализ построенного AST; false — найдены ошибки (зарегистрированы в обработчике)
+    bool analyze(ASTNode& root);
+    bool analyze(const FlatAST& ast);
+
+    // Методы обхода AST
+    void visit(ProgramNode& node);
+    void visit(VarDeclNode& node);
+    void visit(AssignStmtNode& node);
+    void visit(PrintStmtNode& node);
+    void visit(IfStmtNode& node);
+    void visit(WhileStmtNode& node);
+    void visit(BinaryOpNode& node);
+    void visit(IntLiteralNode& node);
+    void visit(IdentifierNode& node);
+    void visit(TerminalNode& node);
+
+private:
+    void useExpression(const ASTNode& expression);
+    void analyzeStatement(const FlatAST& ast, FlatAST::NodeIndex node);
+    void useExpression(const FlatAST& ast, FlatAST::NodeIndex node);
+};
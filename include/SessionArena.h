@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Арена сеанса компиляции: токены, узлы AST, операнды и код IR размещаются
+// последовательно в крупных блоках, освобождение отдельных объектов бесплатно.
+// reset() возвращает всю память сразу, но оставляет блоки за ареной, поэтому
+// при пакетной компиляции следующий файл обходится без обращений к malloc.
+// Арена однопоточная: выделения из других потоков передаются в кучу, а освобождать
+// память можно из любого потока
+class SessionArena : public std::pmr::memory_resource {
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;          // Блоки памяти (сохраняются между сбросами)
+    size_t current_block_ = 0;           // Блок, из которого идёт выделение
+    size_t offset_ = 0;                  // Занято байт в текущем блоке
+    size_t bytes_used_ = 0;              // Занято байт с последнего сброса
+    size_t peak_bytes_used_ = 0;         // Максимум bytes_used_ за сеанс
+    size_t last_session_bytes_ = 0;      // Занято байт к моменту последнего сброса
+    size_t block_allocations_ = 0;       // Обращений к куче за блоками
+    size_t default_block_size_;
+    std::thread::id owner_;              // Поток, которому принадлежит арена
+    // Список блоков меняет только владелец (под блокировкой); чужие потоки читают его
+    // в do_deallocate под той же блокировкой, владельцу для чтения она не нужна
+    mutable std::mutex blocks_mutex_;
+
+    bool owns(const void* ptr) const;
+    void addBlock(size_t min_size);
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    explicit SessionArena(size_t block_size = DEFAULT_BLOCK_SIZE);
+    ~SessionArena() override;
+
+    SessionArena(const SessionArena&) = delete;
+    SessionArena& operator=(const SessionArena&) = delete;
+
+    // Освобождение всех объектов арены; блоки остаются для повторного использования
+    void reset();
+
+    size_t bytesUsed() const { return bytes_used_; }
+    size_t peakBytesUsed() const { return peak_bytes_used_; }
+    size_t lastSessionBytes() const { return last_session_bytes_; }
+    size_t bytesReserved() const;
+    size_t blockAllocations() const { return block_allocations_; }
+
+    // Арена, активная в текущем потоке (nullptr — нет)
+    static SessionArena* current();
+    // Ресурс для размещения: активная арена или куча
+    static std::pmr::memory_resource* resource();
+
+    // Область компиляции одного файла: арена становится активной и ресурсом pmr
+    // по умолчанию; при выходе прежние значения восстанавливаются, а арена сбрасывается.
+    // Все объекты, размещённые в арене, должны быть уничтожены до конца области.
+    // Ресурс по умолчанию общий для процесса: области вкладываются в одном потоке, а
+    // вход в область, пока она открыта в другом потоке, бросает runtime_error
+    // (рабочие потоки внутри области её арену не трогают: их выделения идут в кучу)
+    class Scope {
+    private:
+        SessionArena& arena_;
+        SessionArena* previous_arena_;
+        std::pmr::memory_resource* previous_default_ = nullptr;
+    public:
+        explicit Scope(SessionArena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
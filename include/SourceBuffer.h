@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Буфер исходного кода: файл отображается в память один раз,
+// токены ссылаются на этот буфер без копирования
+class SourceBuffer {
+private:
+    const char* data_ = nullptr;   // Начало отображённых данных
+    size_t size_ = 0;              // Размер файла в байтах
+    bool mapped_ = false;          // Данные получены через mmap
+    std::string fallback_;         // Резервное хранилище (нет mmap или пустой файл)
+
+    void release();
+
+public:
+    SourceBuffer() = default;
+    ~SourceBuffer();
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+    // Открытие файла; false, если файл не удалось прочитать
+    bool open(const std::string& path);
+
+    // Представление всего исходного кода
+    std::string_view view() const { return std::string_view(data_ ? data_ : "", size_); }
+    size_t size() const { return size_; }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Идентификатор имени: плотный номер в таблице интернирования
+using SymbolId = uint32_t;
+
+// Таблица интернирования имён: каждое различное имя получает 32-битный номер один раз
+// (в лексере), дальше по конвейеру — AST, IR, интерпретатор — передаётся только номер,
+// а имя восстанавливается при печати. Символы имён хранятся в собственных блоках и не
+// перемещаются, поэтому name() действителен всё время жизни таблицы.
+// Глобальная таблица живёт до конца процесса и не зависит от арены сеанса: номера
+// одинаковы для всех файлов. Таблица не потокобезопасна — параллельный лексер
+// интернирует во фрагментах в локальные таблицы и переводит номера при слиянии
+class SymbolInterner {
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    // Ячейка открытой адресации: хеш рядом с номером, чтобы проба не читала другие массивы
+    struct Slot {
+        uint32_t hash;
+        uint32_t id_plus_one;                      // Номер + 1, 0 — пусто
+    };
+
+    std::vector<std::unique_ptr<char[]>> blocks_;  // Символы имён
+    size_t block_used_ = BLOCK_SIZE;               // Занято в последнем блоке
+    std::vector<std::string_view> names_;          // Имя по номеру
+    std::vector<Slot> table_;
+
+    static uint32_t hash(std::string_view name);
+    std::string_view store(std::string_view name);
+    void grow();
+
+public:
+    static constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+    SymbolInterner();
+
+    SymbolInterner(const SymbolInterner&) = delete;
+    SymbolInterner& operator=(const SymbolInterner&) = delete;
+
+    // Таблица процесса, общая для всех стадий компиляции
+    static SymbolInterner& global();
+
+    // Номер имени (новое имя добавляется)
+    SymbolId intern(std::string_view name);
+    // Номер имени или NO_SYMBOL, если имя не встречалось
+    SymbolId find(std::string_view name) const;
+
+    std::string_view name(SymbolId id) const { return names_[id]; }
+    // Имена по номерам подряд (указатель действителен до следующего intern)
+    const std::string_view* nameTable() const { return names_.data(); }
+    size_t size() const { return names_.size(); }
+};
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include "SymbolInterner.h"
 
 // Типы лексем
-enum class TokenType {
+enum class TokenType : uint8_t {
     // Ключевые слова
     TOKEN_INT, TOKEN_IF, TOKEN_ELSE, TOKEN_WHILE, TOKEN_PRINT,
 
@@ -35,7 +38,7 @@ enum class TokenType {
 };
 
 // Классы лексем для классификации
-enum class TokenClass {
+enum class TokenClass : uint8_t {
     KEYWORD,
     LITERAL,
     IDENTIFIER,
@@ -45,18 +48,28 @@ enum class TokenClass {
     UNKNOWN
 };
 
-// Структура лексемы
+// Позиция в исходном тексте: строка и столбец начала лексемы
+struct SourcePos {
+    int line = 0;
+    int position = 0;
+};
+
+// Структура лексемы: значение ссылается на буфер исходного кода без копирования,
+// идентификатор дополнительно несёт номер интернированного имени
 struct Token {
     TokenType type;
     TokenClass token_class;
-    std::string value;
+    SymbolId symbol = SymbolInterner::NO_SYMBOL;  // Только для идентификаторов
+    std::string_view value;
     int line;
     int position;
 
     Token() : type(TokenType::TOKEN_ERROR), token_class(TokenClass::UNKNOWN), line(0), position(0) {}
 
-    Token(TokenType t, TokenClass tc, const std::string& v, int l, int p)
-        : type(t), token_class(tc), value(v), line(l), position(p) {}
+    Token(TokenType t, TokenClass tc, std::string_view v, int l, int p, SymbolId s = SymbolInterner::NO_SYMBOL)
+        : type(t), token_class(tc), symbol(s), value(v), line(l), position(p) {}
+
+    SourcePos where() const { return SourcePos{line, position}; }
 
     // Вспомогательные методы для вывода
     std::string typeToString() const;
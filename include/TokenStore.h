@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+#include "Token.h"
+
+// Хранилище токенов режима буфера: обычные токены лежат блоками не больше
+// 2 * BLOCK_TOKENS, EOF хранится отдельно (его значение не ссылается на исходный код).
+// Правка заменяет токены только в блоках, которые она задела, а сдвиг смещений и номеров
+// строк для следующих блоков копится в их заголовках и применяется к токенам при первом
+// обращении к блоку. Так же лениво токены переезжают в новый буфер исходного кода (rebase).
+// Ссылка из operator[] действительна до следующего изменения хранилища
+class TokenStore {
+public:
+    static constexpr size_t BLOCK_TOKENS = 1024;
+
+    size_t size() const { return count_ + (has_eof_ ? 1 : 0); }
+    bool empty() const { return size() == 0; }
+
+    // Токен по индексу (EOF — последний); блок приводится к текущему буферу и сдвигам
+    const Token& operator[](size_t index) const { return at(index); }
+    Token& operator[](size_t index) { return at(index); }
+    const Token& back() const { return locate(size() - 1); }
+
+    // Смещение обычного токена в текущем буфере (без применения сдвигов к блоку)
+    size_t offsetOf(size_t index) const;
+
+    void clear();
+    void reserve(size_t count);
+    void push_back(const Token& token);     // Обычный токен в конец (до EOF)
+    void setEof(const Token& token);
+
+    // Равномерные блоки из count обычных токенов; slot() пишет в них без курсора
+    // (параллельное слияние фрагментов) и действителен только до других изменений
+    void resize(size_t count);
+    Token& slot(size_t index) { return blocks_[index / BLOCK_TOKENS][index % BLOCK_TOKENS]; }
+
+    // Новый буфер исходного кода: смещения токенов сохраняются
+    void rebase(const char* base);
+    // Сдвиг смещений и номеров строк токенов начиная с from (номер строки EOF тоже)
+    void shift(size_t from, std::ptrdiff_t offset_delta, int line_delta);
+    // Замена обычных токенов [first, last) токенами fresh (значения — в текущем буфере)
+    void replace(size_t first, size_t last, const std::vector<Token>& fresh);
+
+private:
+    // Заголовок блока: индекс первого токена и ещё не применённые к токенам поправки
+    struct BlockState {
+        size_t start = 0;
+        std::ptrdiff_t offset_shift = 0;
+        int line_shift = 0;
+        const char* base = nullptr;          // Буфер, на который указывают значения токенов
+    };
+
+    mutable std::pmr::vector<std::pmr::vector<Token>> blocks_;
+    mutable std::pmr::vector<BlockState> states_;
+    size_t count_ = 0;                       // Обычных токенов
+    mutable Token eof_;
+    bool has_eof_ = false;
+    const char* base_ = nullptr;
+
+    // Последний блок, к которому обращались (последовательное чтение парсером)
+    mutable size_t cursor_begin_ = 0;
+    mutable size_t cursor_end_ = 0;
+    mutable Token* cursor_ = nullptr;
+
+    size_t blockOf(size_t index) const;      // Блок обычного токена
+    void materialize(size_t block) const;    // Применение отложенных поправок блока
+    Token& locate(size_t index) const;       // Поиск блока, курсор переходит на него
+    Token& at(size_t index) const {
+        if (index - cursor_begin_ < cursor_end_ - cursor_begin_) {
+            return cursor_[index - cursor_begin_];
+        }
+        return locate(index);
+    }
+    void resetCursor() const { cursor_begin_ = cursor_end_ = 0; }
+    void restart(size_t from_block);         // Пересчёт индексов первых токенов блоков
+};
@@ -7,22 +7,36 @@
 #include <iomanip>
 #include <vector>
 #include <filesystem>
+#include <chrono>
 
 // Заголовочные файлы компилятора
+#include "SourceBuffer.h"
 #include "Lexer.h"
 #include "Parser.h"
 #include "ErrorHandler.h"
 #include "AST.h"
+#include "FlatAST.h"
 #include "ASTVisualizer.h"
+#include "ASTSerializer.h"
 #include "IR.h"
+#include "PackedIR.h"
+#include "IRModule.h"
+#include "ControlFlowGraph.h"
+#include "SSAForm.h"
+#include "SemanticAnalyzer.h"
 #include "IRGenerator.h"
 #include "IROptimizer.h"
 #include "IRInterpreter.h"
+#include "SessionArena.h"
+#include "MemoryStats.h"
 
 // Конфигурация путей
 const std::string INPUT_DIR = "../input/";
 const std::string OUTPUT_BASE_DIR = "../output/";
 
+// Порог размера файла, начиная с которого лексер работает в потоковом режиме
+const std::uintmax_t STREAMING_THRESHOLD_BYTES = 64ull * 1024 * 1024;
+
 // Создание выходной директории при необходимости
 void create_directory_if_not_exists(const std::string& path) {
     if (!std::filesystem::exists(path)) {
@@ -60,8 +74,24 @@ struct OutputRedirector {
     }
 };
 
+// Представление программы между разбором и генерацией IR
+enum class Frontend {
+    TREE_AST,       // Дерево узлов-объектов (по умолчанию)
+    FLAT_AST,       // Плоский AST в массивах (--flat-ast)
+    SINGLE_PASS     // Однопроходная трансляция в IR без AST (--no-ast)
+};
+
 // Обработка одного файла через все этапы компиляции
-int process_file(const std::string& input_filename, const std::string& output_folder_name) {
+// Формат дополнительного дампа AST
+enum class AstDump {
+    NONE,
+    JSON,           // ast.json
+    DOT,            // ast.dot (Graphviz)
+    BINARY          // ast.bin (загружается ASTSerializer::readBinary)
+};
+
+int process_file(const std::string& input_filename, const std::string& output_folder_name, Frontend frontend,
+                 AstDump ast_dump) {
     // Определение путей к файлам
     const std::string INPUT_FILE = INPUT_DIR + input_filename;
     const std::string OUTPUT_DIR = OUTPUT_BASE_DIR + output_folder_name + "/";
@@ -72,7 +102,9 @@ int process_file(const std::string& input_filename, const std::string& output_fo
     const std::string OUTPUT_TOKEN_FILE = OUTPUT_DIR + "tokens_table.md";
     const std::string OUTPUT_AST_FILE = OUTPUT_DIR + "ast_structure.txt";
     const std::string OUTPUT_IR_FILE = OUTPUT_DIR + "generated_ir.asm";
+    const std::string OUTPUT_SSA_FILE = OUTPUT_DIR + "ssa_ir.asm";
     const std::string OUTPUT_IR_OPT_FILE = OUTPUT_DIR + "optimized_ir.asm";
+    const std::string OUTPUT_IR_MODULE_FILE = OUTPUT_DIR + "optimized_ir.bin";
 
     create_directory_if_not_exists(OUTPUT_DIR);
 
@@ -81,32 +113,28 @@ int process_file(const std::string& input_filename, const std::string& output_fo
     std::cout << ">>> RESULTS TO FOLDER: " << output_folder_name << " <<<\n";
     std::cout << "================================================\n";
 
-    // Чтение исходного кода
-    std::ifstream ifs(INPUT_FILE);
-    if (!ifs.is_open()) {
+    // Большие файлы лексируются потоково: токены распознаются по запросу парсера,
+    // а таблица токенов пишется побочным потоком по мере их выдачи
+    std::error_code size_error;
+    const std::uintmax_t input_size = std::filesystem::file_size(INPUT_FILE, size_error);
+    const bool streaming = !size_error && input_size >= STREAMING_THRESHOLD_BYTES;
+
+    // Отображение исходного кода в память (токены ссылаются на этот буфер)
+    SourceBuffer source;
+    std::ifstream stream_input;
+    if (streaming) {
+        stream_input.open(INPUT_FILE, std::ios::binary);
+    }
+    if (streaming ? !stream_input.is_open() : !source.open(INPUT_FILE)) {
         std::cerr << "Error: Could not open input file: " << INPUT_FILE << std::endl;
         return 1;
     }
 
-    std::stringstream buffer;
-    buffer << ifs.rdbuf();
-    std::string source_code = buffer.str();
-
     // Инициализация обработчика ошибок
     ErrorHandler error_handler;
 
-    // Лексический анализ
-    std::cout << "\n========================================\n";
-    std::cout << "1. STARTING LEXICAL ANALYSIS\n";
-    std::cout << "========================================\n";
-    Lexer lexer(source_code, &error_handler);
-    lexer.runLexer();
-
-    // Сохранение таблицы токенов
-    std::cout << "[INFO] Saving Token Table to: " << OUTPUT_TOKEN_FILE << "\n";
-    lexer.writeTokenTableToFile(OUTPUT_TOKEN_FILE);
-
-    if (error_handler.hasErrors()) {
+    // Отчёт о лексических ошибках
+    auto report_lexical_failure = [&]() {
         {
             OutputRedirector error_redirector(OUTPUT_ERROR_LOG);
             if (error_redirector.is_open()) {
@@ -116,19 +144,99 @@ int process_file(const std::string& input_filename, const std::string& output_fo
         }
         std::cerr << "\n[FATAL] Lexical analysis failed for " << input_filename << ". See " << OUTPUT_ERROR_LOG << " for details.\n";
         return 2;
+    };
+
+    // Отчёт о семантических ошибках
+    auto report_semantic_failure = [&]() {
+        {
+            OutputRedirector error_redirector(OUTPUT_ERROR_LOG);
+            if (error_redirector.is_open()) {
+                error_handler.printErrors(std::cerr);
+                std::cerr << "\n[FATAL] Semantic analysis failed for " << input_filename << ". Aborting compilation.\n";
+            }
+        }
+        std::cerr << "\n[FATAL] Semantic analysis failed for " << input_filename << ". See " << OUTPUT_ERROR_LOG << " for details.\n";
+        return 4;
+    };
+
+    // Предупреждения семантического анализа не останавливают компиляцию
+    auto report_warnings = [&]() {
+        if (!error_handler.getWarnings().empty()) {
+            error_handler.printWarnings(std::cerr);
+        }
+    };
+
+    // Лексический анализ
+    std::cout << "\n========================================\n";
+    std::cout << "1. STARTING LEXICAL ANALYSIS\n";
+    std::cout << "========================================\n";
+    std::unique_ptr<Lexer> lexer_ptr = streaming
+        ? std::make_unique<Lexer>(stream_input, &error_handler)
+        : std::make_unique<Lexer>(source.view(), &error_handler);
+    Lexer& lexer = *lexer_ptr;
+
+    std::ofstream token_stream;
+    if (streaming) {
+        std::cout << "[INFO] Streaming mode (" << input_size << " bytes): tokens are produced on demand.\n";
+        std::cout << "[INFO] Streaming Token Table to: " << OUTPUT_TOKEN_FILE << "\n";
+        token_stream.open(OUTPUT_TOKEN_FILE);
+        if (token_stream.is_open()) {
+            lexer.setTokenTableStream(&token_stream);
+        }
+    } else {
+        lexer.runLexerParallel();
+
+        // Сохранение таблицы токенов
+        std::cout << "[INFO] Saving Token Table to: " << OUTPUT_TOKEN_FILE << "\n";
+        lexer.writeTokenTableToFile(OUTPUT_TOKEN_FILE);
+
+        if (error_handler.hasErrors()) {
+            return report_lexical_failure();
+        }
+        std::cout << "[INFO] Lexical analysis completed successfully.\n";
     }
-    std::cout << "[INFO] Lexical analysis completed successfully.\n";
 
     // Синтаксический анализ
     std::unique_ptr<ASTNode> ast_root = nullptr;
     try {
         std::cout << "\n========================================\n";
-        std::cout << "2. STARTING SYNTAX ANALYSIS (Parsing AST)\n";
+        std::cout << (frontend != Frontend::SINGLE_PASS ? "2. STARTING SYNTAX ANALYSIS (Parsing AST)\n"
+                                                        : "2. STARTING SYNTAX ANALYSIS (Single-Pass Translation to IR)\n");
         std::cout << "========================================\n";
         Parser parser(&lexer, &error_handler);
-        ast_root = parser.parseProgram();
+        SymbolTable symbols;
+        SemanticAnalyzer semantics(symbols, &error_handler);
+        IRCode generated_code;
+        FlatAST flat_ast;
+        bool parsed = false;
+        if (frontend == Frontend::TREE_AST) {
+            ast_root = parser.parseProgram();
+            parsed = ast_root != nullptr;
+        } else if (frontend == Frontend::FLAT_AST) {
+            parsed = parser.parseProgramFlat(flat_ast);
+        } else {
+            parsed = parser.translateProgram(generated_code, &semantics);
+        }
+
+        // В потоковом режиме лексические ошибки обнаруживаются во время разбора
+        if (streaming) {
+            lexer.setTokenTableStream(nullptr);
+            for (const CompilerError& err : error_handler.getErrors()) {
+                if (err.type == "Lexical") {
+                    return report_lexical_failure();
+                }
+            }
+        }
 
         if (error_handler.hasErrors()) {
+            // При однопроходной трансляции семантические ошибки выявляются во время разбора
+            bool syntax_errors = false;
+            for (const CompilerError& err : error_handler.getErrors()) {
+                syntax_errors = syntax_errors || err.type != "Semantic";
+            }
+            if (!syntax_errors) {
+                return report_semantic_failure();
+            }
             {
                 OutputRedirector error_redirector(OUTPUT_ERROR_LOG);
                 if (error_redirector.is_open()) {
@@ -140,59 +248,117 @@ int process_file(const std::string& input_filename, const std::string& output_fo
             return 3;
         }
 
-        if (ast_root) {
+        if (parsed) {
             std::cout << "[INFO] Parsing completed successfully.\n";
+            if (frontend == Frontend::SINGLE_PASS) {
+                report_warnings();
+            }
+        }
 
+        if (parsed && frontend != Frontend::SINGLE_PASS) {
             // Визуализация AST
             std::cout << "[INFO] Saving Abstract Syntax Tree (AST) to: " << OUTPUT_AST_FILE << "\n";
             std::ofstream ofs_ast(OUTPUT_AST_FILE);
             if (!ofs_ast.is_open()) {
                 std::cerr << "[WARNING] Could not open file for AST visualization: " << OUTPUT_AST_FILE << "\n";
             } else {
-                std::streambuf* cout_buf = std::cout.rdbuf();
-                std::cout.rdbuf(ofs_ast.rdbuf());
-                ASTVisualizer visualizer;
-                ast_root->accept(visualizer);
-                std::cout.rdbuf(cout_buf);
+                ASTVisualizer visualizer(ofs_ast);
+                if (ast_root) {
+                    visualizer.dispatch(*ast_root);
+                } else {
+                    visualizer.print(flat_ast);
+                }
                 ofs_ast.close();
             }
 
+            // Дополнительный машиночитаемый дамп AST (--dump-ast=json|dot|bin)
+            if (ast_root && ast_dump != AstDump::NONE) {
+                const std::string dump_file = OUTPUT_DIR + (ast_dump == AstDump::JSON ? "ast.json" :
+                                                            ast_dump == AstDump::DOT ? "ast.dot" : "ast.bin");
+                std::cout << "[INFO] Saving AST dump to: " << dump_file << "\n";
+                std::ofstream ofs_dump(dump_file, std::ios::binary);
+                if (!ofs_dump.is_open()) {
+                    std::cerr << "[WARNING] Could not open file for AST dump: " << dump_file << "\n";
+                } else {
+                    OutputSink sink(ofs_dump);
+                    if (ast_dump == AstDump::JSON) {
+                        ASTSerializer::writeJson(*ast_root, sink);
+                    } else if (ast_dump == AstDump::DOT) {
+                        ASTSerializer::writeDot(*ast_root, sink);
+                    } else {
+                        ASTSerializer::writeBinary(*ast_root, sink);
+                    }
+                }
+            }
+
+            // Семантический анализ: объявления, присваивание до чтения, слоты переменных
+            std::cout << "[INFO] Starting semantic analysis...\n";
+            if (!(ast_root ? semantics.analyze(*ast_root) : semantics.analyze(flat_ast))) {
+                return report_semantic_failure();
+            }
+            std::cout << "[INFO] Semantic analysis completed successfully (" << symbols.variableCount() << " variables).\n";
+            report_warnings();
+
             // Генерация промежуточного кода
             std::cout << "\n========================================\n";
             std::cout << "3. STARTING INTERMEDIATE CODE GENERATION\n";
             std::cout << "========================================\n";
-            IRGenerator ir_generator(&error_handler);
-            IRCode generated_code = ir_generator.generate(ast_root.get());
+            IRGenerator ir_generator(&error_handler, &symbols);
+            generated_code = ast_root ? ir_generator.generate(ast_root.get()) : ir_generator.generate(flat_ast);
+        }
+
+        if (parsed) {
+            // Упакованный IR: 16-байтные инструкции с таблицами слотов, констант и меток
+            PackedIR packed_code = PackedIR::fromCode(generated_code);
 
             std::cout << "[INFO] Saving Generated 3-Address Code (3AC) to: " << OUTPUT_IR_FILE << "\n";
             std::ofstream ofs_gen(OUTPUT_IR_FILE);
             if (ofs_gen.is_open()) {
-                for (const auto& instr : generated_code) {
-                    ofs_gen << instr.toString() << "\n";
-                }
+                packed_code.print(ofs_gen);
                 ofs_gen.close();
             } else {
                 std::cerr << "[WARNING] Could not open file for IR generation: " << OUTPUT_IR_FILE << "\n";
             }
 
+            // SSA-форма сгенерированного кода: блоки, φ-функции и версии переменных
+            std::cout << "[INFO] Saving SSA Form to: " << OUTPUT_SSA_FILE << "\n";
+            std::ofstream ofs_ssa(OUTPUT_SSA_FILE);
+            if (ofs_ssa.is_open()) {
+                ControlFlowGraph cfg(packed_code);
+                cfg.analyze();
+                SSAForm ssa(cfg, packed_code);
+                ssa.print(ofs_ssa);
+                ofs_ssa.close();
+            } else {
+                std::cerr << "[WARNING] Could not open file for SSA form: " << OUTPUT_SSA_FILE << "\n";
+            }
+
             // Оптимизация промежуточного кода
             std::cout << "\n========================================\n";
             std::cout << "4. STARTING IR OPTIMIZATION\n";
             std::cout << "========================================\n";
             IROptimizer ir_optimizer;
-            IRCode optimized_code = ir_optimizer.optimize(generated_code);
+            ir_optimizer.optimize(packed_code);
 
             std::cout << "[INFO] Saving Optimized 3-Address Code (3AC) to: " << OUTPUT_IR_OPT_FILE << "\n";
             std::ofstream ofs_opt(OUTPUT_IR_OPT_FILE);
             if (ofs_opt.is_open()) {
-                for (const auto& instr : optimized_code) {
-                    ofs_opt << instr.toString() << "\n";
-                }
+                packed_code.print(ofs_opt);
                 ofs_opt.close();
             } else {
                 std::cerr << "[WARNING] Could not open file for IR optimization: " << OUTPUT_IR_OPT_FILE << "\n";
             }
 
+            // Двоичный модуль для запуска без повторной компиляции (--run-ir=<файл>)
+            std::cout << "[INFO] Saving Optimized IR Module to: " << OUTPUT_IR_MODULE_FILE << "\n";
+            std::ofstream ofs_module(OUTPUT_IR_MODULE_FILE, std::ios::binary);
+            if (ofs_module.is_open()) {
+                IRModule::write(packed_code, ofs_module);
+                ofs_module.close();
+            } else {
+                std::cerr << "[WARNING] Could not open file for IR module: " << OUTPUT_IR_MODULE_FILE << "\n";
+            }
+
             // Интерпретация оптимизированного кода
             std::cout << "\n========================================\n";
             std::cout << "5. STARTING IR CODE INTERPRETATION\n";
@@ -202,13 +368,13 @@ int process_file(const std::string& input_filename, const std::string& output_fo
                 if (interpreter_redirector.is_open()) {
                     std::cout << "\n*** INTERPRETER OUTPUT for " << input_filename << " ***\n";
                     IRInterpreter interpreter;
-                    interpreter.execute(optimized_code);
+                    interpreter.execute(packed_code);
                     std::cout << "*** INTERPRETATION FINISHED for " << input_filename << " ***\n";
                 } else {
                     std::cerr << "[WARNING] Could not open interpreter log file: " << OUTPUT_INTERPRETER_LOG << "\n";
                     std::cout << "\n*** INTERPRETER OUTPUT for " << input_filename << " ***\n";
                     IRInterpreter interpreter;
-                    interpreter.execute(optimized_code);
+                    interpreter.execute(packed_code);
                     std::cout << "*** INTERPRETATION FINISHED for " << input_filename << " ***\n";
                 }
             }
@@ -231,10 +397,53 @@ int process_file(const std::string& input_filename, const std::string& output_fo
     return 0;
 }
 
+// Выполнение сохранённого модуля IR: без лексического, синтаксического анализа и оптимизации
+int run_ir_module(const std::string& path) {
+    IRModule module;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        module.load(path);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "[FATAL] " << e.what() << "\n";
+        return 5;
+    }
+    const auto load_time = std::chrono::steady_clock::now() - start;
+    std::cout << "[INFO] Loaded IR module " << path << " (" << module.view().size << " instructions) in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(load_time).count() << " us.\n";
+
+    IRInterpreter interpreter;
+    interpreter.execute(module.view());
+    return 0;
+}
+
 // Точка входа программы
-int main() {
+int main(int argc, char** argv) {
     std::cout << "--- LTLab Compiler Startup ---\n";
 
+    // --no-ast: AST и ast_structure.txt не строятся, IR выдаётся парсером за один проход;
+    // --flat-ast: AST строится в плоском представлении (массивы узлов и индексы);
+    // --dump-ast=json|dot|bin: дерево дополнительно сохраняется в ast.json, ast.dot или ast.bin;
+    // --run-ir=<файл>: выполняется ранее сохранённый модуль optimized_ir.bin, тесты не компилируются
+    Frontend frontend = Frontend::TREE_AST;
+    AstDump ast_dump = AstDump::NONE;
+    const std::string RUN_IR_OPTION = "--run-ir=";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.rfind(RUN_IR_OPTION, 0) == 0) {
+            return run_ir_module(arg.substr(RUN_IR_OPTION.size()));
+        } else if (arg == "--no-ast") {
+            frontend = Frontend::SINGLE_PASS;
+        } else if (arg == "--flat-ast") {
+            frontend = Frontend::FLAT_AST;
+        } else if (arg == "--dump-ast=json") {
+            ast_dump = AstDump::JSON;
+        } else if (arg == "--dump-ast=dot") {
+            ast_dump = AstDump::DOT;
+        } else if (arg == "--dump-ast=bin") {
+            ast_dump = AstDump::BINARY;
+        }
+    }
+
     // Списки входных файлов и соответствующих выходных папок
     const std::vector<std::string> input_files = {
         "test_1.txt", "test_2.txt", "test_3.txt", "test_4.txt",
@@ -255,9 +464,24 @@ int main() {
 
     int overall_return_code = 0;
 
+    // Арена сеанса: между файлами сбрасывается, но не освобождается
+    SessionArena arena;
+
     // Обработка всех тестовых файлов
     for (size_t i = 0; i < input_files.size(); ++i) {
-        int result = process_file(input_files[i], output_folders[i]);
+        MemoryStats::resetPeakRss();
+        size_t allocations_before = MemoryStats::heapAllocations();
+
+        int result;
+        {
+            SessionArena::Scope scope(arena);
+            result = process_file(input_files[i], output_folders[i], frontend, ast_dump);
+        }
+
+        std::cout << "[MEMORY] " << input_files[i]
+                  << ": peak RSS " << MemoryStats::peakRssKb() << " KB"
+                  << ", heap allocations " << (MemoryStats::heapAllocations() - allocations_before)
+                  << ", arena " << (arena.lastSessionBytes() + 1023) / 1024 << " KB\n";
         if (result != 0) {
             std::cerr << "[ERROR] Compilation failed for file: " << input_files[i] << " with code " << result << "\n";
             overall_return_code = result;
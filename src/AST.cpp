@@ -1,4 +1,39 @@
 #include "AST.h"
+#include "SessionArena.h"
+#include <new>
+#include <algorithm>
+
+namespace {
+    // Заголовок перед узлом: признак источника памяти (выравнивание узла сохраняется)
+    constexpr size_t NODE_HEADER = alignof(std::max_align_t);
+    constexpr uintptr_t FROM_HEAP = 0;
+    constexpr uintptr_t FROM_ARENA = 1;
+}
+
+void* ASTNode::operator new(size_t size) {
+    char* base;
+    uintptr_t source;
+    if (SessionArena* arena = SessionArena::current()) {
+        base = static_cast<char*>(arena->allocate(size + NODE_HEADER, alignof(std::max_align_t)));
+        source = FROM_ARENA;
+    } else {
+        base = static_cast<char*>(::operator new(size + NODE_HEADER));
+        source = FROM_HEAP;
+    }
+    *reinterpret_cast<uintptr_t*>(base) = source;
+    return base + NODE_HEADER;
+}
+
+// Память узла из арены возвращается при её сбросе
+void ASTNode::operator delete(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    char* base = static_cast<char*>(ptr) - NODE_HEADER;
+    if (*reinterpret_cast<uintptr_t*>(base) == FROM_HEAP) {
+        ::operator delete(base);
+    }
+}
 
 // Вспомогательные методы преобразования типов в строки
 std::string BinaryOpNode::op_type_to_string() const {
@@ -11,6 +46,291 @@ std::string VarDeclNode::typeToString() const {
     return temp_token.typeToString();
 }
 
+// Длинные цепочки a + b + ... освобождаются без рекурсии: вложенные операции
+// отсоединяются на явный стек и удаляются, уже не имея потомков-операций
+BinaryOpNode::~BinaryOpNode() {
+    std::pmr::vector<std::unique_ptr<ASTNode>> pending;
+    auto detach = [&pending](std::unique_ptr<ASTNode>& child) {
+        if (child && child->node_kind == ASTNodeKind::BINARY_OP) {
+            pending.push_back(std::move(child));
+        }
+    };
+    detach(left);
+    detach(right);
+    while (!pending.empty()) {
+        std::unique_ptr<ASTNode> node = std::move(pending.back());
+        pending.pop_back();
+        BinaryOpNode* binary = static_cast<BinaryOpNode*>(node.get());
+        detach(binary->left);
+        detach(binary->right);
+    }
+}
+
+StatementList::Entry& StatementList::entry(size_t index) {
+    return const_cast<Entry&>(static_cast<const StatementList*>(this)->entry(index));
+}
+
+const StatementList::Entry& StatementList::entry(size_t index) const {
+    const size_t c = index < chunks_.front().entries.size() ? 0 : chunkOf(index);
+    settle(c);
+    const Chunk& chunk = chunks_[c];
+    return chunk.entries[index - chunk.first];
+}
+
+size_t StatementList::chunkOf(size_t index) const {
+    auto it = std::upper_bound(chunks_.begin(), chunks_.end(), index,
+                               [](size_t i, const Chunk& chunk) { return i < chunk.first; });
+    return (size_t)(it - chunks_.begin()) - 1;
+}
+
+void StatementList::push_back(std::unique_ptr<ASTNode> statement, uint32_t token_count) {
+    if (chunks_.empty() || chunks_.back().entries.size() >= CHUNK_STATEMENTS) {
+        chunks_.emplace_back().first = size_;
+    } else {
+        settle(chunks_.size() - 1);
+    }
+    Chunk& chunk = chunks_.back();
+    chunk.entries.push_back(Entry{std::move(statement), token_count});
+    chunk.tokens += token_count;
+    ++size_;
+}
+
+void StatementList::setTokenCount(size_t index, uint32_t token_count) {
+    Chunk& chunk = chunks_[chunkOf(index)];
+    Entry& target = chunk.entries[index - chunk.first];
+    chunk.tokens = chunk.tokens - target.token_count + token_count;
+    target.token_count = token_count;
+}
+
+// Число токенов блока (без фигурных скобок)
+size_t StatementList::tokenCount() const {
+    size_t total = 0;
+    for (const Chunk& chunk : chunks_) {
+        total += chunk.tokens;
+    }
+    return total;
+}
+
+size_t StatementList::find(size_t token, size_t& statement_start) const {
+    size_t chunk_start = 0;
+    for (const Chunk& chunk : chunks_) {
+        if (token < chunk_start + chunk.tokens) {
+            size_t start = chunk_start;
+            for (size_t i = 0; i < chunk.entries.size(); ++i) {
+                if (token < start + chunk.entries[i].token_count) {
+                    statement_start = start;
+                    return chunk.first + i;
+                }
+                start += chunk.entries[i].token_count;
+            }
+        }
+        chunk_start += chunk.tokens;
+    }
+    return size_;
+}
+
+// Задетые куски собираются заново и режутся на куски не больше 2 * CHUNK_STATEMENTS;
+// слишком маленький результат забирает соседний кусок
+void StatementList::replace(size_t first, size_t last, std::vector<std::unique_ptr<ASTNode>>& fresh,
+                            const std::vector<uint32_t>& counts) {
+    if (chunks_.empty()) {
+        for (size_t i = 0; i < fresh.size(); ++i) {
+            push_back(std::move(fresh[i]), counts[i]);
+        }
+        return;
+    }
+
+    size_t lo = first < size_ ? chunkOf(first) : chunks_.size() - 1;
+    size_t hi = last > first ? chunkOf(last - 1) : lo;
+    const size_t kept = chunks_[hi].first + chunks_[hi].entries.size() - chunks_[lo].first - (last - first);
+    if (kept + fresh.size() < CHUNK_STATEMENTS / 4) {
+        if (hi + 1 < chunks_.size()) {
+            ++hi;
+        } else if (lo > 0) {
+            --lo;
+        }
+    }
+
+    std::vector<Entry> merged;
+    for (size_t c = lo; c <= hi; ++c) {
+        settle(c);
+        Chunk& chunk = chunks_[c];
+        for (size_t i = 0; i < chunk.entries.size(); ++i) {
+            const size_t index = chunk.first + i;
+            if (index == first) {
+                for (size_t k = 0; k < fresh.size(); ++k) {
+                    merged.push_back(Entry{std::move(fresh[k]), counts[k]});
+                }
+            }
+            if (index < first || index >= last) {
+                merged.push_back(std::move(chunk.entries[i]));
+            }
+        }
+    }
+    if (first == chunks_[hi].first + chunks_[hi].entries.size()) {
+        for (size_t k = 0; k < fresh.size(); ++k) {
+            merged.push_back(Entry{std::move(fresh[k]), counts[k]});
+        }
+    }
+
+    const size_t n = merged.size();
+    const size_t pieces = n == 0 ? 0 : n <= 2 * CHUNK_STATEMENTS ? 1 : (n + CHUNK_STATEMENTS - 1) / CHUNK_STATEMENTS;
+    const size_t old_chunks = hi - lo + 1;
+    if (pieces < old_chunks) {
+        chunks_.erase(chunks_.begin() + (std::ptrdiff_t)(lo + pieces), chunks_.begin() + (std::ptrdiff_t)(hi + 1));
+    } else if (pieces > old_chunks) {
+        for (size_t k = old_chunks; k < pieces; ++k) {
+            chunks_.emplace(chunks_.begin() + (std::ptrdiff_t)(hi + 1));
+        }
+    }
+    for (size_t p = 0; p < pieces; ++p) {
+        Chunk& chunk = chunks_[lo + p];
+        chunk.entries.clear();
+        chunk.tokens = 0;
+        for (size_t i = n * p / pieces; i < n * (p + 1) / pieces; ++i) {
+            chunk.tokens += merged[i].token_count;
+            chunk.entries.push_back(std::move(merged[i]));
+        }
+    }
+    size_ = size_ - (last - first) + fresh.size();
+    restart(lo);
+}
+
+void StatementList::restart(size_t from_chunk) {
+    size_t first = from_chunk > 0 ? chunks_[from_chunk - 1].first + chunks_[from_chunk - 1].entries.size() : 0;
+    for (size_t c = from_chunk; c < chunks_.size(); ++c) {
+        chunks_[c].first = first;
+        first += chunks_[c].entries.size();
+    }
+}
+
+namespace {
+    // Позиции имён самого оператора, без вложенных блоков; выражения обходятся без рекурсии
+    // (pending — переиспользуемый стек обхода)
+    template <typename Visit>
+    void forEachPosition(ASTNode& statement, std::pmr::vector<ASTNode*>& pending, Visit&& visit) {
+        ASTNode* expression = nullptr;
+        switch (statement.node_kind) {
+            case ASTNodeKind::VAR_DECL:
+                visit(static_cast<VarDeclNode&>(statement).pos);
+                return;
+            case ASTNodeKind::ASSIGN_STMT: {
+                AssignStmtNode& assign = static_cast<AssignStmtNode&>(statement);
+                visit(assign.pos);
+                expression = assign.expression.get();
+                break;
+            }
+            case ASTNodeKind::PRINT_STMT:
+                expression = static_cast<PrintStmtNode&>(statement).expression.get();
+                break;
+            case ASTNodeKind::IF_STMT:
+                expression = static_cast<IfStmtNode&>(statement).condition.get();
+                break;
+            case ASTNodeKind::WHILE_STMT:
+                expression = static_cast<WhileStmtNode&>(statement).condition.get();
+                break;
+            default:
+                return;
+        }
+        if (expression) {
+            pending.push_back(expression);
+        }
+        while (!pending.empty()) {
+            ASTNode* node = pending.back();
+            pending.pop_back();
+            if (node->node_kind == ASTNodeKind::IDENTIFIER) {
+                visit(static_cast<IdentifierNode*>(node)->pos);
+            } else if (node->node_kind == ASTNodeKind::BINARY_OP) {
+                BinaryOpNode* binary = static_cast<BinaryOpNode*>(node);
+                pending.push_back(binary->right.get());
+                pending.push_back(binary->left.get());
+            }
+        }
+    }
+
+    // Вложенные блоки оператора if/while
+    template <typename Visit>
+    void forEachBody(ASTNode& statement, Visit&& visit) {
+        if (statement.node_kind == ASTNodeKind::IF_STMT) {
+            IfStmtNode& if_node = static_cast<IfStmtNode&>(statement);
+            if (if_node.then_body) {
+                visit(*if_node.then_body);
+            }
+            if (if_node.else_body) {
+                visit(*if_node.else_body);
+            }
+        } else if (statement.node_kind == ASTNodeKind::WHILE_STMT) {
+            WhileStmtNode& while_node = static_cast<WhileStmtNode&>(statement);
+            if (while_node.body) {
+                visit(*while_node.body);
+            }
+        }
+    }
+}
+
+// Позиции самого оператора сдвигаются сразу, вложенным блокам сдвиг уходит в заголовки кусков
+void StatementList::shiftStatementLines(ASTNode* statement, int line_delta, std::pmr::vector<ASTNode*>& pending) {
+    if (!statement) {
+        return;
+    }
+    forEachPosition(*statement, pending, [line_delta](SourcePos& pos) { pos.line += line_delta; });
+    forEachBody(*statement, [line_delta](ProgramNode& body) {
+        for (Chunk& chunk : body.statements.chunks_) {
+            chunk.line_shift += line_delta;
+        }
+    });
+}
+
+void StatementList::applyLineShift(size_t chunk) const {
+    Chunk& target = chunks_[chunk];
+    const int line_delta = target.line_shift;
+    target.line_shift = 0;
+    std::pmr::vector<ASTNode*> pending;
+    for (Entry& entry : target.entries) {
+        shiftStatementLines(entry.statement.get(), line_delta, pending);
+    }
+}
+
+void StatementList::shiftLines(size_t from, int line_delta) {
+    if (line_delta == 0 || from >= size_) {
+        return;
+    }
+    const size_t c = chunkOf(from);
+    settle(c);
+    Chunk& chunk = chunks_[c];
+    std::pmr::vector<ASTNode*> pending;
+    for (size_t i = from - chunk.first; i < chunk.entries.size(); ++i) {
+        shiftStatementLines(chunk.entries[i].statement.get(), line_delta, pending);
+    }
+    for (size_t next = c + 1; next < chunks_.size(); ++next) {
+        chunks_[next].line_shift += line_delta;
+    }
+}
+
+// Обходятся только операторы, начинающиеся в строке line: их число ограничено длиной строки
+void StatementList::shiftColumns(size_t from, size_t token, size_t line_end_token, int line, int column_delta) {
+    if (column_delta == 0) {
+        return;
+    }
+    std::pmr::vector<ASTNode*> pending;
+    for (size_t i = from; i < size_ && token < line_end_token; ++i) {
+        Entry& target = entry(i);
+        if (target.statement) {
+            forEachPosition(*target.statement, pending, [line, column_delta](SourcePos& pos) {
+                if (pos.line == line) {
+                    pos.position += column_delta;
+                }
+            });
+            const size_t statement_start = token;
+            forEachBody(*target.statement, [&](ProgramNode& body) {
+                body.statements.shiftColumns(0, statement_start + body.token_offset, line_end_token, line,
+                                             column_delta);
+            });
+        }
+        token += target.token_count;
+    }
+}
+
 // Реализации методов accept для узлов AST
 void TerminalNode::accept(ASTVisitor& visitor) { visitor.visit(*this); }
 void IntLiteralNode::accept(ASTVisitor& visitor) { visitor.visit(*this); }
@@ -0,0 +1,679 @@
+#include "ASTSerializer.h"
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// --- Буферизованный приёмник ---
+
+OutputSink::OutputSink(std::ostream& out)
+    : out_(out), buffer_(new char[BUFFER_SIZE]) {
+}
+
+OutputSink::~OutputSink() {
+    flush();
+}
+
+void OutputSink::flush() {
+    if (used_ > 0) {
+        out_.write(buffer_.get(), (std::streamsize)used_);
+        total_ += used_;
+        used_ = 0;
+    }
+}
+
+void OutputSink::write(std::string_view text) {
+    if (text.size() > BUFFER_SIZE - used_) {
+        flush();
+        if (text.size() >= BUFFER_SIZE) {
+            out_.write(text.data(), (std::streamsize)text.size());
+            total_ += text.size();
+            return;
+        }
+    }
+    text.copy(buffer_.get() + used_, text.size());
+    used_ += text.size();
+}
+
+void OutputSink::writeDecimal(long long value) {
+    char digits[24];
+    size_t length = 0;
+    unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        put('-');
+    }
+    while (length > 0) {
+        put(digits[--length]);
+    }
+}
+
+void OutputSink::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        put((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    put((char)value);
+}
+
+namespace {
+    // Потомок узла при обходе: поле родителя или элемент списка операторов (field == nullptr)
+    struct ChildRef {
+        const ASTNode* node;
+        const char* field;
+    };
+
+    // i-й потомок в порядке обхода; node == nullptr — потомков больше нет
+    ChildRef childAt(const ASTNode& node, size_t i) {
+        switch (node.node_kind) {
+            case ASTNodeKind::PROGRAM: {
+                const auto& statements = static_cast<const ProgramNode&>(node).statements;
+                return {i < statements.size() ? statements[i].get() : nullptr, nullptr};
+            }
+            case ASTNodeKind::ASSIGN_STMT:
+                return {i == 0 ? static_cast<const AssignStmtNode&>(node).expression.get() : nullptr, "expression"};
+            case ASTNodeKind::PRINT_STMT:
+                return {i == 0 ? static_cast<const PrintStmtNode&>(node).expression.get() : nullptr, "expression"};
+            case ASTNodeKind::IF_STMT: {
+                const IfStmtNode& if_node = static_cast<const IfStmtNode&>(node);
+                switch (i) {
+                    case 0: return {if_node.condition.get(), "condition"};
+                    case 1: return {if_node.then_body.get(), "then"};
+                    case 2: return {if_node.else_body.get(), "else"};
+                    default: return {nullptr, nullptr};
+                }
+            }
+            case ASTNodeKind::WHILE_STMT: {
+                const WhileStmtNode& while_node = static_cast<const WhileStmtNode&>(node);
+                switch (i) {
+                    case 0: return {while_node.condition.get(), "condition"};
+                    case 1: return {while_node.body.get(), "body"};
+                    default: return {nullptr, nullptr};
+                }
+            }
+            case ASTNodeKind::BINARY_OP: {
+                const BinaryOpNode& binary = static_cast<const BinaryOpNode&>(node);
+                switch (i) {
+                    case 0: return {binary.left.get(), "left"};
+                    case 1: return {binary.right.get(), "right"};
+                    default: return {nullptr, nullptr};
+                }
+            }
+            default:
+                return {nullptr, nullptr};
+        }
+    }
+
+    // Обход в прямом порядке на явном стеке: enter(узел, поле, индекс) при входе,
+    // leave(узел) после всех потомков
+    template <typename Handler>
+    void walk(const ASTNode& root, Handler& handler) {
+        struct Frame {
+            const ASTNode* node;
+            size_t next_child;
+        };
+        std::vector<Frame> stack;
+        handler.enter(root, nullptr, 0);
+        stack.push_back(Frame{&root, 0});
+
+        while (!stack.empty()) {
+            const size_t index = stack.back().next_child++;
+            ChildRef child = childAt(*stack.back().node, index);
+            if (!child.node) {
+                handler.leave(*stack.back().node);
+                stack.pop_back();
+                continue;
+            }
+            handler.enter(*child.node, child.field, index);
+            stack.push_back(Frame{child.node, 0});
+        }
+    }
+
+    std::string tokenName(TokenType type) {
+        return Token(type, TokenClass::UNKNOWN, "", 0, 0).typeToString();
+    }
+
+    const char* jsonKindName(ASTNodeKind kind) {
+        switch (kind) {
+            case ASTNodeKind::PROGRAM: return "Program";
+            case ASTNodeKind::VAR_DECL: return "VarDecl";
+            case ASTNodeKind::ASSIGN_STMT: return "Assign";
+            case ASTNodeKind::PRINT_STMT: return "Print";
+            case ASTNodeKind::IF_STMT: return "If";
+            case ASTNodeKind::WHILE_STMT: return "While";
+            case ASTNodeKind::BINARY_OP: return "BinaryOp";
+            case ASTNodeKind::INT_LITERAL: return "IntLiteral";
+            case ASTNodeKind::IDENTIFIER: return "Identifier";
+            case ASTNodeKind::TERMINAL: return "Terminal";
+        }
+        return "Unknown";
+    }
+
+    // Имя переменной по номеру (строки хранятся в таблице интернирования)
+    std::string_view symbolName(SymbolId id) {
+        return SymbolInterner::global().name(id);
+    }
+
+    // Строка в кавычках с экранированием для JSON и DOT
+    void writeQuoted(OutputSink& sink, std::string_view text) {
+        static const char HEX[] = "0123456789abcdef";
+        sink.put('"');
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                sink.put('\\');
+                sink.put(c);
+            } else if ((unsigned char)c < 0x20) {
+                sink.write("\\u00");
+                sink.put(HEX[(c >> 4) & 0xF]);
+                sink.put(HEX[c & 0xF]);
+            } else {
+                sink.put(c);
+            }
+        }
+        sink.put('"');
+    }
+
+    class JsonWriter {
+    private:
+        OutputSink& sink_;
+
+    public:
+        explicit JsonWriter(OutputSink& sink) : sink_(sink) {}
+
+        void enter(const ASTNode& node, const char* field, size_t index) {
+            if (field) {
+                sink_.write(",\"");
+                sink_.write(field);
+                sink_.write("\":");
+            } else if (index > 0) {
+                sink_.put(',');
+            }
+            sink_.write("{\"kind\":\"");
+            sink_.write(jsonKindName(node.node_kind));
+            sink_.put('"');
+
+            switch (node.node_kind) {
+                case ASTNodeKind::PROGRAM:
+                    sink_.write(",\"statements\":[");
+                    break;
+                case ASTNodeKind::VAR_DECL: {
+                    const VarDeclNode& decl = static_cast<const VarDeclNode&>(node);
+                    sink_.write(",\"type\":");
+                    writeQuoted(sink_, tokenName(decl.type));
+                    sink_.write(",\"name\":");
+                    writeQuoted(sink_, symbolName(decl.name));
+                    break;
+                }
+                case ASTNodeKind::ASSIGN_STMT:
+                    sink_.write(",\"name\":");
+                    writeQuoted(sink_, symbolName(static_cast<const AssignStmtNode&>(node).identifier_name));
+                    break;
+                case ASTNodeKind::BINARY_OP:
+                    sink_.write(",\"op\":");
+                    writeQuoted(sink_, tokenName(static_cast<const BinaryOpNode&>(node).op));
+                    break;
+                case ASTNodeKind::INT_LITERAL:
+                    sink_.write(",\"value\":");
+                    sink_.writeDecimal(static_cast<const IntLiteralNode&>(node).value);
+                    break;
+                case ASTNodeKind::IDENTIFIER:
+                    sink_.write(",\"name\":");
+                    writeQuoted(sink_, symbolName(static_cast<const IdentifierNode&>(node).name));
+                    break;
+                case ASTNodeKind::TERMINAL: {
+                    const TerminalNode& terminal = static_cast<const TerminalNode&>(node);
+                    sink_.write(",\"token\":");
+                    writeQuoted(sink_, tokenName(terminal.type));
+                    sink_.write(",\"value\":");
+                    writeQuoted(sink_, terminal.value);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        void leave(const ASTNode& node) {
+            sink_.write(node.node_kind == ASTNodeKind::PROGRAM ? "]}" : "}");
+        }
+    };
+
+    class DotWriter {
+    private:
+        OutputSink& sink_;
+        std::vector<size_t> ids_;            // Идентификаторы узлов на пути от корня
+        size_t next_id_ = 0;
+        std::string label_;
+
+    public:
+        explicit DotWriter(OutputSink& sink) : sink_(sink) {}
+
+        void enter(const ASTNode& node, const char* field, size_t) {
+            const size_t id = next_id_++;
+
+            label_.clear();
+            switch (node.node_kind) {
+                case ASTNodeKind::PROGRAM: label_ = "PROGRAM_BLOCK"; break;
+                case ASTNodeKind::VAR_DECL: {
+                    const VarDeclNode& decl = static_cast<const VarDeclNode&>(node);
+                    label_.append("VAR_DECL ").append(tokenName(decl.type)).append(" ").append(symbolName(decl.name));
+                    break;
+                }
+                case ASTNodeKind::ASSIGN_STMT:
+                    label_.append("ASSIGN_STMT ").append(symbolName(static_cast<const AssignStmtNode&>(node).identifier_name));
+                    break;
+                case ASTNodeKind::PRINT_STMT: label_ = "PRINT_STMT"; break;
+                case ASTNodeKind::IF_STMT: label_ = "IF_STMT"; break;
+                case ASTNodeKind::WHILE_STMT: label_ = "WHILE_STMT"; break;
+                case ASTNodeKind::BINARY_OP:
+                    label_.append("BINARY_OP ").append(tokenName(static_cast<const BinaryOpNode&>(node).op));
+                    break;
+                case ASTNodeKind::INT_LITERAL:
+                    label_.append("INT_LITERAL ").append(std::to_string(static_cast<const IntLiteralNode&>(node).value));
+                    break;
+                case ASTNodeKind::IDENTIFIER:
+                    label_.append("IDENTIFIER ").append(symbolName(static_cast<const IdentifierNode&>(node).name));
+                    break;
+                case ASTNodeKind::TERMINAL: {
+                    const TerminalNode& terminal = static_cast<const TerminalNode&>(node);
+                    label_.append("TERMINAL ").append(tokenName(terminal.type)).append(" ").append(terminal.value);
+                    break;
+                }
+            }
+
+            sink_.write("  n");
+            sink_.writeDecimal((long long)id);
+            sink_.write(" [label=");
+            writeQuoted(sink_, label_);
+            sink_.write("];\n");
+
+            if (!ids_.empty()) {
+                sink_.write("  n");
+                sink_.writeDecimal((long long)ids_.back());
+                sink_.write(" -> n");
+                sink_.writeDecimal((long long)id);
+                if (field) {
+                    sink_.write(" [label=\"");
+                    sink_.write(field);
+                    sink_.write("\"]");
+                }
+                sink_.write(";\n");
+            }
+            ids_.push_back(id);
+        }
+
+        void leave(const ASTNode&) {
+            ids_.pop_back();
+        }
+    };
+
+    // --- Двоичный формат ---
+
+    constexpr char BINARY_MAGIC[] = {'M', 'L', 'A', 'S', 'T', 1};
+
+    class BinaryWriter {
+    private:
+        OutputSink& sink_;
+        std::unordered_map<std::string_view, uint64_t> names_;  // Уже записанные строки
+
+        // Строка: номер ранее записанной (+1) или 0, длина и байты новой
+        void writeName(std::string_view name) {
+            auto it = names_.find(name);
+            if (it != names_.end()) {
+                sink_.writeVarint(it->second + 1);
+                return;
+            }
+            const uint64_t id = names_.size();
+            names_.emplace(name, id);
+            sink_.writeVarint(0);
+            sink_.writeVarint(name.size());
+            sink_.write(name);
+        }
+
+    public:
+        explicit BinaryWriter(OutputSink& sink) : sink_(sink) {
+            sink_.write(std::string_view(BINARY_MAGIC, sizeof(BINARY_MAGIC)));
+        }
+
+        void enter(const ASTNode& node, const char*, size_t) {
+            sink_.put((char)node.node_kind);
+            switch (node.node_kind) {
+                case ASTNodeKind::PROGRAM: {
+                    const ProgramNode& program = static_cast<const ProgramNode&>(node);
+                    const bool marked = program.tokenCount() > 0;
+                    sink_.writeVarint(program.statements.size());
+                    sink_.writeVarint(program.token_offset);
+                    sink_.writeVarint(marked ? program.statements.size() : 0);
+                    for (auto it = program.statements.begin(); marked && it != program.statements.end(); ++it) {
+                        sink_.writeVarint(it.tokenCount());
+                    }
+                    break;
+                }
+                case ASTNodeKind::VAR_DECL: {
+                    const VarDeclNode& decl = static_cast<const VarDeclNode&>(node);
+                    sink_.writeVarint((uint64_t)decl.type);
+                    writeName(symbolName(decl.name));
+                    break;
+                }
+                case ASTNodeKind::ASSIGN_STMT:
+                    writeName(symbolName(static_cast<const AssignStmtNode&>(node).identifier_name));
+                    break;
+                case ASTNodeKind::IF_STMT:
+                    sink_.put(static_cast<const IfStmtNode&>(node).else_body ? 1 : 0);
+                    break;
+                case ASTNodeKind::BINARY_OP:
+                    sink_.writeVarint((uint64_t)static_cast<const BinaryOpNode&>(node).op);
+                    break;
+                case ASTNodeKind::INT_LITERAL: {
+                    // Зигзаг-кодирование: малые по модулю отрицательные значения остаются короткими
+                    const int64_t value = static_cast<const IntLiteralNode&>(node).value;
+                    sink_.writeVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+                    break;
+                }
+                case ASTNodeKind::IDENTIFIER:
+                    writeName(symbolName(static_cast<const IdentifierNode&>(node).name));
+                    break;
+                case ASTNodeKind::TERMINAL: {
+                    const TerminalNode& terminal = static_cast<const TerminalNode&>(node);
+                    sink_.writeVarint((uint64_t)terminal.type);
+                    writeName(terminal.value);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        void leave(const ASTNode&) {}
+    };
+
+    class BinaryReader {
+    private:
+        std::string_view data_;
+        size_t pos_ = 0;
+        std::vector<std::string_view> names_;
+
+        [[noreturn]] void fail(const char* message) const {
+            throw std::runtime_error(std::string("AST Load Error: ") + message + " at byte " + std::to_string(pos_) + ".");
+        }
+
+    public:
+        explicit BinaryReader(std::string_view data) : data_(data) {}
+
+        bool atEnd() const { return pos_ == data_.size(); }
+
+        uint8_t readByte() {
+            if (pos_ >= data_.size()) {
+                fail("unexpected end of data");
+            }
+            return (uint8_t)data_[pos_++];
+        }
+
+        uint64_t readVarint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const uint8_t byte = readByte();
+                value |= (uint64_t)(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            fail("malformed varint");
+        }
+
+        uint32_t readUint32() {
+            const uint64_t value = readVarint();
+            if (value > UINT32_MAX) {
+                fail("value out of range");
+            }
+            return (uint32_t)value;
+        }
+
+        std::string_view readName() {
+            const uint64_t ref = readVarint();
+            if (ref != 0) {
+                if (ref > names_.size()) {
+                    fail("unknown string reference");
+                }
+                return names_[ref - 1];
+            }
+            const uint64_t length = readVarint();
+            if (length > data_.size() - pos_) {
+                fail("string exceeds data");
+            }
+            std::string_view name = data_.substr(pos_, length);
+            pos_ += length;
+            names_.push_back(name);
+            return name;
+        }
+
+        // Имя переменной: строка файла интернируется в таблицу процесса
+        SymbolId readSymbol() {
+            return SymbolInterner::global().intern(readName());
+        }
+
+        TokenType readTokenType() {
+            const uint64_t type = readVarint();
+            if (type > (uint64_t)TokenType::TOKEN_ERROR) {
+                fail("invalid token type");
+            }
+            return (TokenType)type;
+        }
+
+        void expectMagic() {
+            for (char expected : BINARY_MAGIC) {
+                if ((char)readByte() != expected) {
+                    fail("bad header (not a MiniLang binary AST)");
+                }
+            }
+        }
+    };
+
+    bool isExpressionKind(ASTNodeKind kind) {
+        return kind == ASTNodeKind::BINARY_OP || kind == ASTNodeKind::INT_LITERAL ||
+               kind == ASTNodeKind::IDENTIFIER || kind == ASTNodeKind::TERMINAL;
+    }
+
+    bool isStatementKind(ASTNodeKind kind) {
+        return kind == ASTNodeKind::VAR_DECL || kind == ASTNodeKind::ASSIGN_STMT ||
+               kind == ASTNodeKind::PRINT_STMT || kind == ASTNodeKind::IF_STMT ||
+               kind == ASTNodeKind::WHILE_STMT;
+    }
+}
+
+void ASTSerializer::writeJson(const ASTNode& root, OutputSink& sink) {
+    JsonWriter writer(sink);
+    walk(root, writer);
+    sink.put('\n');
+}
+
+void ASTSerializer::writeDot(const ASTNode& root, OutputSink& sink) {
+    sink.write("digraph AST {\n  node [shape=box, fontname=\"monospace\"];\n");
+    DotWriter writer(sink);
+    walk(root, writer);
+    sink.write("}\n");
+}
+
+void ASTSerializer::writeBinary(const ASTNode& root, OutputSink& sink) {
+    BinaryWriter writer(sink);
+    walk(root, writer);
+}
+
+// Загрузка на явном стеке: каждый узел читается целиком, присоединяется к незаполненному
+// полю родителя на вершине стека и сам кладётся на стек, если у него есть потомки
+std::unique_ptr<ASTNode> ASTSerializer::readBinary(std::string_view data) {
+    BinaryReader reader(data);
+    reader.expectMagic();
+
+    struct Frame {
+        ASTNode* node;
+        size_t child_count;                  // Ожидаемое число потомков
+        size_t filled = 0;                   // Уже присоединено
+    };
+    std::vector<Frame> stack;
+    std::unique_ptr<ASTNode> root;
+
+    auto fail = [](const char* message) {
+        throw std::runtime_error(std::string("AST Load Error: ") + message + ".");
+    };
+
+    // Присоединение потомка к очередному полю родителя
+    auto attach = [&](Frame& parent, std::unique_ptr<ASTNode> child) {
+        const ASTNodeKind kind = child->node_kind;
+        const size_t slot = parent.filled++;
+        auto asBlock = [&](std::unique_ptr<ASTNode> block) {
+            if (block->node_kind != ASTNodeKind::PROGRAM) {
+                fail("statement block expected");
+            }
+            return std::unique_ptr<ProgramNode>(static_cast<ProgramNode*>(block.release()));
+        };
+        auto asExpression = [&](std::unique_ptr<ASTNode> expr) {
+            if (!isExpressionKind(expr->node_kind)) {
+                fail("expression expected");
+            }
+            return expr;
+        };
+
+        switch (parent.node->node_kind) {
+            case ASTNodeKind::PROGRAM:
+                if (!isStatementKind(kind)) {
+                    fail("statement expected");
+                }
+                if (slot < static_cast<ProgramNode*>(parent.node)->statements.size()) {
+                    static_cast<ProgramNode*>(parent.node)->statements[slot] = move(child);
+                } else {
+                    static_cast<ProgramNode*>(parent.node)->statements.push_back(move(child));
+                }
+                break;
+            case ASTNodeKind::ASSIGN_STMT:
+                static_cast<AssignStmtNode*>(parent.node)->expression = asExpression(move(child));
+                break;
+            case ASTNodeKind::PRINT_STMT:
+                static_cast<PrintStmtNode*>(parent.node)->expression = asExpression(move(child));
+                break;
+            case ASTNodeKind::IF_STMT: {
+                IfStmtNode* if_node = static_cast<IfStmtNode*>(parent.node);
+                if (slot == 0) {
+                    if_node->condition = asExpression(move(child));
+                } else if (slot == 1) {
+                    if_node->then_body = asBlock(move(child));
+                } else {
+                    if_node->else_body = asBlock(move(child));
+                }
+                break;
+            }
+            case ASTNodeKind::WHILE_STMT: {
+                WhileStmtNode* while_node = static_cast<WhileStmtNode*>(parent.node);
+                if (slot == 0) {
+                    while_node->condition = asExpression(move(child));
+                } else {
+                    while_node->body = asBlock(move(child));
+                }
+                break;
+            }
+            case ASTNodeKind::BINARY_OP: {
+                BinaryOpNode* binary = static_cast<BinaryOpNode*>(parent.node);
+                if (slot == 0) {
+                    binary->left = asExpression(move(child));
+                } else {
+                    binary->right = asExpression(move(child));
+                }
+                break;
+            }
+            default:
+                fail("node cannot have children");
+        }
+    };
+
+    do {
+        const uint8_t kind_byte = reader.readByte();
+        if (kind_byte > (uint8_t)ASTNodeKind::TERMINAL) {
+            fail("unknown node kind");
+        }
+
+        std::unique_ptr<ASTNode> node;
+        size_t child_count = 0;
+        switch ((ASTNodeKind)kind_byte) {
+            case ASTNodeKind::PROGRAM: {
+                std::unique_ptr<ProgramNode> program = std::make_unique<ProgramNode>();
+                child_count = reader.readVarint();
+                program->token_offset = reader.readUint32();
+                const uint64_t count_entries = reader.readVarint();
+                if (count_entries != 0 && count_entries != child_count) {
+                    fail("token markup does not match statement count");
+                }
+                // Разметка читается до операторов: они займут подготовленные места
+                for (uint64_t i = 0; i < count_entries; ++i) {
+                    program->statements.push_back(nullptr, reader.readUint32());
+                }
+                node = move(program);
+                break;
+            }
+            case ASTNodeKind::VAR_DECL: {
+                TokenType type = reader.readTokenType();
+                node = std::make_unique<VarDeclNode>(reader.readSymbol(), type);
+                break;
+            }
+            case ASTNodeKind::ASSIGN_STMT:
+                node = std::make_unique<AssignStmtNode>(reader.readSymbol(), nullptr);
+                child_count = 1;
+                break;
+            case ASTNodeKind::PRINT_STMT:
+                node = std::make_unique<PrintStmtNode>(nullptr);
+                child_count = 1;
+                break;
+            case ASTNodeKind::IF_STMT:
+                node = std::make_unique<IfStmtNode>();
+                child_count = reader.readByte() ? 3 : 2;
+                break;
+            case ASTNodeKind::WHILE_STMT:
+                node = std::make_unique<WhileStmtNode>();
+                child_count = 2;
+                break;
+            case ASTNodeKind::BINARY_OP:
+                node = std::make_unique<BinaryOpNode>(reader.readTokenType(), nullptr, nullptr);
+                child_count = 2;
+                break;
+            case ASTNodeKind::INT_LITERAL: {
+                const uint64_t zigzag = reader.readVarint();
+                const int64_t value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+                if (value < INT32_MIN || value > INT32_MAX) {
+                    fail("literal out of range");
+                }
+                node = std::make_unique<IntLiteralNode>((int)value);
+                break;
+            }
+            case ASTNodeKind::IDENTIFIER:
+                node = std::make_unique<IdentifierNode>(reader.readSymbol());
+                break;
+            case ASTNodeKind::TERMINAL: {
+                TokenType type = reader.readTokenType();
+                node = std::make_unique<TerminalNode>(type, std::string(reader.readName()));
+                break;
+            }
+        }
+
+        ASTNode* raw = node.get();
+        if (stack.empty()) {
+            if (root) {
+                fail("trailing data after root");
+            }
+            root = move(node);
+        } else {
+            attach(stack.back(), move(node));
+        }
+        if (child_count > 0) {
+            stack.push_back(Frame{raw, child_count});
+        }
+        while (!stack.empty() && stack.back().filled == stack.back().child_count) {
+            stack.pop_back();
+        }
+    } while (!stack.empty());
+
+    if (!reader.atEnd()) {
+        fail("trailing data after root");
+    }
+    return root;
+}
@@ -1,139 +1,234 @@
 #include "ASTVisualizer.h"
-#include <iostream>
-#include <sstream>
-
-using std::cout;
 
 // Символы для визуализации дерева
-const std::string V_BRANCH = "|   ";
-const std::string H_BRANCH = "|-- ";
-const std::string L_BRANCH = "`-- ";
-const std::string NO_BRANCH = "    ";
+const char* const V_BRANCH = "|   ";
+const char* const H_BRANCH = "|-- ";
+const char* const L_BRANCH = "`-- ";
+const char* const NO_BRANCH = "    ";
 
 // Обработка блока программы
 void ASTVisualizer::visit(ProgramNode& node) {
-    cout << "PROGRAM_BLOCK (" << node.statements.size() << " statements)\n";
-
-    std::string original_indent = indent_;
+    out_ << "PROGRAM_BLOCK (" << node.statements.size() << " statements)\n";
 
+    const size_t base = indent_.size();
     for (size_t i = 0; i < node.statements.size(); ++i) {
         bool is_last = (i == node.statements.size() - 1);
-        std::string branch_symbol = is_last ? L_BRANCH : H_BRANCH;
-        std::string inner_indent_symbol = is_last ? NO_BRANCH : V_BRANCH;
-
-        cout << original_indent << branch_symbol;
-        indent_ = original_indent + inner_indent_symbol;
-        node.statements[i]->accept(*this);
-        indent_ = original_indent;
+        out_ << indent_ << (is_last ? L_BRANCH : H_BRANCH);
+        indent_.append(is_last ? NO_BRANCH : V_BRANCH);
+        dispatch(*node.statements[i]);
+        indent_.resize(base);
     }
 }
 
 // Обработка объявления переменной
 void ASTVisualizer::visit(VarDeclNode& node) {
-    cout << "VAR_DECL (" << node.typeToString() << " " << node.name << ")\n";
+    out_ << "VAR_DECL (" << node.typeToString() << " " << SymbolInterner::global().name(node.name) << ")\n";
 }
 
 // Обработка оператора присваивания
 void ASTVisualizer::visit(AssignStmtNode& node) {
-    cout << "ASSIGN_STMT (ID: " << node.identifier_name << ")\n";
-    std::string original_indent = indent_;
-    cout << original_indent << L_BRANCH << "Expression:\n";
-    indent_ = original_indent + NO_BRANCH;
-    cout << indent_ << L_BRANCH;
-    indent_ = original_indent + NO_BRANCH + NO_BRANCH;
-    node.expression->accept(*this);
-    indent_ = original_indent;
+    out_ << "ASSIGN_STMT (ID: " << SymbolInterner::global().name(node.identifier_name) << ")\n";
+    const size_t base = indent_.size();
+    out_ << indent_ << L_BRANCH << "Expression:\n";
+    indent_.append(NO_BRANCH);
+    out_ << indent_ << L_BRANCH;
+    indent_.append(NO_BRANCH);
+    dispatch(*node.expression);
+    indent_.resize(base);
 }
 
 // Обработка оператора вывода
 void ASTVisualizer::visit(PrintStmtNode& node) {
-    cout << "PRINT_STMT\n";
-    std::string original_indent = indent_;
-    cout << original_indent << L_BRANCH << "Expression:\n";
-    indent_ = original_indent + NO_BRANCH;
-    cout << indent_ << L_BRANCH;
-    indent_ = original_indent + NO_BRANCH + NO_BRANCH;
-    node.expression->accept(*this);
-    indent_ = original_indent;
+    out_ << "PRINT_STMT\n";
+    const size_t base = indent_.size();
+    out_ << indent_ << L_BRANCH << "Expression:\n";
+    indent_.append(NO_BRANCH);
+    out_ << indent_ << L_BRANCH;
+    indent_.append(NO_BRANCH);
+    dispatch(*node.expression);
+    indent_.resize(base);
 }
 
 // Обработка условного оператора
 void ASTVisualizer::visit(IfStmtNode& node) {
-    cout << "IF_STMT\n";
-    std::string original_indent = indent_;
+    out_ << "IF_STMT\n";
+    const size_t base = indent_.size();
     bool has_else = node.else_body != nullptr;
 
-    cout << original_indent << H_BRANCH << "Condition:\n";
-    indent_ = original_indent + V_BRANCH;
-    cout << indent_ << L_BRANCH;
-    std::string inner_indent = indent_;
-    indent_ = inner_indent + NO_BRANCH;
-    node.condition->accept(*this);
-    indent_ = original_indent;
-
-    std::string then_branch = has_else ? H_BRANCH : L_BRANCH;
-    std::string then_inner_indent = has_else ? V_BRANCH : NO_BRANCH;
+    out_ << indent_ << H_BRANCH << "Condition:\n";
+    indent_.append(V_BRANCH);
+    out_ << indent_ << L_BRANCH;
+    indent_.append(NO_BRANCH);
+    dispatch(*node.condition);
+    indent_.resize(base);
 
-    cout << original_indent << then_branch << "THEN_BLOCK:\n";
-    indent_ = original_indent + then_inner_indent;
-    node.then_body->accept(*this);
-    indent_ = original_indent;
+    out_ << indent_ << (has_else ? H_BRANCH : L_BRANCH) << "THEN_BLOCK:\n";
+    indent_.append(has_else ? V_BRANCH : NO_BRANCH);
+    visit(*node.then_body);
+    indent_.resize(base);
 
     if (has_else) {
-        cout << original_indent << L_BRANCH << "ELSE_BLOCK:\n";
-        indent_ = original_indent + NO_BRANCH;
-        node.else_body->accept(*this);
-        indent_ = original_indent;
+        out_ << indent_ << L_BRANCH << "ELSE_BLOCK:\n";
+        indent_.append(NO_BRANCH);
+        visit(*node.else_body);
+        indent_.resize(base);
     }
 }
 
 // Обработка цикла while
 void ASTVisualizer::visit(WhileStmtNode& node) {
-    cout << "WHILE_STMT\n";
-    std::string original_indent = indent_;
-
-    cout << original_indent << H_BRANCH << "Condition:\n";
-    indent_ = original_indent + V_BRANCH;
-    cout << indent_ << L_BRANCH;
-    std::string inner_indent = indent_;
-    indent_ = inner_indent + NO_BRANCH;
-    node.condition->accept(*this);
-    indent_ = original_indent;
-
-    cout << original_indent << L_BRANCH << "BODY_BLOCK:\n";
-    indent_ = original_indent + NO_BRANCH;
-    node.body->accept(*this);
-    indent_ = original_indent;
+    out_ << "WHILE_STMT\n";
+    const size_t base = indent_.size();
+
+    out_ << indent_ << H_BRANCH << "Condition:\n";
+    indent_.append(V_BRANCH);
+    out_ << indent_ << L_BRANCH;
+    indent_.append(NO_BRANCH);
+    dispatch(*node.condition);
+    indent_.resize(base);
+
+    out_ << indent_ << L_BRANCH << "BODY_BLOCK:\n";
+    indent_.append(NO_BRANCH);
+    visit(*node.body);
+    indent_.resize(base);
 }
 
 // Обработка бинарной операции
 void ASTVisualizer::visit(BinaryOpNode& node) {
-    cout << "BINARY_OP (" << node.op_type_to_string() << ")\n";
-    std::string original_indent = indent_;
-
-    cout << original_indent << H_BRANCH << "Left:\n";
-    indent_ = original_indent + V_BRANCH;
-    cout << indent_ << L_BRANCH;
-    node.left->accept(*this);
-    indent_ = original_indent;
-
-    cout << original_indent << L_BRANCH << "Right:\n";
-    indent_ = original_indent + NO_BRANCH;
-    cout << indent_ << L_BRANCH;
-    node.right->accept(*this);
-    indent_ = original_indent;
+    out_ << "BINARY_OP (" << node.op_type_to_string() << ")\n";
+    const size_t base = indent_.size();
+
+    out_ << indent_ << H_BRANCH << "Left:\n";
+    indent_.append(V_BRANCH);
+    out_ << indent_ << L_BRANCH;
+    dispatch(*node.left);
+    indent_.resize(base);
+
+    out_ << indent_ << L_BRANCH << "Right:\n";
+    indent_.append(NO_BRANCH);
+    out_ << indent_ << L_BRANCH;
+    dispatch(*node.right);
+    indent_.resize(base);
 }
 
 // Обработка листьев дерева
 void ASTVisualizer::visit(IntLiteralNode& node) {
-    cout << "INT_LITERAL (" << node.value << ")\n";
+    out_ << "INT_LITERAL (" << node.value << ")\n";
 }
 
 void ASTVisualizer::visit(IdentifierNode& node) {
-    cout << "IDENTIFIER (" << node.name << ")\n";
+    out_ << "IDENTIFIER (" << SymbolInterner::global().name(node.name) << ")\n";
 }
 
 void ASTVisualizer::visit(TerminalNode& node) {
     Token temp_token(node.type, TokenClass::UNKNOWN, node.value, 0, 0);
-    cout << "TERMINAL (" << temp_token.typeToString() << ": '" << node.value << "')\n";
-}
\ No newline at end of file
+    out_ << "TERMINAL (" << temp_token.typeToString() << ": '" << node.value << "')\n";
+}
+
+// --- Печать плоского AST ---
+
+void ASTVisualizer::print(const FlatAST& ast) {
+    if (ast.root() != FlatAST::NO_NODE) {
+        printFlat(ast, ast.root());
+    }
+}
+
+// Вывод каждого вида узла повторяет соответствующий метод visit
+void ASTVisualizer::printFlat(const FlatAST& ast, FlatAST::NodeIndex node) {
+    const size_t base = indent_.size();
+
+    switch (ast.kind(node)) {
+        case FlatNodeKind::PROGRAM: {
+            std::span<const FlatAST::NodeIndex> statements = ast.statements(node);
+            out_ << "PROGRAM_BLOCK (" << statements.size() << " statements)\n";
+            for (size_t i = 0; i < statements.size(); ++i) {
+                bool is_last = (i == statements.size() - 1);
+                out_ << indent_ << (is_last ? L_BRANCH : H_BRANCH);
+                indent_.append(is_last ? NO_BRANCH : V_BRANCH);
+                printFlat(ast, statements[i]);
+                indent_.resize(base);
+            }
+            break;
+        }
+
+        case FlatNodeKind::VAR_DECL: {
+            Token type_token((TokenType)ast.second(node), TokenClass::UNKNOWN, "", 0, 0);
+            out_ << "VAR_DECL (" << type_token.typeToString() << " " << SymbolInterner::global().name(ast.symbol(node)) << ")\n";
+            break;
+        }
+
+        case FlatNodeKind::ASSIGN_STMT:
+        case FlatNodeKind::PRINT_STMT: {
+            const bool is_assign = ast.kind(node) == FlatNodeKind::ASSIGN_STMT;
+            if (is_assign) {
+                out_ << "ASSIGN_STMT (ID: " << SymbolInterner::global().name(ast.symbol(node)) << ")\n";
+            } else {
+                out_ << "PRINT_STMT\n";
+            }
+            out_ << indent_ << L_BRANCH << "Expression:\n";
+            indent_.append(NO_BRANCH);
+            out_ << indent_ << L_BRANCH;
+            indent_.append(NO_BRANCH);
+            printFlat(ast, is_assign ? ast.second(node) : ast.first(node));
+            break;
+        }
+
+        case FlatNodeKind::IF_STMT:
+        case FlatNodeKind::WHILE_STMT: {
+            const bool is_if = ast.kind(node) == FlatNodeKind::IF_STMT;
+            const bool has_else = is_if && ast.third(node) != FlatAST::NO_NODE;
+            out_ << (is_if ? "IF_STMT\n" : "WHILE_STMT\n");
+
+            out_ << indent_ << H_BRANCH << "Condition:\n";
+            indent_.append(V_BRANCH);
+            out_ << indent_ << L_BRANCH;
+            indent_.append(NO_BRANCH);
+            printFlat(ast, ast.first(node));
+            indent_.resize(base);
+
+            if (is_if) {
+                out_ << indent_ << (has_else ? H_BRANCH : L_BRANCH) << "THEN_BLOCK:\n";
+                indent_.append(has_else ? V_BRANCH : NO_BRANCH);
+            } else {
+                out_ << indent_ << L_BRANCH << "BODY_BLOCK:\n";
+                indent_.append(NO_BRANCH);
+            }
+            printFlat(ast, ast.second(node));
+            indent_.resize(base);
+
+            if (has_else) {
+                out_ << indent_ << L_BRANCH << "ELSE_BLOCK:\n";
+                indent_.append(NO_BRANCH);
+                printFlat(ast, ast.third(node));
+            }
+            break;
+        }
+
+        case FlatNodeKind::BINARY_OP: {
+            Token op_token(ast.op(node), TokenClass::UNKNOWN, "", 0, 0);
+            out_ << "BINARY_OP (" << op_token.typeToString() << ")\n";
+
+            out_ << indent_ << H_BRANCH << "Left:\n";
+            indent_.append(V_BRANCH);
+            out_ << indent_ << L_BRANCH;
+            printFlat(ast, ast.first(node));
+            indent_.resize(base);
+
+            out_ << indent_ << L_BRANCH << "Right:\n";
+            indent_.append(NO_BRANCH);
+            out_ << indent_ << L_BRANCH;
+            printFlat(ast, ast.second(node));
+            break;
+        }
+
+        case FlatNodeKind::INT_LITERAL:
+            out_ << "INT_LITERAL (" << ast.literal(node) << ")\n";
+            break;
+
+        case FlatNodeKind::IDENTIFIER:
+            out_ << "IDENTIFIER (" << SymbolInterner::global().name(ast.symbol(node)) << ")\n";
+            break;
+    }
+
+    indent_.resize(base);
+}
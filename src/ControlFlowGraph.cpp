@@ -0,0 +1,491 @@
+#include "ControlFlowGraph.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+BasicBlock::BasicBlock() : next(ControlFlowGraph::NO_BLOCK), target(ControlFlowGraph::NO_BLOCK) {
+    branch.op = IROpCode::JMP;
+}
+
+// --- Построение ---
+
+// Метка начинает новый блок, переход завершает текущий. Пустой блок без метки,
+// открытый после перехода, принимает следующую метку (вход всегда остаётся отдельным
+// блоком, чтобы у него не было предшественников)
+ControlFlowGraph::ControlFlowGraph(const PackedIR& code) {
+    using P = PackedInstruction;
+
+    // Переходы по номерам меток разрешаются после сбора всех блоков
+    struct Fixup {
+        uint32_t block;
+        bool is_target;
+        uint32_t label;
+    };
+    std::pmr::vector<Fixup> fixups;
+    std::pmr::vector<uint32_t> label_blocks;   // Блок по номеру метки
+
+    blocks_.emplace_back();
+    uint32_t current = 0;
+    bool fresh = true;                          // Текущий блок пуст и без метки
+
+    auto open = [&]() {
+        blocks_.emplace_back();
+        current = (uint32_t)blocks_.size() - 1;
+        fresh = true;
+    };
+
+    for (const PackedInstruction& instr : code.code()) {
+        switch (instr.op) {
+            case IROpCode::LABEL: {
+                if (!fresh || current == entry()) {
+                    blocks_[current].next = (uint32_t)blocks_.size();
+                    open();
+                }
+                const uint32_t label = instr.operand(P::ARG1);
+                blocks_[current].label = label;
+                if (label_blocks.size() <= label) {
+                    label_blocks.resize((size_t)label + 1, NO_BLOCK);
+                }
+                label_blocks[label] = current;
+                fresh = false;
+                break;
+            }
+            case IROpCode::JMP:
+                fixups.push_back(Fixup{current, false, instr.operand(P::ARG1)});
+                open();
+                break;
+            case IROpCode::JMP_IF_ZERO:
+                blocks_[current].branch = instr;
+                blocks_[current].next = (uint32_t)blocks_.size();
+                fixups.push_back(Fixup{current, true, instr.operand(P::ARG2)});
+                open();
+                break;
+            default:
+                blocks_[current].code.push_back(instr);
+                fresh = false;
+                break;
+        }
+    }
+
+    // Последний блок переходит в пустой блок выхода
+    blocks_[current].next = (uint32_t)blocks_.size();
+    blocks_.emplace_back();
+    exit_ = (uint32_t)blocks_.size() - 1;
+    layout_.resize(blocks_.size());
+    std::iota(layout_.begin(), layout_.end(), 0u);
+
+    for (const Fixup& fixup : fixups) {
+        if (fixup.label >= label_blocks.size() || label_blocks[fixup.label] == NO_BLOCK) {
+            throw std::runtime_error("CFG Error: Jump to undefined label L" + std::to_string(fixup.label) + ".");
+        }
+        BasicBlock& block = blocks_[fixup.block];
+        (fixup.is_target ? block.target : block.next) = label_blocks[fixup.label];
+    }
+}
+
+size_t ControlFlowGraph::instructionCount() const {
+    size_t count = 0;
+    for (const BasicBlock& block : blocks_) {
+        count += block.code.size();
+    }
+    return count;
+}
+
+// --- Анализ ---
+
+void ControlFlowGraph::analyze() {
+    computePredecessors();
+    computeReversePostorder();
+    computeDominators();
+    computeLoops();
+}
+
+void ControlFlowGraph::computePredecessors() {
+    const size_t count = blocks_.size();
+    pred_offsets_.assign(count + 1, 0);
+    for (const BasicBlock& block : blocks_) {
+        if (block.next != NO_BLOCK) {
+            ++pred_offsets_[block.next + 1];
+        }
+        if (block.isConditional()) {
+            ++pred_offsets_[block.target + 1];
+        }
+    }
+    for (size_t b = 0; b < count; ++b) {
+        pred_offsets_[b + 1] += pred_offsets_[b];
+    }
+    preds_.resize(pred_offsets_[count]);
+    std::pmr::vector<uint32_t> fill(pred_offsets_.begin(), pred_offsets_.end() - 1);
+    for (uint32_t b = 0; b < count; ++b) {
+        const BasicBlock& block = blocks_[b];
+        if (block.next != NO_BLOCK) {
+            preds_[fill[block.next]++] = b;
+        }
+        if (block.isConditional()) {
+            preds_[fill[block.target]++] = b;
+        }
+    }
+}
+
+// Обход в глубину на явном стеке (вложенность циклов не ограничена глубиной стека вызовов).
+// Цель условного перехода обходится раньше следующего блока: тогда в обратном
+// постпорядке тело цикла идёт сразу за заголовком, до кода после цикла, и итерационные
+// алгоритмы досчитывают цикл, прежде чем идти дальше
+void ControlFlowGraph::computeReversePostorder() {
+    const size_t count = blocks_.size();
+    rpo_.clear();
+    rpo_index_.assign(count, NO_BLOCK);
+
+    struct Frame {
+        uint32_t block;
+        uint32_t next_successor;
+    };
+    std::pmr::vector<Frame> stack;
+    std::pmr::vector<uint8_t> visited(count, 0);
+    stack.push_back(Frame{entry(), 0});
+    visited[entry()] = 1;
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const BasicBlock& block = blocks_[frame.block];
+        uint32_t successor = NO_BLOCK;
+        while (successor == NO_BLOCK && frame.next_successor < 2) {
+            const uint32_t index = frame.next_successor++;
+            const uint32_t candidate = index == 0 ? (block.isConditional() ? block.target : NO_BLOCK) : block.next;
+            if (candidate != NO_BLOCK && !visited[candidate]) {
+                successor = candidate;
+            }
+        }
+        if (successor != NO_BLOCK) {
+            visited[successor] = 1;
+            stack.push_back(Frame{successor, 0});
+        } else {
+            rpo_.push_back(frame.block);
+            stack.pop_back();
+        }
+    }
+    std::reverse(rpo_.begin(), rpo_.end());
+    for (uint32_t i = 0; i < rpo_.size(); ++i) {
+        rpo_index_[rpo_[i]] = i;
+    }
+}
+
+// Cooper–Harvey–Kennedy: итерации в обратном постпорядке до неподвижной точки;
+// на структурном коде сходится за два прохода
+void ControlFlowGraph::computeDominators() {
+    const size_t count = blocks_.size();
+    idom_.assign(count, NO_BLOCK);
+    idom_[entry()] = entry();
+
+    auto intersect = [this](uint32_t a, uint32_t b) {
+        while (a != b) {
+            while (rpo_index_[a] > rpo_index_[b]) {
+                a = idom_[a];
+            }
+            while (rpo_index_[b] > rpo_index_[a]) {
+                b = idom_[b];
+            }
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < rpo_.size(); ++i) {
+            const uint32_t b = rpo_[i];
+            uint32_t new_idom = NO_BLOCK;
+            for (uint32_t p : predecessors(b)) {
+                if (idom_[p] == NO_BLOCK) {
+                    continue;
+                }
+                new_idom = new_idom == NO_BLOCK ? p : intersect(p, new_idom);
+            }
+            if (idom_[b] != new_idom) {
+                idom_[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    // Дерево доминаторов и его нумерация для проверки dominates() за O(1)
+    dom_child_offsets_.assign(count + 1, 0);
+    for (uint32_t b : rpo_) {
+        if (b != entry()) {
+            ++dom_child_offsets_[idom_[b] + 1];
+        }
+    }
+    for (size_t b = 0; b < count; ++b) {
+        dom_child_offsets_[b + 1] += dom_child_offsets_[b];
+    }
+    dom_children_.resize(dom_child_offsets_[count]);
+    std::pmr::vector<uint32_t> fill(dom_child_offsets_.begin(), dom_child_offsets_.end() - 1);
+    for (uint32_t b : rpo_) {
+        if (b != entry()) {
+            dom_children_[fill[idom_[b]]++] = b;
+        }
+    }
+
+    dom_pre_.assign(count, 0);
+    dom_post_.assign(count, 0);
+    uint32_t pre_counter = 0;
+    uint32_t post_counter = 0;
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> stack;   // Блок и следующий потомок
+    stack.emplace_back(entry(), dom_child_offsets_[entry()]);
+    dom_pre_[entry()] = pre_counter++;
+    while (!stack.empty()) {
+        auto& [b, child] = stack.back();
+        if (child < dom_child_offsets_[b + 1]) {
+            const uint32_t c = dom_children_[child++];
+            dom_pre_[c] = pre_counter++;
+            stack.emplace_back(c, dom_child_offsets_[c]);
+        } else {
+            dom_post_[b] = post_counter++;
+            stack.pop_back();
+        }
+    }
+}
+
+// Естественные циклы: заголовок h доминирует над источником обратного ребра p -> h.
+// Заголовки обрабатываются в порядке убывания номера в обратном постпорядке, то есть
+// внутренние циклы раньше объемлющих. Тело собирается обходом предшественников, а уже
+// найденные внутренние циклы сжимаются в свой заголовок (система непересекающихся
+// множеств), поэтому каждый блок просматривается почти константное число раз
+void ControlFlowGraph::computeLoops() {
+    const size_t count = blocks_.size();
+    loops_.clear();
+    block_loop_.assign(count, NO_LOOP);
+
+    std::pmr::vector<uint32_t> header_loop(count, NO_LOOP);
+    std::pmr::vector<uint32_t> representative(count);
+    for (uint32_t b = 0; b < count; ++b) {
+        representative[b] = b;
+    }
+    auto find = [&representative](uint32_t b) {
+        uint32_t root = b;
+        while (representative[root] != root) {
+            root = representative[root];
+        }
+        while (representative[b] != root) {
+            const uint32_t parent = representative[b];
+            representative[b] = root;
+            b = parent;
+        }
+        return root;
+    };
+
+    std::pmr::vector<uint32_t> mark(count, NO_LOOP);
+    std::pmr::vector<uint32_t> worklist;
+    for (size_t i = rpo_.size(); i-- > 0;) {
+        const uint32_t header = rpo_[i];
+        const uint32_t loop = (uint32_t)loops_.size();
+        for (uint32_t p : predecessors(header)) {
+            if (!dominates(header, p)) {
+                continue;
+            }
+            const uint32_t source = find(p);
+            if (source != header && mark[source] != loop) {
+                mark[source] = loop;
+                worklist.push_back(source);
+            }
+            if (loops_.size() == loop) {
+                loops_.push_back(Loop{header, NO_LOOP, 0, NO_BLOCK});
+            }
+        }
+        if (loops_.size() == loop) {
+            continue;
+        }
+
+        while (!worklist.empty()) {
+            const uint32_t b = worklist.back();
+            worklist.pop_back();
+            if (header_loop[b] != NO_LOOP) {
+                loops_[header_loop[b]].parent = loop;
+            } else {
+                block_loop_[b] = loop;
+            }
+            representative[b] = header;
+            for (uint32_t p : predecessors(b)) {
+                if (!reachable(p)) {
+                    continue;
+                }
+                const uint32_t source = find(p);
+                if (source != header && mark[source] != loop) {
+                    mark[source] = loop;
+                    worklist.push_back(source);
+                }
+            }
+        }
+        header_loop[header] = loop;
+        block_loop_[header] = loop;
+
+        uint32_t outside = NO_BLOCK;
+        size_t outside_edges = 0;
+        for (uint32_t p : predecessors(header)) {
+            if (reachable(p) && !dominates(header, p)) {
+                outside = p;
+                ++outside_edges;
+            }
+        }
+        if (outside_edges == 1 && !blocks_[outside].isConditional()) {
+            loops_[loop].preheader = outside;
+        }
+    }
+
+    // Объемлющий цикл создаётся позже вложенного
+    for (size_t i = loops_.size(); i-- > 0;) {
+        Loop& loop = loops_[i];
+        loop.depth = loop.parent == NO_LOOP ? 1 : loops_[loop.parent].depth + 1;
+    }
+}
+
+size_t ControlFlowGraph::ensurePreheaders() {
+    struct Created {
+        uint32_t header;
+        uint32_t outside;
+        uint32_t preheader;
+        size_t old_offset;                     // Прежние предшественники заголовка в old_preds
+    };
+    std::pmr::vector<Created> created;
+    std::pmr::vector<uint32_t> old_preds;
+    for (const Loop& loop : loops_) {
+        if (loop.preheader != NO_BLOCK) {
+            continue;
+        }
+        uint32_t outside = NO_BLOCK;
+        size_t outside_edges = 0;
+        for (uint32_t p : predecessors(loop.header)) {
+            if (reachable(p) && !dominates(loop.header, p)) {
+                outside = p;
+                ++outside_edges;
+            }
+        }
+        if (outside_edges != 1) {
+            continue;
+        }
+        const uint32_t preheader = (uint32_t)blocks_.size();
+        blocks_.emplace_back();
+        blocks_[preheader].next = loop.header;
+        BasicBlock& source = blocks_[outside];
+        (source.next == loop.header ? source.next : source.target) = preheader;
+        created.push_back(Created{loop.header, outside, preheader, old_preds.size()});
+        const auto preds = predecessors(loop.header);
+        old_preds.insert(old_preds.end(), preds.begin(), preds.end());
+    }
+    if (created.empty()) {
+        return 0;
+    }
+
+    std::pmr::vector<uint32_t> preheader_of(blocks_.size(), NO_BLOCK);
+    for (const Created& c : created) {
+        preheader_of[c.header] = c.preheader;
+    }
+    std::pmr::vector<uint32_t> layout;
+    layout.reserve(blocks_.size());
+    for (uint32_t b : layout_) {
+        if (preheader_of[b] != NO_BLOCK) {
+            layout.push_back(preheader_of[b]);
+        }
+        layout.push_back(b);
+    }
+    layout_ = std::move(layout);
+    analyze();
+
+    // Новый порядок предшественников: предзаголовок занимает место внешнего блока, среди
+    // одинаковых предшественников k-е вхождение соответствует k-му прежнему
+    std::pmr::vector<PhiOperand> args;
+    for (const Created& c : created) {
+        const auto preds = predecessors(c.header);
+        const size_t old_count = preds.size();
+        const uint32_t* old_begin = old_preds.data() + c.old_offset;
+        for (PhiNode& phi : blocks_[c.header].phis) {
+            args.clear();
+            for (size_t i = 0; i < preds.size(); ++i) {
+                const uint32_t q = preds[i] == c.preheader ? c.outside : preds[i];
+                size_t occurrence = 0;
+                for (size_t k = 0; k < i; ++k) {
+                    occurrence += (preds[k] == c.preheader ? c.outside : preds[k]) == q;
+                }
+                for (size_t j = 0; j < old_count; ++j) {
+                    if (old_begin[j] == q && occurrence-- == 0) {
+                        args.push_back(phi.args[j]);
+                        break;
+                    }
+                }
+            }
+            phi.args.assign(args.begin(), args.end());
+        }
+    }
+    return created.size();
+}
+
+// --- Линеаризация ---
+
+void ControlFlowGraph::linearize(PackedIR& code) const {
+    using P = PackedInstruction;
+    const uint32_t count = (uint32_t)blocks_.size();
+    for (uint32_t b = 0; b < count; ++b) {
+        if (!blocks_[b].phis.empty()) {
+            throw std::runtime_error("CFG Error: Block B" + std::to_string(b) + " still has PHI nodes.");
+        }
+    }
+
+    // Порядок вывода: достижимые блоки в порядке раскладки, выход — последним
+    std::pmr::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t b : layout_) {
+        if (b != exit_ && reachable(b)) {
+            order.push_back(b);
+        }
+    }
+    order.push_back(exit_);
+    std::pmr::vector<uint32_t> layout_next(count, NO_BLOCK);
+    for (size_t i = 0; i + 1 < order.size(); ++i) {
+        layout_next[order[i]] = order[i + 1];
+    }
+
+    // Метки получают только цели переходов: исходный номер сохраняется, блоку без метки
+    // выдаётся новый. Метки, на которые после оптимизаций никто не переходит, пропадают
+    std::pmr::vector<uint32_t> labels(count, BasicBlock::NO_LABEL);
+    auto require = [&](uint32_t b) {
+        if (labels[b] == BasicBlock::NO_LABEL) {
+            labels[b] = blocks_[b].label != BasicBlock::NO_LABEL ? blocks_[b].label : code.newLabel();
+        }
+    };
+    for (uint32_t b : order) {
+        const BasicBlock& block = blocks_[b];
+        if (block.isConditional()) {
+            require(block.target);
+        }
+        if (block.next != NO_BLOCK && block.next != layout_next[b]) {
+            require(block.next);
+        }
+    }
+
+    std::pmr::vector<PackedInstruction> output;
+    output.reserve(instructionCount() + 2 * count);
+    auto jump = [&](IROpCode op, uint32_t target) {
+        PackedInstruction instr;
+        instr.op = op;
+        instr.set(P::ARG1, PackedKind::LABEL, labels[target]);
+        output.push_back(instr);
+    };
+    for (uint32_t b : order) {
+        const BasicBlock& block = blocks_[b];
+        if (labels[b] != BasicBlock::NO_LABEL) {
+            jump(IROpCode::LABEL, b);
+        }
+        output.insert(output.end(), block.code.begin(), block.code.end());
+        if (block.isConditional()) {
+            PackedInstruction branch = block.branch;
+            branch.set(P::ARG2, PackedKind::LABEL, labels[block.target]);
+            output.push_back(branch);
+        }
+        if (block.next != NO_BLOCK && block.next != layout_next[b]) {
+            jump(IROpCode::JMP, block.next);
+        }
+    }
+
+    code.code().assign(output.begin(), output.end());
+    code.rebuildLabels();
+}
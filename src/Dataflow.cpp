@@ -0,0 +1,308 @@
+#include "Dataflow.h"
+
+namespace {
+    using P = PackedInstruction;
+
+    constexpr uint32_t NO_MARK = UINT32_MAX;
+
+    // Чтения слотов инструкцией: ARG1 и ARG2 вида SLOT
+    template <typename F>
+    void forEachUse(const PackedInstruction& instr, F&& f) {
+        if (instr.kind(P::ARG1) == PackedKind::SLOT) {
+            f(instr.operand(P::ARG1));
+        }
+        if (instr.kind(P::ARG2) == PackedKind::SLOT) {
+            f(instr.operand(P::ARG2));
+        }
+    }
+
+    bool isBinary(IROpCode op) {
+        switch (op) {
+            case IROpCode::ADD:
+            case IROpCode::SUB:
+            case IROpCode::MUL:
+            case IROpCode::DIV:
+            case IROpCode::CMP_EQ:
+            case IROpCode::CMP_NE:
+            case IROpCode::CMP_LT:
+            case IROpCode::CMP_GT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Номера глобальных имён по возрастанию слота (NO_MARK — слот локален в блоках)
+    std::pmr::vector<uint32_t> numberGlobalNames(const ControlFlowGraph& cfg, size_t slot_count) {
+        std::pmr::vector<uint32_t> bits(slot_count, NO_MARK);
+        std::pmr::vector<uint32_t> defined(slot_count, NO_MARK);
+        for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+            const BasicBlock& block = cfg.block(b);
+            auto use = [&](uint32_t slot) {
+                if (defined[slot] != b) {
+                    bits[slot] = 0;
+                }
+            };
+            for (const PackedInstruction& instr : block.code) {
+                forEachUse(instr, use);
+                if (instr.kind(P::RESULT) == PackedKind::SLOT) {
+                    defined[instr.operand(P::RESULT)] = b;
+                }
+            }
+            if (block.isConditional()) {
+                forEachUse(block.branch, use);
+            }
+        }
+        uint32_t next = 0;
+        for (uint32_t& bit : bits) {
+            if (bit != NO_MARK) {
+                bit = next++;
+            }
+        }
+        return bits;
+    }
+}
+
+// --- Живые переменные ---
+
+LivenessAnalysis::LivenessAnalysis(const ControlFlowGraph& cfg, size_t slot_count)
+    : slot_bits_(numberGlobalNames(cfg, slot_count)) {
+    for (uint32_t slot = 0; slot < slot_count; ++slot) {
+        if (slot_bits_[slot] != NO_BIT) {
+            bit_slots_.push_back(slot);
+        }
+    }
+
+    std::pmr::vector<uint32_t> defined(slot_count, NO_MARK);
+    std::pmr::vector<uint32_t> used(slot_count, NO_MARK);
+    gen_offsets_.reserve(cfg.blockCount() + 1);
+    kill_offsets_.reserve(cfg.blockCount() + 1);
+    gen_offsets_.push_back(0);
+    kill_offsets_.push_back(0);
+    for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+        const BasicBlock& block = cfg.block(b);
+        auto use = [&](uint32_t slot) {
+            if (slot_bits_[slot] != NO_BIT && defined[slot] != b && used[slot] != b) {
+                used[slot] = b;
+                gen_.push_back(slot_bits_[slot]);
+            }
+        };
+        for (const PackedInstruction& instr : block.code) {
+            forEachUse(instr, use);
+            if (instr.kind(P::RESULT) == PackedKind::SLOT) {
+                const uint32_t slot = instr.operand(P::RESULT);
+                if (slot_bits_[slot] != NO_BIT && defined[slot] != b) {
+                    defined[slot] = b;
+                    kill_.push_back(slot_bits_[slot]);
+                }
+            }
+        }
+        if (block.isConditional()) {
+            forEachUse(block.branch, use);
+        }
+        gen_offsets_.push_back((uint32_t)gen_.size());
+        kill_offsets_.push_back((uint32_t)kill_.size());
+    }
+
+    solution_ = solveDataflow(cfg, *this);
+}
+
+// Вход = чтения до записи ∪ (выход − записи)
+void LivenessAnalysis::transfer(uint32_t b, ConstBitRow live_out, BitRow live_in) const {
+    live_in.assign(live_out);
+    for (uint32_t i = kill_offsets_[b]; i < kill_offsets_[b + 1]; ++i) {
+        live_in.reset(kill_[i]);
+    }
+    for (uint32_t i = gen_offsets_[b]; i < gen_offsets_[b + 1]; ++i) {
+        live_in.set(gen_[i]);
+    }
+}
+
+// --- Достигающие определения ---
+
+ReachingDefinitions::ReachingDefinitions(const ControlFlowGraph& cfg, size_t slot_count) {
+    const std::pmr::vector<uint32_t> global = numberGlobalNames(cfg, slot_count);
+    auto tracked = [&global](const PackedInstruction& instr) {
+        return instr.kind(P::RESULT) == PackedKind::SLOT && global[instr.operand(P::RESULT)] != NO_MARK;
+    };
+
+    // Определения группируются по слоту, внутри слота — по порядку блоков
+    slot_offsets_.assign(slot_count + 1, 0);
+    for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+        for (const PackedInstruction& instr : cfg.block(b).code) {
+            if (tracked(instr)) {
+                ++slot_offsets_[instr.operand(P::RESULT) + 1];
+            }
+        }
+    }
+    for (size_t slot = 0; slot < slot_count; ++slot) {
+        slot_offsets_[slot + 1] += slot_offsets_[slot];
+    }
+    definitions_.resize(slot_offsets_[slot_count]);
+    std::pmr::vector<uint32_t> cursor(slot_offsets_.begin(), slot_offsets_.end() - 1);
+
+    std::pmr::vector<uint32_t> defined(slot_count, NO_MARK);
+    std::pmr::vector<uint32_t> last(slot_count, 0);
+    gen_offsets_.reserve(cfg.blockCount() + 1);
+    kill_offsets_.reserve(cfg.blockCount() + 1);
+    gen_offsets_.push_back(0);
+    kill_offsets_.push_back(0);
+    for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+        const auto& code = cfg.block(b).code;
+        const size_t first_kill = kill_.size();
+        for (uint32_t i = 0; i < code.size(); ++i) {
+            if (!tracked(code[i])) {
+                continue;
+            }
+            const uint32_t slot = code[i].operand(P::RESULT);
+            const uint32_t d = cursor[slot]++;
+            definitions_[d] = DefinitionSite{b, i};
+            last[slot] = d;
+            if (defined[slot] != b) {
+                defined[slot] = b;
+                kill_.push_back(slot);
+            }
+        }
+        for (size_t i = first_kill; i < kill_.size(); ++i) {
+            gen_.push_back(last[kill_[i]]);
+        }
+        gen_offsets_.push_back((uint32_t)gen_.size());
+        kill_offsets_.push_back((uint32_t)kill_.size());
+    }
+
+    solution_ = solveDataflow(cfg, *this);
+}
+
+// Выход = последние определения блока ∪ (вход − все определения записанных слотов)
+void ReachingDefinitions::transfer(uint32_t b, ConstBitRow reach_in, BitRow reach_out) const {
+    reach_out.assign(reach_in);
+    for (uint32_t i = kill_offsets_[b]; i < kill_offsets_[b + 1]; ++i) {
+        reach_out.resetRange(slot_offsets_[kill_[i]], slot_offsets_[kill_[i] + 1]);
+    }
+    for (uint32_t i = gen_offsets_[b]; i < gen_offsets_[b + 1]; ++i) {
+        reach_out.set(gen_[i]);
+    }
+}
+
+// --- Доступные выражения ---
+
+AvailableExpressions::ExpressionKey AvailableExpressions::keyOf(const PackedInstruction& instr) {
+    return ExpressionKey{instr.op, (uint8_t)(instr.kinds & 0x3C), instr.operand(P::ARG1), instr.operand(P::ARG2)};
+}
+
+uint32_t AvailableExpressions::expressionOf(const PackedInstruction& instr) const {
+    if (!isBinary(instr.op)) {
+        return NO_EXPRESSION;
+    }
+    const auto it = expression_ids_.find(keyOf(instr));
+    return it == expression_ids_.end() ? NO_EXPRESSION : it->second;
+}
+
+AvailableExpressions::AvailableExpressions(const ControlFlowGraph& cfg, size_t slot_count) {
+    const std::pmr::vector<uint32_t> global = numberGlobalNames(cfg, slot_count);
+
+    // Выражения над константами и глобальными именами: выражение с локальным операндом
+    // не может оказаться доступным на входе другого блока, где его вычисляют заново
+    for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+        for (const PackedInstruction& instr : cfg.block(b).code) {
+            if (!isBinary(instr.op)) {
+                continue;
+            }
+            bool global_operands = true;
+            forEachUse(instr, [&](uint32_t slot) { global_operands = global_operands && global[slot] != NO_MARK; });
+            if (!global_operands) {
+                continue;
+            }
+            auto [it, inserted] = expression_ids_.try_emplace(keyOf(instr), (uint32_t)expressions_.size());
+            if (inserted) {
+                PackedInstruction expression = instr;
+                expression.clear(P::RESULT);
+                expressions_.push_back(expression);
+            }
+        }
+    }
+
+    // Выражения по слоту-операнду
+    use_offsets_.assign(slot_count + 1, 0);
+    for (const PackedInstruction& expression : expressions_) {
+        uint32_t previous = NO_MARK;
+        forEachUse(expression, [&](uint32_t slot) {
+            if (slot != previous) {
+                ++use_offsets_[slot + 1];
+                previous = slot;
+            }
+        });
+    }
+    for (size_t slot = 0; slot < slot_count; ++slot) {
+        use_offsets_[slot + 1] += use_offsets_[slot];
+    }
+    uses_.resize(use_offsets_[slot_count]);
+    std::pmr::vector<uint32_t> cursor(use_offsets_.begin(), use_offsets_.end() - 1);
+    for (uint32_t e = 0; e < expressions_.size(); ++e) {
+        uint32_t previous = NO_MARK;
+        forEachUse(expressions_[e], [&](uint32_t slot) {
+            if (slot != previous) {
+                uses_[cursor[slot]++] = e;
+                previous = slot;
+            }
+        });
+    }
+
+    // Вычисленное выражение доступно на выходе блока, если ни один операнд не
+    // записывался после последнего вычисления
+    std::pmr::vector<uint32_t> computed(expressions_.size(), NO_MARK);
+    std::pmr::vector<uint32_t> defined(slot_count, NO_MARK);
+    std::pmr::vector<uint32_t> pending;
+    gen_offsets_.reserve(cfg.blockCount() + 1);
+    kill_offsets_.reserve(cfg.blockCount() + 1);
+    gen_offsets_.push_back(0);
+    kill_offsets_.push_back(0);
+    for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+        pending.clear();
+        for (const PackedInstruction& instr : cfg.block(b).code) {
+            const uint32_t e = expressionOf(instr);
+            if (e != NO_EXPRESSION && computed[e] != b) {
+                computed[e] = b;
+                pending.push_back(e);
+            }
+            if (instr.kind(P::RESULT) != PackedKind::SLOT) {
+                continue;
+            }
+            const uint32_t slot = instr.operand(P::RESULT);
+            if (use_offsets_[slot] == use_offsets_[slot + 1]) {
+                continue;
+            }
+            for (uint32_t i = use_offsets_[slot]; i < use_offsets_[slot + 1]; ++i) {
+                computed[uses_[i]] = NO_MARK;
+            }
+            if (defined[slot] != b) {
+                defined[slot] = b;
+                kill_.push_back(slot);
+            }
+        }
+        for (uint32_t e : pending) {
+            if (computed[e] == b) {
+                gen_.push_back(e);
+                computed[e] = NO_MARK;
+            }
+        }
+        gen_offsets_.push_back((uint32_t)gen_.size());
+        kill_offsets_.push_back((uint32_t)kill_.size());
+    }
+
+    solution_ = solveDataflow(cfg, *this);
+}
+
+// Выход = вычисленные в блоке ∪ (вход − выражения над записанными слотами)
+void AvailableExpressions::transfer(uint32_t b, ConstBitRow available_in, BitRow available_out) const {
+    available_out.assign(available_in);
+    for (uint32_t i = kill_offsets_[b]; i < kill_offsets_[b + 1]; ++i) {
+        const uint32_t slot = kill_[i];
+        for (uint32_t j = use_offsets_[slot]; j < use_offsets_[slot + 1]; ++j) {
+            available_out.reset(uses_[j]);
+        }
+    }
+    for (uint32_t i = gen_offsets_[b]; i < gen_offsets_[b + 1]; ++i) {
+        available_out.set(gen_[i]);
+    }
+}
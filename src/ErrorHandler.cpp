@@ -1,5 +1,6 @@
 #include "ErrorHandler.h"
 #include <iostream>
+#include <algorithm>
 
 ErrorHandler::ErrorHandler() : has_errors_(false) {}
 
@@ -40,4 +41,56 @@ void ErrorHandler::printErrors(std::ostream& os) const {
 
     os << "========================================\n";
     os << "Total errors found: " << errors_.size() << "\n";
-}
\ No newline at end of file
+}
+
+namespace {
+    bool before(const CompilerError& error, int line, int position) {
+        return error.line < line || (error.line == line && error.position < position);
+    }
+}
+
+void ErrorHandler::retractErrors(const std::string& type, int from_line, int from_position, int to_line,
+                                 int to_position, int line_delta, int column_delta) {
+    auto inWindow = [&](const CompilerError& error) {
+        return error.type == type && !before(error, from_line, from_position) && before(error, to_line, to_position);
+    };
+    errors_.erase(std::remove_if(errors_.begin(), errors_.end(), inWindow), errors_.end());
+    for (CompilerError& error : errors_) {
+        if (error.type == type && !before(error, to_line, to_position)) {
+            if (error.line == to_line) {
+                error.position += column_delta;
+            }
+            error.line += line_delta;
+        }
+    }
+    has_errors_ = !errors_.empty();
+}
+
+void ErrorHandler::retractErrors(const std::string& type) {
+    errors_.erase(std::remove_if(errors_.begin(), errors_.end(),
+                                 [&](const CompilerError& error) { return error.type == type; }),
+                  errors_.end());
+    has_errors_ = !errors_.empty();
+}
+
+void ErrorHandler::registerWarning(const std::string& type, const std::string& message, int line, int position) {
+    warnings_.push_back({
+        message,
+        type,
+        line,
+        position
+    });
+}
+
+const std::vector<CompilerError>& ErrorHandler::getWarnings() const {
+    return warnings_;
+}
+
+void ErrorHandler::printWarnings(std::ostream& os) const {
+    for (const auto& warning : warnings_) {
+        os << "[" << warning.type << " Warning] "
+           << "Line " << warning.line
+           << ", Position " << warning.position
+           << ": " << warning.message << "\n";
+    }
+}
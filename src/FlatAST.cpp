@@ -0,0 +1,51 @@
+#include "FlatAST.h"
+
+FlatAST::FlatAST() = default;
+
+void FlatAST::clear() {
+    kinds_.clear();
+    first_.clear();
+    second_.clear();
+    third_.clear();
+    statement_lists_.clear();
+    literals_.clear();
+    positions_.clear();
+    root_ = NO_NODE;
+}
+
+FlatAST::NodeIndex FlatAST::addNode(FlatNodeKind kind, uint32_t first, uint32_t second, uint32_t third) {
+    kinds_.push_back(kind);
+    first_.push_back(first);
+    second_.push_back(second);
+    third_.push_back(third);
+    return (NodeIndex)(kinds_.size() - 1);
+}
+
+FlatAST::NodeIndex FlatAST::addLiteral(int value) {
+    literals_.push_back(value);
+    return addNode(FlatNodeKind::INT_LITERAL, (uint32_t)(literals_.size() - 1));
+}
+
+FlatAST::NodeIndex FlatAST::addIdentifier(SymbolId name, SourcePos pos) {
+    return addNamed(FlatNodeKind::IDENTIFIER, name, 0, pos);
+}
+
+FlatAST::NodeIndex FlatAST::addNamed(FlatNodeKind kind, SymbolId name, uint32_t second, SourcePos pos) {
+    positions_.push_back(pos);
+    return addNode(kind, name, second, (uint32_t)(positions_.size() - 1));
+}
+
+// Операторы блока копируются в общий массив списков подряд
+FlatAST::NodeIndex FlatAST::addProgram(std::span<const NodeIndex> statements) {
+    const uint32_t start = (uint32_t)statement_lists_.size();
+    statement_lists_.insert(statement_lists_.end(), statements.begin(), statements.end());
+    return addNode(FlatNodeKind::PROGRAM, start, (uint32_t)statements.size());
+}
+
+size_t FlatAST::memoryBytes() const {
+    return kinds_.capacity() * sizeof(FlatNodeKind) +
+           (first_.capacity() + second_.capacity() + third_.capacity()) * sizeof(uint32_t) +
+           statement_lists_.capacity() * sizeof(NodeIndex) +
+           literals_.capacity() * sizeof(int) +
+           positions_.capacity() * sizeof(SourcePos);
+}
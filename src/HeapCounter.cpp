@@ -0,0 +1,23 @@
+#include "MemoryStats.h"
+#include <cstdlib>
+#include <new>
+
+// Замена глобальных operator new/delete: подсчёт выделений без изменения поведения.
+// Файл входит только в исполняемый файл LTLab (см. CMakeLists.txt): замена действует
+// на весь процесс, и библиотека LTLabCore не должна навязывать её другим программам
+namespace {
+    void* countedAllocate(size_t size) {
+        MemoryStats::countHeapAllocation();
+        if (void* ptr = std::malloc(size ? size : 1)) {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) { return countedAllocate(size); }
+void* operator new[](size_t size) { return countedAllocate(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
@@ -19,7 +19,9 @@ namespace {
         {IROpCode::LABEL, "LABEL"}, {IROpCode::JMP, "JMP"},
         {IROpCode::JMP_IF_ZERO, "JMP_IF_ZERO"},
 
-        {IROpCode::PRINT, "PRINT"}
+        {IROpCode::PRINT, "PRINT"},
+
+        {IROpCode::CHECK_ASSIGNED, "CHECK_ASSIGNED"}
     };
 
     // Карта для OperandType
@@ -55,13 +57,13 @@ std::string operandTypeToString(OperandType type) {
 std::string Operand::toString() const {
     switch (type) {
         case OperandType::VARIABLE:
-            return name; // Имя переменной исходного кода
+            return std::string(SymbolInterner::global().name(id)); // Имя переменной исходного кода
         case OperandType::TEMPORARY:
-            return name; // Имя временной переменной (например, T1)
+            return "T" + std::to_string(id); // Временная переменная (например, T1)
         case OperandType::LITERAL:
             return std::to_string(value); // Целочисленная константа
         case OperandType::LABEL:
-            return name; // Имя метки (например, L_START)
+            return "L" + std::to_string(id); // Метка (например, L1)
         case OperandType::NONE:
         default:
             return ""; // Пустая строка
@@ -74,16 +76,43 @@ std::string Operand::toString() const {
 // Метод для форматированного вывода инструкции
 std::string Instruction::toString() const {
     std::stringstream ss;
+    print(ss);
+    return ss.str();
+}
 
+namespace {
+    // Операнд пишется прямо в поток, без промежуточной строки
+    std::ostream& operator<<(std::ostream& os, const Operand& operand) {
+        switch (operand.type) {
+            case OperandType::VARIABLE:
+                return os << SymbolInterner::global().name(operand.id);
+            case OperandType::TEMPORARY:
+                return os << 'T' << operand.id;
+            case OperandType::LABEL:
+                return os << 'L' << operand.id;
+            case OperandType::LITERAL:
+                return os << operand.value;
+            case OperandType::NONE:
+            default:
+                return os;
+        }
+    }
+}
+
+// Вывод инструкции непосредственно в поток (без выделения памяти под строку)
+void Instruction::print(std::ostream& os) const {
     // Заголовок (например, L1: или 001:)
     if (op == IROpCode::LABEL) {
         // Метка должна быть напечатана первой: L1: LABEL
-        ss << arg1.name << ": " << opCodeToString(op);
-        return ss.str();
+        os << arg1 << ": " << opCodeToString(op);
+        return;
     }
 
-    // Вывод индекса
-    ss << std::setw(3) << std::setfill('0') << index << ": ";
+    // Вывод индекса (заполнитель потока восстанавливается)
+    char fill = os.fill('0');
+    os << std::setw(3) << index;
+    os.fill(fill);
+    os << ": ";
 
     switch (op) {
         case IROpCode::ADD:
@@ -91,7 +120,7 @@ std::string Instruction::toString() const {
         case IROpCode::MUL:
         case IROpCode::DIV:
             // R = Arg1 OP Arg2 (T1 = A + 10)
-            ss << result.toString() << " = " << arg1.toString() << " " << opCodeToString(op) << " " << arg2.toString();
+            os << result << " = " << arg1 << " " << opCodeToString(op) << " " << arg2;
             break;
 
         case IROpCode::CMP_EQ:
@@ -99,33 +128,34 @@ std::string Instruction::toString() const {
         case IROpCode::CMP_LT:
         case IROpCode::CMP_GT:
             // R = Arg1 CMP_OP Arg2 (T1 = A < B)
-            ss << result.toString() << " = " << arg1.toString() << " " << opCodeToString(op) << " " << arg2.toString();
+            os << result << " = " << arg1 << " " << opCodeToString(op) << " " << arg2;
             break;
 
         case IROpCode::ASSIGN:
             // R = Arg1 (count = T1)
-            ss << result.toString() << " = " << arg1.toString();
+            os << result << " = " << arg1;
             break;
 
         case IROpCode::LOAD_IMM:
             // R = Literal (count = 10)
             // Мы используем arg1 для хранения литерала
-            ss << result.toString() << " = " << arg1.toString();
+            os << result << " = " << arg1;
             break;
 
         case IROpCode::JMP:
             // JMP L1 (переход к метке)
-            ss << opCodeToString(op) << " " << arg1.name;
+            os << opCodeToString(op) << " " << arg1;
             break;
 
         case IROpCode::JMP_IF_ZERO:
-            // JMP_IF_ZERO Arg1, L1
-            ss << opCodeToString(op) << " " << arg1.toString() << ", " << arg2.name;
+        case IROpCode::CHECK_ASSIGNED:
+            // JMP_IF_ZERO Arg1, L1 / CHECK_ASSIGNED флаг, переменная
+            os << opCodeToString(op) << " " << arg1 << ", " << arg2;
             break;
 
         case IROpCode::PRINT:
             // PRINT Arg1
-            ss << opCodeToString(op) << " " << arg1.toString();
+            os << opCodeToString(op) << " " << arg1;
             break;
 
         case IROpCode::LABEL:
@@ -133,14 +163,13 @@ std::string Instruction::toString() const {
             break;
 
         default:
-            ss << "UNKNOWN INSTRUCTION";
+            os << "UNKNOWN INSTRUCTION";
             break;
     }
-    return ss.str();
 }
 
 // Перегрузка оператора вывода для std::cout << Instruction
 std::ostream& operator<<(std::ostream& os, const Instruction& instr) {
-    os << instr.toString();
+    instr.print(os);
     return os;
-}
\ No newline at end of file
+}
@@ -1,12 +1,13 @@
 #include "IRGenerator.h"
+#include "SemanticAnalyzer.h"
 #include <stdexcept>
 
-using std::to_string;
 using std::move;
 
 // Конструктор и основной метод генерации
-IRGenerator::IRGenerator(ErrorHandler* handler)
+IRGenerator::IRGenerator(ErrorHandler* handler, SymbolTable* symbols)
     : error_handler_(handler) {
+    builder_.setSymbols(symbols);
 }
 
 IRCode IRGenerator::generate(ASTNode* root) {
@@ -15,39 +16,111 @@ IRCode IRGenerator::generate(ASTNode* root) {
     }
 
     // Сброс состояния генератора
+    builder_.reset();
+    dispatch(*root);
+    return builder_.finish();
+}
+
+// Сброс кода и счётчиков
+void IRBuilder::reset() {
     ir_code_.clear();
     temp_counter_ = 0;
     label_counter_ = 0;
+}
 
-    root->accept(*this);
-
-    // Назначение индексов инструкциям
+// Назначение индексов инструкциям
+IRCode IRBuilder::finish() {
+    if (symbols_ && !symbols_->checkedSlots().empty()) {
+        instrumentChecks();
+    }
     for (size_t i = 0; i < ir_code_.size(); ++i) {
         ir_code_[i].index = (int)i;
     }
+    IRCode result = move(ir_code_);
+    reset();
+    return result;
+}
 
-    return move(ir_code_);
+// Проверки чтений переменных, присваивание которых не доказано анализом: у каждой такой
+// переменной свой флаг (0 в начале программы, 1 после любой записи), и перед чтением
+// CHECK_ASSIGNED сверяет его
+void IRBuilder::instrumentChecks() {
+    std::pmr::vector<Operand> flags(symbols_->slotCount());
+    for (int slot : symbols_->checkedSlots()) {
+        flags[slot] = makeTemp();
+    }
+    auto flagOf = [&](const Operand& operand) -> const Operand* {
+        if (operand.type != OperandType::VARIABLE || operand.slot < 0 || (size_t)operand.slot >= flags.size() ||
+            flags[operand.slot].isNone()) {
+            return nullptr;
+        }
+        return &flags[operand.slot];
+    };
+
+    IRCode code;
+    code.reserve(ir_code_.size() + symbols_->checkedSlots().size());
+    for (int slot : symbols_->checkedSlots()) {
+        code.emplace_back(IROpCode::LOAD_IMM, flags[slot], Operand(0));
+    }
+    for (const Instruction& instr : ir_code_) {
+        const Operand* first = flagOf(instr.arg1);
+        const Operand* second = flagOf(instr.arg2);
+        if (first) {
+            code.emplace_back(IROpCode::CHECK_ASSIGNED, Operand(), *first, Operand(instr.arg1.slot));
+        }
+        if (second && !(first && instr.arg2.slot == instr.arg1.slot)) {
+            code.emplace_back(IROpCode::CHECK_ASSIGNED, Operand(), *second, Operand(instr.arg2.slot));
+        }
+        code.push_back(instr);
+        if (const Operand* written = flagOf(instr.result)) {
+            code.emplace_back(IROpCode::LOAD_IMM, *written, Operand(1));
+        }
+    }
+    ir_code_ = move(code);
 }
 
 // Создание временной переменной
-Operand IRGenerator::makeTemp() {
+Operand IRBuilder::makeTemp() {
     temp_counter_++;
-    return Operand(OperandType::TEMPORARY, "T" + to_string(temp_counter_));
+    return Operand(OperandType::TEMPORARY, (uint32_t)temp_counter_,
+                   symbols_ ? symbols_->newSlot() : SymbolTable::NO_SLOT);
+}
+
+// Переменная исходного кода
+Operand IRBuilder::makeVariable(SymbolId name) const {
+    return Operand(OperandType::VARIABLE, name, symbols_ ? symbols_->find(name) : SymbolTable::NO_SLOT);
 }
 
 // Создание метки
-Operand IRGenerator::makeLabel() {
+Operand IRBuilder::makeLabel() {
     label_counter_++;
-    return Operand(OperandType::LABEL, "L" + to_string(label_counter_));
+    return Operand(OperandType::LABEL, (uint32_t)label_counter_);
 }
 
 // Добавление инструкции в IR-код
-void IRGenerator::emit(IROpCode op, const Operand& result, const Operand& arg1, const Operand& arg2) {
+void IRBuilder::emit(IROpCode op, const Operand& result, const Operand& arg1, const Operand& arg2) {
     ir_code_.emplace_back(op, result, arg1, arg2);
 }
 
+// Бинарная операция: временная переменная создаётся после вычисления обоих операндов
+Operand IRBuilder::emitBinary(TokenType op, const Operand& left, const Operand& right) {
+    IROpCode op_code = tokenTypeToIROpCode(op);
+    Operand result_temp = makeTemp();
+    emit(op_code, result_temp, left, right);
+    return result_temp;
+}
+
+// Присваивание значения переменной
+void IRBuilder::emitAssign(const Operand& target, const Operand& value) {
+    if (value.type == OperandType::LITERAL) {
+        emit(IROpCode::LOAD_IMM, target, value);
+    } else {
+        emit(IROpCode::ASSIGN, target, value);
+    }
+}
+
 // Конвертация типа токена в IR-операцию
-IROpCode IRGenerator::tokenTypeToIROpCode(TokenType type) const {
+IROpCode IRBuilder::tokenTypeToIROpCode(TokenType type) {
     switch (type) {
         case TokenType::TOKEN_PLUS: return IROpCode::ADD;
         case TokenType::TOKEN_MINUS: return IROpCode::SUB;
@@ -71,22 +144,18 @@ void IRGenerator::visit(IntLiteralNode& node) {
 
 // Обработка идентификатора
 void IRGenerator::visit(IdentifierNode& node) {
-    result_operand_ = Operand(OperandType::VARIABLE, node.name);
+    result_operand_ = builder_.makeVariable(node.name);
 }
 
 // Обработка бинарной операции
 void IRGenerator::visit(BinaryOpNode& node) {
-    node.left->accept(*this);
+    dispatch(*node.left);
     Operand left_op = result_operand_;
 
-    node.right->accept(*this);
+    dispatch(*node.right);
     Operand right_op = result_operand_;
 
-    IROpCode op_code = tokenTypeToIROpCode(node.op);
-    Operand result_temp = makeTemp();
-
-    emit(op_code, result_temp, left_op, right_op);
-    result_operand_ = result_temp;
+    result_operand_ = builder_.emitBinary(node.op, left_op, right_op);
 }
 
 // Неожиданное посещение терминального узла
@@ -98,7 +167,7 @@ void IRGenerator::visit(TerminalNode& node) {
 // Обработка блока программы
 void IRGenerator::visit(ProgramNode& node) {
     for (const auto& stmt : node.statements) {
-        stmt->accept(*this);
+        dispatch(*stmt);
     }
 }
 
@@ -108,58 +177,170 @@ void IRGenerator::visit(VarDeclNode& node) {
 
 // Генерация кода для оператора присваивания
 void IRGenerator::visit(AssignStmtNode& node) {
-    node.expression->accept(*this);
+    dispatch(*node.expression);
     Operand rhs_op = result_operand_;
-    Operand target_var = Operand(OperandType::VARIABLE, node.identifier_name);
-
-    if (rhs_op.type == OperandType::LITERAL) {
-        emit(IROpCode::LOAD_IMM, target_var, rhs_op);
-    } else {
-        emit(IROpCode::ASSIGN, target_var, rhs_op);
-    }
+    Operand target_var = builder_.makeVariable(node.identifier_name);
+    builder_.emitAssign(target_var, rhs_op);
 }
 
 // Генерация кода для оператора вывода
 void IRGenerator::visit(PrintStmtNode& node) {
-    node.expression->accept(*this);
+    dispatch(*node.expression);
     Operand print_op = result_operand_;
-    emit(IROpCode::PRINT, {}, print_op);
+    builder_.emit(IROpCode::PRINT, {}, print_op);
 }
 
 // Генерация кода для условного оператора
 void IRGenerator::visit(IfStmtNode& node) {
-    Operand label_else = makeLabel();
-    Operand label_end = makeLabel();
+    Operand label_else = builder_.makeLabel();
+    Operand label_end = builder_.makeLabel();
 
-    node.condition->accept(*this);
+    dispatch(*node.condition);
     Operand condition_temp = result_operand_;
 
-    emit(IROpCode::JMP_IF_ZERO, {}, condition_temp, label_else);
-    node.then_body->accept(*this);
+    builder_.emit(IROpCode::JMP_IF_ZERO, {}, condition_temp, label_else);
+    visit(*node.then_body);
 
     if (node.else_body) {
-        emit(IROpCode::JMP, {}, label_end);
+        builder_.emit(IROpCode::JMP, {}, label_end);
     }
 
-    emit(IROpCode::LABEL, {}, label_else);
+    builder_.emit(IROpCode::LABEL, {}, label_else);
     if (node.else_body) {
-        node.else_body->accept(*this);
+        visit(*node.else_body);
     }
 
-    emit(IROpCode::LABEL, {}, label_end);
+    builder_.emit(IROpCode::LABEL, {}, label_end);
 }
 
 // Генерация кода для цикла while
 void IRGenerator::visit(WhileStmtNode& node) {
-    Operand label_start = makeLabel();
-    Operand label_end = makeLabel();
+    Operand label_start = builder_.makeLabel();
+    Operand label_end = builder_.makeLabel();
 
-    emit(IROpCode::LABEL, {}, label_start);
-    node.condition->accept(*this);
+    builder_.emit(IROpCode::LABEL, {}, label_start);
+    dispatch(*node.condition);
     Operand condition_temp = result_operand_;
 
-    emit(IROpCode::JMP_IF_ZERO, {}, condition_temp, label_end);
-    node.body->accept(*this);
-    emit(IROpCode::JMP, {}, label_start);
-    emit(IROpCode::LABEL, {}, label_end);
-}
\ No newline at end of file
+    builder_.emit(IROpCode::JMP_IF_ZERO, {}, condition_temp, label_end);
+    visit(*node.body);
+    builder_.emit(IROpCode::JMP, {}, label_start);
+    builder_.emit(IROpCode::LABEL, {}, label_end);
+}
+// --- Генерация по плоскому AST ---
+
+IRCode IRGenerator::generate(const FlatAST& ast) {
+    if (ast.root() == FlatAST::NO_NODE) {
+        return {};
+    }
+
+    builder_.reset();
+    generateStatement(ast, ast.root());
+    return builder_.finish();
+}
+
+// Выражение обходится в обратном порядке на явном стеке: левый операнд, правый,
+// затем операция — как при рекурсивном обходе, поэтому нумерация временных та же
+Operand IRGenerator::generateExpression(const FlatAST& ast, FlatAST::NodeIndex node) {
+    const size_t operand_base = flat_operands_.size();
+    flat_frames_.push_back(FlatFrame{node, false});
+
+    while (!flat_frames_.empty()) {
+        FlatFrame frame = flat_frames_.back();
+        flat_frames_.pop_back();
+
+        switch (ast.kind(frame.node)) {
+            case FlatNodeKind::INT_LITERAL:
+                flat_operands_.push_back(Operand(ast.literal(frame.node)));
+                break;
+
+            case FlatNodeKind::IDENTIFIER:
+                flat_operands_.push_back(builder_.makeVariable(ast.symbol(frame.node)));
+                break;
+
+            case FlatNodeKind::BINARY_OP:
+                if (!frame.operands_ready) {
+                    flat_frames_.push_back(FlatFrame{frame.node, true});
+                    flat_frames_.push_back(FlatFrame{ast.second(frame.node), false});
+                    flat_frames_.push_back(FlatFrame{ast.first(frame.node), false});
+                } else {
+                    Operand right_op = move(flat_operands_.back());
+                    flat_operands_.pop_back();
+                    Operand& left_op = flat_operands_.back();
+                    left_op = builder_.emitBinary(ast.op(frame.node), left_op, right_op);
+                }
+                break;
+
+            default:
+                error_handler_->registerError("IR Generation", "Unexpected statement node inside expression.", 0, 0);
+                flat_operands_.push_back({});
+                break;
+        }
+    }
+
+    Operand result = move(flat_operands_.back());
+    flat_operands_.resize(operand_base);
+    return result;
+}
+
+// Операторы: рекурсия только по вложенности блоков
+void IRGenerator::generateStatement(const FlatAST& ast, FlatAST::NodeIndex node) {
+    switch (ast.kind(node)) {
+        case FlatNodeKind::PROGRAM:
+            for (FlatAST::NodeIndex stmt : ast.statements(node)) {
+                generateStatement(ast, stmt);
+            }
+            break;
+
+        case FlatNodeKind::VAR_DECL:
+            // Объявление переменной не требует IR-инструкции
+            break;
+
+        case FlatNodeKind::ASSIGN_STMT: {
+            Operand rhs_op = generateExpression(ast, ast.second(node));
+            builder_.emitAssign(builder_.makeVariable(ast.symbol(node)), rhs_op);
+            break;
+        }
+
+        case FlatNodeKind::PRINT_STMT:
+            builder_.emit(IROpCode::PRINT, {}, generateExpression(ast, ast.first(node)));
+            break;
+
+        case FlatNodeKind::IF_STMT: {
+            Operand label_else = builder_.makeLabel();
+            Operand label_end = builder_.makeLabel();
+            const bool has_else = ast.third(node) != FlatAST::NO_NODE;
+
+            Operand condition_temp = generateExpression(ast, ast.first(node));
+            builder_.emit(IROpCode::JMP_IF_ZERO, {}, condition_temp, label_else);
+            generateStatement(ast, ast.second(node));
+
+            if (has_else) {
+                builder_.emit(IROpCode::JMP, {}, label_end);
+            }
+            builder_.emit(IROpCode::LABEL, {}, label_else);
+            if (has_else) {
+                generateStatement(ast, ast.third(node));
+            }
+            builder_.emit(IROpCode::LABEL, {}, label_end);
+            break;
+        }
+
+        case FlatNodeKind::WHILE_STMT: {
+            Operand label_start = builder_.makeLabel();
+            Operand label_end = builder_.makeLabel();
+
+            builder_.emit(IROpCode::LABEL, {}, label_start);
+            Operand condition_temp = generateExpression(ast, ast.first(node));
+            builder_.emit(IROpCode::JMP_IF_ZERO, {}, condition_temp, label_end);
+            generateStatement(ast, ast.second(node));
+            builder_.emit(IROpCode::JMP, {}, label_start);
+            builder_.emit(IROpCode::LABEL, {}, label_end);
+            break;
+        }
+
+        default:
+            error_handler_->registerError("IR Generation", "Unexpected expression node in statement position.", 0, 0);
+            break;
+    }
+}
@@ -2,56 +2,88 @@
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
+#include <sstream>
 
 using std::to_string;
 using std::runtime_error;
 
-// Получение значения операнда
-int IRInterpreter::getValue(const Operand& op) const {
-    switch (op.type) {
-        case OperandType::LITERAL:
-            return op.value;
-        case OperandType::VARIABLE:
-        case OperandType::TEMPORARY: {
-            auto it = memory_.find(op.name);
-            if (it != memory_.end()) {
-                return it->second;
+namespace {
+    // Проверка операнда до выполнения: чтение только из константы или ячейки, запись только в ячейку;
+    // номер ячейки или константы должен попадать в таблицу (код мог быть загружен из файла)
+    void checkOperand(const PackedIRView& code, const PackedInstruction& instr, int field, bool readable) {
+        const PackedKind kind = instr.kind(field);
+        const uint32_t value = instr.operand(field);
+        if (kind == PackedKind::SLOT || (readable && kind == PackedKind::CONST)) {
+            if (value >= (kind == PackedKind::SLOT ? code.slot_count : code.constant_count)) {
+                throw runtime_error("Interpreter Error: Operand index " + to_string(value) + " is out of range (" +
+                                    packedKindToString(kind) + ").");
             }
-            throw runtime_error("Runtime Error: Variable/Temp '" + op.name + "' used before assignment.");
+            return;
         }
-        case OperandType::NONE:
-        case OperandType::LABEL:
-        default:
-            throw runtime_error("Runtime Error: Attempt to read value from invalid operand type (" + operandTypeToString(op.type) + ").");
-    }
-}
-
-// Сохранение значения в переменную
-void IRInterpreter::setValue(const Operand& target, int value) {
-    if (target.type != OperandType::VARIABLE && target.type != OperandType::TEMPORARY) {
-        throw runtime_error("Runtime Error: Attempt to write value to invalid operand type (" + operandTypeToString(target.type) + ").");
+        throw runtime_error(std::string("Interpreter Error: Attempt to ") + (readable ? "read value from" : "write value to") +
+                            " invalid operand type (" + packedKindToString(kind) + ").");
     }
-    memory_[target.name] = value;
 }
 
-// Построение карты меток для переходов
-void IRInterpreter::buildLabelMap(const IRCode& code) {
-    label_map_.clear();
-    for (size_t i = 0; i < code.size(); ++i) {
-        const Instruction& instr = code[i];
-        if (instr.op == IROpCode::LABEL) {
-            if (instr.arg1.type == OperandType::LABEL) {
-                label_map_[instr.arg1.name] = (int)i + 1;
-            } else {
-                throw runtime_error("Interpreter Error: LABEL instruction missing label name.");
+// Подготовка: проверка операндов и целей переходов, память выделяется по таблице слотов
+void IRInterpreter::prepare(const PackedIRView& code) {
+    using P = PackedInstruction;
+    for (size_t i = 0; i < code.size; ++i) {
+        const PackedInstruction& instr = code.code[i];
+        switch (instr.op) {
+            case IROpCode::ADD:
+            case IROpCode::SUB:
+            case IROpCode::MUL:
+            case IROpCode::DIV:
+            case IROpCode::CMP_EQ:
+            case IROpCode::CMP_NE:
+            case IROpCode::CMP_LT:
+            case IROpCode::CMP_GT:
+                checkOperand(code, instr, P::ARG1, true);
+                checkOperand(code, instr, P::ARG2, true);
+                checkOperand(code, instr, P::RESULT, false);
+                break;
+            case IROpCode::ASSIGN:
+            case IROpCode::LOAD_IMM:
+                checkOperand(code, instr, P::ARG1, true);
+                checkOperand(code, instr, P::RESULT, false);
+                break;
+            case IROpCode::PRINT:
+                checkOperand(code, instr, P::ARG1, true);
+                break;
+            case IROpCode::CHECK_ASSIGNED:
+                checkOperand(code, instr, P::ARG1, true);
+                checkOperand(code, instr, P::ARG2, true);
+                break;
+            case IROpCode::LABEL:
+                if (instr.kind(P::ARG1) != PackedKind::LABEL) {
+                    throw runtime_error("Interpreter Error: LABEL instruction missing label name.");
+                }
+                break;
+            case IROpCode::JMP:
+            case IROpCode::JMP_IF_ZERO: {
+                if (instr.op == IROpCode::JMP_IF_ZERO) {
+                    checkOperand(code, instr, P::ARG1, true);
+                }
+                const int field = instr.op == IROpCode::JMP ? P::ARG1 : P::ARG2;
+                if (instr.kind(field) != PackedKind::LABEL || code.labelTarget(instr.operand(field)) >= code.size) {
+                    throw runtime_error("Undefined label target for " + opCodeToString(instr.op) + ": L" +
+                                        to_string(instr.operand(field)));
+                }
+                break;
             }
+            default:
+                break;
         }
     }
+    memory_.assign(code.slot_count, 0);
+    constants_ = code.constants;
 }
 
 // Основной цикл выполнения IR-кода
-void IRInterpreter::execute(const IRCode& code) {
-    if (code.empty()) {
+void IRInterpreter::execute(const PackedIRView& code) {
+    using P = PackedInstruction;
+    if (code.size == 0) {
         std::cout << "[INTERPRETER] IR Code is empty. Nothing to execute.\n";
         return;
     }
@@ -61,18 +93,23 @@ void IRInterpreter::execute(const IRCode& code) {
     std::cout << "========================================\n";
 
     try {
-        buildLabelMap(code);
+        prepare(code);
     } catch (const runtime_error& e) {
-        std::cerr << "Label Map Building Failed: " << e.what() << "\n";
+        std::cerr << "IR Preparation Failed: " << e.what() << "\n";
         return;
     }
 
+    executed_ = 0;
+    executed_by_op_.fill(0);
     int pc = 0;
-    while (pc < (int)code.size()) {
-        const Instruction& instr = code[pc];
+    while (pc < (int)code.size) {
+        const PackedInstruction& instr = code.code[pc];
         int next_pc = pc + 1;
+        ++executed_;
 
-        std::cout << "PC " << pc << ": Executing " << instr.toString() << "\n";
+        std::cout << "PC " << pc << ": Executing ";
+        code.print(std::cout, (size_t)pc);
+        std::cout << "\n";
 
         try {
             switch (instr.op) {
@@ -80,8 +117,8 @@ void IRInterpreter::execute(const IRCode& code) {
                 case IROpCode::SUB:
                 case IROpCode::MUL:
                 case IROpCode::DIV: {
-                    int val1 = getValue(instr.arg1);
-                    int val2 = getValue(instr.arg2);
+                    int val1 = getValue(instr, P::ARG1);
+                    int val2 = getValue(instr, P::ARG2);
                     int result;
 
                     if (instr.op == IROpCode::DIV && val2 == 0) {
@@ -93,7 +130,7 @@ void IRInterpreter::execute(const IRCode& code) {
                     else if (instr.op == IROpCode::MUL) result = val1 * val2;
                     else result = val1 / val2;
 
-                    setValue(instr.result, result);
+                    setValue(instr, result);
                     break;
                 }
 
@@ -101,8 +138,8 @@ void IRInterpreter::execute(const IRCode& code) {
                 case IROpCode::CMP_NE:
                 case IROpCode::CMP_LT:
                 case IROpCode::CMP_GT: {
-                    int val1 = getValue(instr.arg1);
-                    int val2 = getValue(instr.arg2);
+                    int val1 = getValue(instr, P::ARG1);
+                    int val2 = getValue(instr, P::ARG2);
                     int result = 0;
 
                     if (instr.op == IROpCode::CMP_EQ) result = (val1 == val2);
@@ -110,18 +147,18 @@ void IRInterpreter::execute(const IRCode& code) {
                     else if (instr.op == IROpCode::CMP_LT) result = (val1 < val2);
                     else if (instr.op == IROpCode::CMP_GT) result = (val1 > val2);
 
-                    setValue(instr.result, result);
+                    setValue(instr, result);
                     break;
                 }
 
                 case IROpCode::ASSIGN: {
-                    int val = getValue(instr.arg1);
-                    setValue(instr.result, val);
+                    int val = getValue(instr, P::ARG1);
+                    setValue(instr, val);
                     break;
                 }
                 case IROpCode::LOAD_IMM: {
-                    int val = getValue(instr.arg1);
-                    setValue(instr.result, val);
+                    int val = getValue(instr, P::ARG1);
+                    setValue(instr, val);
                     break;
                 }
 
@@ -129,43 +166,49 @@ void IRInterpreter::execute(const IRCode& code) {
                     break;
                 }
                 case IROpCode::JMP: {
-                    auto it = label_map_.find(instr.arg1.name);
-                    if (it == label_map_.end()) {
-                        throw runtime_error("Undefined label target for JMP: " + instr.arg1.name);
-                    }
-                    next_pc = it->second;
+                    next_pc = (int)code.labelTarget(instr.operand(P::ARG1)) + 1;
                     break;
                 }
                 case IROpCode::JMP_IF_ZERO: {
-                    int condition_val = getValue(instr.arg1);
+                    int condition_val = getValue(instr, P::ARG1);
                     if (condition_val == 0) {
-                        auto it = label_map_.find(instr.arg2.name);
-                        if (it == label_map_.end()) {
-                            throw runtime_error("Undefined label target for JMP_IF_ZERO: " + instr.arg2.name);
-                        }
-                        next_pc = it->second;
+                        next_pc = (int)code.labelTarget(instr.operand(P::ARG2)) + 1;
                     }
                     break;
                 }
 
                 case IROpCode::PRINT: {
-                    int val = getValue(instr.arg1);
+                    int val = getValue(instr, P::ARG1);
                     std::cout << ">>> PRINT OUTPUT: " << val << "\n";
                     break;
                 }
 
+                case IROpCode::CHECK_ASSIGNED: {
+                    if (getValue(instr, P::ARG1) == 0) {
+                        std::ostringstream name;
+                        const int slot = getValue(instr, P::ARG2);
+                        if (slot >= 0 && (size_t)slot < code.slot_count) {
+                            code.printSlot(name, (uint32_t)slot);
+                        }
+                        throw runtime_error("Variable '" + name.str() + "' used before assignment.");
+                    }
+                    break;
+                }
+
                 default:
                     throw runtime_error("Unknown IROpCode encountered: " + opCodeToString(instr.op));
             }
         } catch (const runtime_error& e) {
-            std::cerr << "\nRuntime Error at index " << instr.index << ": " << e.what() << "\n";
+            std::cerr << "\nRuntime Error at index " << pc << ": " << e.what() << "\n";
             std::cerr << "Execution Aborted.\n";
             return;
         }
 
+        ++executed_by_op_[(size_t)instr.op];   // Неизвестный код сюда не доходит
         pc = next_pc;
     }
 
+    std::cout << "\n[INTERPRETER] " << executed_ << " instructions executed.\n";
     std::cout << "\n========================================\n";
     std::cout << "IR INTERPRETER FINISHED (EOF)\n";
     std::cout << "========================================\n";
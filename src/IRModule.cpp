@@ -0,0 +1,183 @@
+#include "IRModule.h"
+#include <cstring>
+#include <cstddef>
+#include <array>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    constexpr char MODULE_MAGIC[4] = {'M', 'L', 'I', 'R'};
+    constexpr uint16_t BYTE_ORDER_MARK = 0x0102;
+    constexpr uint64_t SECTION_ALIGNMENT = 8;
+
+    uint64_t alignSection(uint64_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+    }
+
+    [[noreturn]] void fail(const std::string& message) {
+        throw std::runtime_error("IR Module Error: " + message);
+    }
+
+    // Раздел: count элементов по element_size байт от offset, целиком внутри файла и выровнен
+    const char* section(std::string_view data, uint64_t offset, uint64_t count, size_t element_size,
+                        const char* name) {
+        if (offset % SECTION_ALIGNMENT != 0 || offset > data.size() ||
+            count > (data.size() - offset) / element_size) {
+            fail(std::string("section '") + name + "' is out of bounds");
+        }
+        return data.data() + offset;
+    }
+
+    // Запись с дополнением нулями до выравнивания раздела
+    class SectionWriter {
+    private:
+        std::ostream& out_;
+        uint64_t offset_ = 0;
+
+    public:
+        explicit SectionWriter(std::ostream& out) : out_(out) {}
+
+        uint64_t offset() const { return offset_; }
+
+        void write(const void* data, size_t bytes) {
+            out_.write(static_cast<const char*>(data), (std::streamsize)bytes);
+            offset_ += bytes;
+        }
+
+        void align() {
+            static const char ZEROS[SECTION_ALIGNMENT] = {};
+            const uint64_t aligned = alignSection(offset_);
+            write(ZEROS, (size_t)(aligned - offset_));
+        }
+    };
+}
+
+// --- Запись ---
+
+void IRModule::write(const PackedIR& code, std::ostream& out) {
+    // Номера имён модуля: только переменные, встречающиеся в слотах
+    std::unordered_map<SymbolId, uint32_t> name_ids;
+    std::vector<SymbolId> names;
+    // Слоты пишутся побайтно: поля копируются в обнулённую запись, чтобы байты
+    // выравнивания в файле тоже были нулями
+    using SlotBytes = std::array<std::byte, sizeof(PackedSlot)>;
+    std::vector<SlotBytes> slots(code.slotCount());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const PackedSlot& slot = code.slot((uint32_t)i);
+        uint32_t id = slot.id;
+        if (slot.type == OperandType::VARIABLE) {
+            auto [it, inserted] = name_ids.try_emplace(slot.id, (uint32_t)names.size());
+            if (inserted) {
+                names.push_back(slot.id);
+            }
+            id = it->second;
+        }
+        slots[i] = SlotBytes{};
+        std::memcpy(slots[i].data() + offsetof(PackedSlot, type), &slot.type, sizeof(slot.type));
+        std::memcpy(slots[i].data() + offsetof(PackedSlot, id), &id, sizeof(id));
+    }
+
+    const SymbolInterner& interner = SymbolInterner::global();
+    std::vector<uint32_t> name_offsets;
+    name_offsets.reserve(names.size() + 1);
+    uint32_t name_bytes = 0;
+    name_offsets.push_back(0);
+    for (SymbolId name : names) {
+        name_bytes += (uint32_t)interner.name(name).size();
+        name_offsets.push_back(name_bytes);
+    }
+
+    IRModuleHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MODULE_MAGIC, sizeof(MODULE_MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.instruction_count = (uint32_t)code.size();
+    header.slot_count = (uint32_t)slots.size();
+    header.constant_count = (uint32_t)code.constants().size();
+    header.label_count = (uint32_t)code.labels().size();
+    header.name_count = (uint32_t)names.size();
+    header.name_bytes = name_bytes;
+    header.instruction_offset = alignSection(sizeof(IRModuleHeader));
+    header.slot_offset = alignSection(header.instruction_offset + (uint64_t)header.instruction_count * sizeof(PackedInstruction));
+    header.constant_offset = alignSection(header.slot_offset + (uint64_t)header.slot_count * sizeof(PackedSlot));
+    header.label_offset = alignSection(header.constant_offset + (uint64_t)header.constant_count * sizeof(int32_t));
+    header.name_offset = alignSection(header.label_offset + (uint64_t)header.label_count * sizeof(uint32_t));
+
+    SectionWriter writer(out);
+    writer.write(&header, sizeof(header));
+    writer.align();
+    writer.write(code.code().data(), code.size() * sizeof(PackedInstruction));
+    writer.align();
+    writer.write(slots.data(), slots.size() * sizeof(SlotBytes));
+    writer.align();
+    writer.write(code.constants().data(), code.constants().size() * sizeof(int32_t));
+    writer.align();
+    writer.write(code.labels().data(), code.labels().size() * sizeof(uint32_t));
+    writer.align();
+    writer.write(name_offsets.data(), name_offsets.size() * sizeof(uint32_t));
+    for (SymbolId name : names) {
+        const std::string_view text = interner.name(name);
+        writer.write(text.data(), text.size());
+    }
+}
+
+// --- Загрузка ---
+
+// Проверяются только заголовок, границы разделов и таблица имён; инструкции
+// используются на месте (их операнды проверяет интерпретатор перед выполнением)
+void IRModule::load(const std::string& path) {
+    names_.clear();
+    view_ = PackedIRView{};
+    if (!file_.open(path)) {
+        fail("could not open '" + path + "'");
+    }
+    const std::string_view data = file_.view();
+    IRModuleHeader header;
+    if (data.size() < sizeof(header)) {
+        fail("file is too small for a module header");
+    }
+    if ((reinterpret_cast<uintptr_t>(data.data()) % SECTION_ALIGNMENT) != 0) {
+        fail("module data is not aligned");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, MODULE_MAGIC, sizeof(MODULE_MAGIC)) != 0) {
+        fail("bad header (not a MiniLang IR module)");
+    }
+    if (header.byte_order != BYTE_ORDER_MARK) {
+        fail("module was written with a different byte order");
+    }
+    if (header.version != VERSION) {
+        fail("unsupported version " + std::to_string(header.version) + " (expected " + std::to_string(VERSION) + ")");
+    }
+
+    view_.code = reinterpret_cast<const PackedInstruction*>(
+        section(data, header.instruction_offset, header.instruction_count, sizeof(PackedInstruction), "instructions"));
+    view_.size = header.instruction_count;
+    view_.slots = reinterpret_cast<const PackedSlot*>(
+        section(data, header.slot_offset, header.slot_count, sizeof(PackedSlot), "slots"));
+    view_.slot_count = header.slot_count;
+    view_.constants = reinterpret_cast<const int*>(
+        section(data, header.constant_offset, header.constant_count, sizeof(int32_t), "constants"));
+    view_.constant_count = header.constant_count;
+    view_.labels = reinterpret_cast<const uint32_t*>(
+        section(data, header.label_offset, header.label_count, sizeof(uint32_t), "labels"));
+    view_.label_count = header.label_count;
+
+    const uint32_t* name_offsets = reinterpret_cast<const uint32_t*>(
+        section(data, header.name_offset, (uint64_t)header.name_count + 1, sizeof(uint32_t), "names"));
+    const uint64_t chars_offset = header.name_offset + ((uint64_t)header.name_count + 1) * sizeof(uint32_t);
+    if (header.name_bytes > data.size() - chars_offset) {
+        fail("section 'names' is out of bounds");
+    }
+    const char* chars = data.data() + chars_offset;
+    names_.reserve(header.name_count);
+    for (uint32_t i = 0; i < header.name_count; ++i) {
+        if (name_offsets[i] > name_offsets[i + 1] || name_offsets[i + 1] > header.name_bytes) {
+            fail("corrupted name table");
+        }
+        names_.emplace_back(chars + name_offsets[i], name_offsets[i + 1] - name_offsets[i]);
+    }
+    view_.names = names_.data();
+    view_.name_count = names_.size();
+}
@@ -1,106 +1,1397 @@
 #include "IROptimizer.h"
+#include "ControlFlowGraph.h"
+#include "SSAForm.h"
 #include <stdexcept>
 #include <algorithm>
-#include <set>
+#include <climits>
+#include <unordered_map>
+#include <map>
+#include <tuple>
 #include <iostream>
 
-using std::to_string;
-using std::move;
+namespace {
+    using P = PackedInstruction;
 
-// Главный метод оптимизации
-IRCode IROptimizer::optimize(const IRCode& code) {
-    IRCode optimized_code = code;
+    bool isBinaryOp(IROpCode op) {
+        return op == IROpCode::ADD || op == IROpCode::SUB || op == IROpCode::MUL || op == IROpCode::DIV ||
+               op == IROpCode::CMP_EQ || op == IROpCode::CMP_NE || op == IROpCode::CMP_LT || op == IROpCode::CMP_GT;
+    }
+
+    // Значение решётки SCCP: ещё не вычислено -> константа -> не константа
+    struct LatticeValue {
+        enum State : uint8_t { UNDEFINED, CONSTANT, OVERDEFINED };
+        State state = UNDEFINED;
+        int constant = 0;
+    };
+
+    LatticeValue meet(LatticeValue a, LatticeValue b) {
+        if (a.state == LatticeValue::UNDEFINED) {
+            return b;
+        }
+        if (b.state == LatticeValue::UNDEFINED) {
+            return a;
+        }
+        if (a.state == LatticeValue::CONSTANT && b.state == LatticeValue::CONSTANT && a.constant == b.constant) {
+            return a;
+        }
+        return LatticeValue{LatticeValue::OVERDEFINED, 0};
+    }
+
+    // Аргументы φ-функций по рёбрам, которых больше нет после правки переходов, убираются,
+    // затем граф анализируется заново. Порядок предшественников после analyze() тот же
+    // (по номеру блока), из кратного ребра остаётся первое вхождение
+    void removeDeletedEdges(ControlFlowGraph& cfg) {
+        std::pmr::vector<uint8_t> keep;
+        for (uint32_t b = 0; b < cfg.blockCount(); ++b) {
+            BasicBlock& block = cfg.block(b);
+            if (block.phis.empty()) {
+                continue;
+            }
+            const auto preds = cfg.predecessors(b);
+            keep.assign(preds.size(), 0);
+            for (size_t i = 0; i < preds.size(); ++i) {
+                const BasicBlock& pred = cfg.block(preds[i]);
+                const size_t remaining = (size_t)(pred.next == b) + (size_t)(pred.isConditional() && pred.target == b);
+                const size_t occurrence = (size_t)std::count(preds.begin(), preds.begin() + (ptrdiff_t)i, preds[i]);
+                keep[i] = occurrence < remaining;
+            }
+            for (PhiNode& phi : block.phis) {
+                size_t kept = 0;
+                for (size_t i = 0; i < phi.args.size(); ++i) {
+                    if (keep[i]) {
+                        phi.args[kept++] = phi.args[i];
+                    }
+                }
+                phi.args.resize(kept);
+            }
+        }
+        cfg.analyze();
+    }
+
+    // Сравнение с обратным результатом без новых инструкций: EQ и NE меняются местами,
+    // строгое сравнение с литералом становится строгим сравнением с соседним литералом
+    // (a < c эквивалентно !(a > c - 1)). Возвращает false, если так не получается
+    bool invertComparison(PackedInstruction& instr, PackedIR& code) {
+        if (instr.op == IROpCode::CMP_EQ || instr.op == IROpCode::CMP_NE) {
+            instr.op = instr.op == IROpCode::CMP_EQ ? IROpCode::CMP_NE : IROpCode::CMP_EQ;
+            return true;
+        }
+        if (instr.op != IROpCode::CMP_LT && instr.op != IROpCode::CMP_GT) {
+            return false;
+        }
+        // !(a < b) = a >= b, !(a > b) = a <= b: литерал справа сдвигается к a, слева — от b
+        const bool less = instr.op == IROpCode::CMP_LT;
+        const int field = instr.kind(P::ARG2) == PackedKind::CONST ? P::ARG2
+                          : instr.kind(P::ARG1) == PackedKind::CONST ? P::ARG1 : -1;
+        if (field < 0) {
+            return false;
+        }
+        const int value = code.constant(instr.operand(field));
+        const int step = (field == P::ARG2) == less ? -1 : 1;
+        if ((step < 0 && value == INT_MIN) || (step > 0 && value == INT_MAX)) {
+            return false;
+        }
+        instr.op = less ? IROpCode::CMP_GT : IROpCode::CMP_LT;
+        instr.set(field, PackedKind::CONST, code.addConstant(value + step));
+        return true;
+    }
+
+    // Ключ выражения для нумерации значений: операция и операнды, где слот заменён
+    // номером значения (kinds — виды ARG1 и ARG2 в битах PackedInstruction::kinds)
+    struct ValueKey {
+        IROpCode op;
+        uint8_t kinds;
+        uint32_t arg1;
+        uint32_t arg2;
 
+        bool operator==(const ValueKey&) const = default;
+    };
+    struct ValueKeyHash {
+        size_t operator()(const ValueKey& key) const {
+            return std::hash<uint64_t>()(((uint64_t)key.arg1 << 32 | key.arg2) * 31 + ((uint64_t)key.op << 8 | key.kinds));
+        }
+    };
+
+    bool isCommutative(IROpCode op) {
+        return op == IROpCode::ADD || op == IROpCode::MUL || op == IROpCode::CMP_EQ || op == IROpCode::CMP_NE;
+    }
+}
+
+// Главный метод оптимизации
+void IROptimizer::optimize(PackedIR& code) {
     // Последовательное выполнение проходов оптимизации
     std::cout << "\n[OPTIMIZER] Starting Constant Folding Pass...\n";
-    constantFoldingPass(optimized_code);
+    constantFoldingPass(code);
 
-    std::cout << "[OPTIMIZER] Starting Redundant Control Flow Pass...\n";
-    redundantControlFlowPass(optimized_code);
-
-    // Перенумерация инструкций после удалений
-    for (size_t i = 0; i < optimized_code.size(); ++i) {
-        optimized_code[i].index = (int)i;
+    // Блоки, дерево доминаторов и циклы; код записывается обратно из блоков
+    std::cout << "[OPTIMIZER] Building Control-Flow Graph...\n";
+    ControlFlowGraph cfg(code);
+    cfg.analyze();
+    uint32_t max_depth = 0;
+    for (const Loop& loop : cfg.loops()) {
+        max_depth = std::max(max_depth, loop.depth);
     }
+    std::cout << "[CFG] " << cfg.blockCount() << " basic blocks, " << cfg.loops().size()
+              << " natural loops (max nesting depth " << max_depth << ").\n";
+
+    // SSA-форма: версии переменных и φ-функции; на выходе копии φ-функций сливаются
+    std::cout << "[OPTIMIZER] Building SSA Form...\n";
+    SSAForm ssa(cfg, code);
+    std::cout << "[SSA] " << ssa.phiCount() << " PHI nodes, " << ssa.valueCount() << " values.\n";
+
+    std::cout << "[OPTIMIZER] Starting Sparse Conditional Constant Propagation...\n";
+    sparseConditionalConstantPass(cfg, ssa, code);
+
+    std::cout << "[OPTIMIZER] Starting Global Value Numbering Pass...\n";
+    globalValueNumberingPass(cfg, ssa);
+
+    std::cout << "[OPTIMIZER] Starting Copy Propagation Pass...\n";
+    copyPropagationPass(cfg, ssa);
+
+    std::cout << "[OPTIMIZER] Starting Dead Code Elimination Pass...\n";
+    deadCodeEliminationPass(cfg, ssa, code);
 
-    return optimized_code;
+    std::cout << "[OPTIMIZER] Starting Loop-Invariant Code Motion Pass...\n";
+    loopInvariantCodeMotionPass(cfg, ssa, code);
+
+    std::cout << "[OPTIMIZER] Starting Induction Variable Strength Reduction Pass...\n";
+    inductionVariablePass(cfg, ssa, code);
+
+    ssa.destruct();
+    std::cout << "[SSA] Out of SSA: " << ssa.copiesInserted() << " copies inserted, "
+              << ssa.copiesCoalesced() << " coalesced.\n";
+
+    std::cout << "[OPTIMIZER] Starting Control Flow Simplification Pass...\n";
+    controlFlowSimplificationPass(cfg, code);
+    cfg.linearize(code);
 }
 
 // Вычисление константного выражения
-Operand IROptimizer::evaluateConstant(IROpCode op, const Operand& arg1, const Operand& arg2) {
-    int val1 = arg1.value;
-    int val2 = arg2.value;
-    int result = 0;
-
+int IROptimizer::evaluateConstant(IROpCode op, int val1, int val2) {
     switch (op) {
-        case IROpCode::ADD: result = val1 + val2; break;
-        case IROpCode::SUB: result = val1 - val2; break;
-        case IROpCode::MUL: result = val1 * val2; break;
+        case IROpCode::ADD: return val1 + val2;
+        case IROpCode::SUB: return val1 - val2;
+        case IROpCode::MUL: return val1 * val2;
         case IROpCode::DIV:
             if (val2 == 0) {
                 throw std::runtime_error("Division by zero in Constant Folding.");
             }
-            result = val1 / val2; break;
+            return val1 / val2;
 
-        case IROpCode::CMP_EQ: result = (val1 == val2); break;
-        case IROpCode::CMP_NE: result = (val1 != val2); break;
-        case IROpCode::CMP_LT: result = (val1 < val2); break;
-        case IROpCode::CMP_GT: result = (val1 > val2); break;
+        case IROpCode::CMP_EQ: return val1 == val2;
+        case IROpCode::CMP_NE: return val1 != val2;
+        case IROpCode::CMP_LT: return val1 < val2;
+        case IROpCode::CMP_GT: return val1 > val2;
 
         default:
             throw std::runtime_error("Unsupported operation in evaluateConstant.");
     }
-
-    return Operand(result);
 }
 
 // Проход свёртки констант
-void IROptimizer::constantFoldingPass(IRCode& code) {
-    for (Instruction& instr : code) {
-        bool is_binary_op = (instr.op == IROpCode::ADD || instr.op == IROpCode::SUB ||
-                             instr.op == IROpCode::MUL || instr.op == IROpCode::DIV ||
-                             instr.op == IROpCode::CMP_EQ || instr.op == IROpCode::CMP_NE ||
-                             instr.op == IROpCode::CMP_LT || instr.op == IROpCode::CMP_GT);
+void IROptimizer::constantFoldingPass(PackedIR& code) {
+    for (size_t i = 0; i < code.size(); ++i) {
+        PackedInstruction& instr = code.code()[i];
 
         // Замена бинарной операции с константами на LOAD_IMM
-        if (is_binary_op && isLiteral(instr.arg1) && isLiteral(instr.arg2)) {
+        if (isBinaryOp(instr.op) && instr.kind(P::ARG1) == PackedKind::CONST && instr.kind(P::ARG2) == PackedKind::CONST) {
             try {
-                Operand constant_result = evaluateConstant(instr.op, instr.arg1, instr.arg2);
+                const int result = evaluateConstant(instr.op, code.constant(instr.operand(P::ARG1)),
+                                                    code.constant(instr.operand(P::ARG2)));
                 instr.op = IROpCode::LOAD_IMM;
-                instr.arg1 = constant_result;
-                instr.arg2 = {};
-                std::cout << "[CF] Optimized instruction at index " << instr.index << ".\n";
+                instr.set(P::ARG1, PackedKind::CONST, code.addConstant(result));
+                instr.clear(P::ARG2);
+                std::cout << "[CF] Optimized instruction at index " << i << ".\n";
             } catch (const std::runtime_error& e) {
             }
         }
     }
 }
 
-// Оптимизация потока управления: удаление неиспользуемых меток
-void IROptimizer::redundantControlFlowPass(IRCode& code) {
-    std::set<std::string> used_labels;
+// Разреженное условное распространение констант (Wegman–Zadeck) на SSA-форме.
+// Значения и рёбра оцениваются оптимистично: блок исполним, только если в него ведёт
+// исполнимое ребро, и аргументы φ-функций с неисполнимых рёбер не учитываются. Значения
+// версии 0 — нули: память интерпретатора обнулена. Затем чтения констант заменяются
+// литералами, определения констант — LOAD_IMM, переходы по известному условию —
+// безусловными, неисполнимые блоки отсоединяются от графа
+void IROptimizer::sparseConditionalConstantPass(ControlFlowGraph& cfg, SSAForm& ssa, PackedIR& code) {
+    constexpr uint32_t NO_BLOCK = ControlFlowGraph::NO_BLOCK;
+    const uint32_t block_count = (uint32_t)cfg.blockCount();
+    const uint32_t value_count = (uint32_t)ssa.valueCount();
 
-    // Сбор используемых меток из переходов
-    for (const auto& instr : code) {
-        if (instr.op == IROpCode::JMP || instr.op == IROpCode::JMP_IF_ZERO) {
-            const Operand& label_op = (instr.op == IROpCode::JMP) ? instr.arg1 : instr.arg2;
-            if (label_op.type == OperandType::LABEL) {
-                used_labels.insert(label_op.name);
+    std::pmr::vector<LatticeValue> lattice(value_count);
+    for (uint32_t v = 0; v < value_count; ++v) {
+        if (ssa.value(v).version == 0) {
+            lattice[v] = LatticeValue{LatticeValue::CONSTANT, 0};
+        }
+    }
+
+    // Рёбра нумеруются по позиции в списке предшественников приёмника
+    std::pmr::vector<uint32_t> edge_base(block_count + 1, 0);
+    for (uint32_t b = 0; b < block_count; ++b) {
+        edge_base[b + 1] = edge_base[b] + (uint32_t)cfg.predecessors(b).size();
+    }
+    std::pmr::vector<uint8_t> edge_executable(edge_base[block_count], 0);
+    std::pmr::vector<uint8_t> executable(block_count, 0);
+
+    // Места чтения значений: инструкция, φ-функция (PHI_SITE | номер) или переход блока
+    constexpr uint32_t PHI_SITE = 0x80000000u;
+    constexpr uint32_t BRANCH_SITE = UINT32_MAX;
+    struct Site {
+        uint32_t block;
+        uint32_t index;
+    };
+    auto forEachSite = [&](auto&& f) {
+        for (uint32_t b : cfg.reversePostorder()) {
+            const BasicBlock& block = cfg.block(b);
+            for (uint32_t k = 0; k < block.phis.size(); ++k) {
+                for (const PhiOperand& arg : block.phis[k].args) {
+                    if (arg.kind == PackedKind::SLOT) {
+                        f(arg.value, Site{b, PHI_SITE | k});
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < block.code.size(); ++i) {
+                for (int field : {P::ARG1, P::ARG2}) {
+                    if (block.code[i].kind(field) == PackedKind::SLOT) {
+                        f(block.code[i].operand(field), Site{b, i});
+                    }
+                }
+            }
+            if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+                f(block.branch.operand(P::ARG1), Site{b, BRANCH_SITE});
             }
         }
+    };
+    std::pmr::vector<uint32_t> use_offsets(value_count + 1, 0);
+    forEachSite([&](uint32_t value, Site) { ++use_offsets[value + 1]; });
+    for (uint32_t v = 0; v < value_count; ++v) {
+        use_offsets[v + 1] += use_offsets[v];
+    }
+    std::pmr::vector<Site> uses(use_offsets[value_count]);
+    {
+        std::pmr::vector<uint32_t> fill(use_offsets.begin(), use_offsets.end() - 1);
+        forEachSite([&](uint32_t value, Site site) { uses[fill[value]++] = site; });
     }
 
-    // Создание нового кода без неиспользуемых меток
-    IRCode new_code;
-    for (const auto& instr : code) {
-        if (instr.op == IROpCode::LABEL) {
-            if (used_labels.count(instr.arg1.name) == 0) {
-                std::cout << "[CFlow] Removed unused label: " << instr.arg1.name << " at index " << instr.index << ".\n";
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> flow_worklist;
+    std::pmr::vector<uint32_t> value_worklist;
+
+    auto operandValue = [&](PackedKind kind, uint32_t operand) {
+        return kind == PackedKind::CONST ? LatticeValue{LatticeValue::CONSTANT, code.constant(operand)} : lattice[operand];
+    };
+    auto lower = [&](uint32_t v, LatticeValue next) {
+        const LatticeValue merged = meet(lattice[v], next);
+        if (merged.state != lattice[v].state) {
+            lattice[v] = merged;
+            value_worklist.push_back(v);
+        }
+    };
+    auto visitInstruction = [&](const PackedInstruction& instr) {
+        if (instr.kind(P::RESULT) != PackedKind::SLOT) {
+            return;
+        }
+        const uint32_t result = instr.operand(P::RESULT);
+        if (instr.op == IROpCode::ASSIGN || instr.op == IROpCode::LOAD_IMM) {
+            lower(result, operandValue(instr.kind(P::ARG1), instr.operand(P::ARG1)));
+            return;
+        }
+        if (!isBinaryOp(instr.op)) {
+            lower(result, LatticeValue{LatticeValue::OVERDEFINED, 0});
+            return;
+        }
+        const LatticeValue a = operandValue(instr.kind(P::ARG1), instr.operand(P::ARG1));
+        const LatticeValue b = operandValue(instr.kind(P::ARG2), instr.operand(P::ARG2));
+        if (a.state == LatticeValue::OVERDEFINED || b.state == LatticeValue::OVERDEFINED) {
+            lower(result, LatticeValue{LatticeValue::OVERDEFINED, 0});
+        } else if (a.state == LatticeValue::CONSTANT && b.state == LatticeValue::CONSTANT) {
+            try {
+                lower(result, LatticeValue{LatticeValue::CONSTANT, evaluateConstant(instr.op, a.constant, b.constant)});
+            } catch (const std::runtime_error&) {
+                // Деление на ноль остаётся в коде и выполняется (с ошибкой) как раньше
+                lower(result, LatticeValue{LatticeValue::OVERDEFINED, 0});
+            }
+        }
+    };
+    auto visitPhi = [&](uint32_t b, const PhiNode& phi) {
+        LatticeValue merged;
+        for (size_t i = 0; i < phi.args.size(); ++i) {
+            if (edge_executable[edge_base[b] + i]) {
+                merged = meet(merged, operandValue(phi.args[i].kind, phi.args[i].value));
+            }
+        }
+        lower(phi.result, merged);
+    };
+    auto visitBranch = [&](uint32_t b) {
+        const BasicBlock& block = cfg.block(b);
+        if (!block.isConditional()) {
+            if (block.next != NO_BLOCK) {
+                flow_worklist.emplace_back(b, block.next);
+            }
+            return;
+        }
+        const LatticeValue condition = operandValue(block.branch.kind(P::ARG1), block.branch.operand(P::ARG1));
+        const bool overdefined = condition.state == LatticeValue::OVERDEFINED;
+        if (overdefined || (condition.state == LatticeValue::CONSTANT && condition.constant != 0)) {
+            flow_worklist.emplace_back(b, block.next);
+        }
+        if (overdefined || (condition.state == LatticeValue::CONSTANT && condition.constant == 0)) {
+            flow_worklist.emplace_back(b, block.target);
+        }
+    };
+    auto visitBlock = [&](uint32_t b) {
+        const BasicBlock& block = cfg.block(b);
+        for (const PhiNode& phi : block.phis) {
+            visitPhi(b, phi);
+        }
+        for (const PackedInstruction& instr : block.code) {
+            visitInstruction(instr);
+        }
+        visitBranch(b);
+    };
+
+    executable[cfg.entry()] = 1;
+    visitBlock(cfg.entry());
+    while (!flow_worklist.empty() || !value_worklist.empty()) {
+        while (!flow_worklist.empty()) {
+            const auto [from, to] = flow_worklist.back();
+            flow_worklist.pop_back();
+            const auto preds = cfg.predecessors(to);
+            bool fresh = false;
+            for (size_t i = 0; i < preds.size(); ++i) {
+                if (preds[i] == from && !edge_executable[edge_base[to] + i]) {
+                    edge_executable[edge_base[to] + i] = 1;
+                    fresh = true;
+                }
+            }
+            if (!fresh) {
                 continue;
             }
+            if (!executable[to]) {
+                executable[to] = 1;
+                visitBlock(to);
+            } else {
+                for (const PhiNode& phi : cfg.block(to).phis) {
+                    visitPhi(to, phi);
+                }
+            }
+        }
+        if (!value_worklist.empty()) {
+            const uint32_t v = value_worklist.back();
+            value_worklist.pop_back();
+            for (uint32_t i = use_offsets[v]; i < use_offsets[v + 1]; ++i) {
+                const Site site = uses[i];
+                if (!executable[site.block]) {
+                    continue;
+                }
+                const BasicBlock& block = cfg.block(site.block);
+                if (site.index == BRANCH_SITE) {
+                    visitBranch(site.block);
+                } else if (site.index & PHI_SITE) {
+                    visitPhi(site.block, block.phis[site.index & ~PHI_SITE]);
+                } else {
+                    visitInstruction(block.code[site.index]);
+                }
+            }
         }
-        new_code.push_back(instr);
     }
 
-    code = move(new_code);
-}
\ No newline at end of file
+    // Перезапись: константы в исполнимых блоках, свёртка переходов, отсоединение
+    // неисполнимых блоков (они уходят прямо в выход и при линеаризации пропускаются)
+    size_t constant_values = 0;
+    size_t replaced_uses = 0;
+    size_t folded_branches = 0;
+    size_t removed_blocks = 0;
+    auto isConstant = [&](uint32_t v) { return lattice[v].state == LatticeValue::CONSTANT; };
+    auto readByPhi = [&](uint32_t v) {
+        for (uint32_t i = use_offsets[v]; i < use_offsets[v + 1]; ++i) {
+            if ((uses[i].index & PHI_SITE) && uses[i].index != BRANCH_SITE && executable[uses[i].block]) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (uint32_t b = 0; b < block_count; ++b) {
+        BasicBlock& block = cfg.block(b);
+        if (!executable[b]) {
+            if (b == cfg.exit()) {
+                continue;
+            }
+            removed_blocks += cfg.reachable(b);
+            block.code.clear();
+            block.phis.clear();
+            block.branch = PackedInstruction();
+            block.branch.op = IROpCode::JMP;
+            block.next = cfg.exit();
+            block.target = NO_BLOCK;
+            continue;
+        }
+
+        // Аргументы оставшихся φ-функций не заменяются: копия значения сливается с его
+        // определением, а загрузка литерала на ребре осталась бы лишней инструкцией.
+        // Поэтому константная φ-функция, которую читает другая φ-функция, остаётся
+        const size_t phi_count = block.phis.size();
+        std::erase_if(block.phis, [&](const PhiNode& phi) { return isConstant(phi.result) && !readByPhi(phi.result); });
+        constant_values += phi_count - block.phis.size();
+        for (PackedInstruction& instr : block.code) {
+            if (instr.kind(P::RESULT) == PackedKind::SLOT && isConstant(instr.operand(P::RESULT))) {
+                if (instr.op != IROpCode::LOAD_IMM) {
+                    instr.op = IROpCode::LOAD_IMM;
+                    instr.set(P::ARG1, PackedKind::CONST, code.addConstant(lattice[instr.operand(P::RESULT)].constant));
+                    instr.clear(P::ARG2);
+                    ++constant_values;
+                }
+                continue;
+            }
+            for (int field : {P::ARG1, P::ARG2}) {
+                if (instr.kind(field) == PackedKind::SLOT && isConstant(instr.operand(field))) {
+                    instr.set(field, PackedKind::CONST, code.addConstant(lattice[instr.operand(field)].constant));
+                    ++replaced_uses;
+                }
+            }
+        }
+        if (block.isConditional()) {
+            const LatticeValue condition = operandValue(block.branch.kind(P::ARG1), block.branch.operand(P::ARG1));
+            if (condition.state == LatticeValue::CONSTANT) {
+                if (condition.constant == 0) {
+                    block.next = block.target;
+                }
+                block.branch = PackedInstruction();
+                block.branch.op = IROpCode::JMP;
+                block.target = NO_BLOCK;
+                ++folded_branches;
+            }
+        }
+    }
+
+    removeDeletedEdges(cfg);
+
+    std::cout << "[SCCP] " << constant_values << " constant values, " << replaced_uses << " uses replaced, "
+              << folded_branches << " branches folded, " << removed_blocks << " unreachable blocks removed.\n";
+}
+
+// Глобальная нумерация значений на SSA-форме: обход дерева доминаторов с областями
+// видимости хеш-таблицы. Выражение ищется по операции и номерам значений операндов;
+// у коммутативных операций (ADD, MUL, CMP_EQ, CMP_NE) операнды упорядочиваются,
+// CMP_GT b, a приводится к CMP_LT a, b. Найденное выражение вычислено в блоке-доминаторе
+// (или выше в том же блоке), поэтому инструкция становится копией его результата, а
+// копии убирает распространение копий. В SSA значение не переприсваивается, и запись
+// таблицы живёт, пока обход не покинет поддерево блока, где она появилась. Повторное
+// деление тоже заменяется: если бы делитель был нулём, упало бы первое
+void IROptimizer::globalValueNumberingPass(ControlFlowGraph& cfg, SSAForm& ssa) {
+    const uint32_t value_count = (uint32_t)ssa.valueCount();
+    std::pmr::vector<uint32_t> number(value_count);
+    for (uint32_t v = 0; v < value_count; ++v) {
+        number[v] = v;
+    }
+    std::pmr::unordered_map<ValueKey, uint32_t, ValueKeyHash> table;
+    struct Scope {
+        uint32_t block;
+        size_t undo_size;
+        bool entered;
+    };
+    std::pmr::vector<Scope> stack;
+    std::pmr::vector<ValueKey> undo;
+    std::pmr::vector<uint32_t> def_block(value_count, ControlFlowGraph::NO_BLOCK);
+
+    size_t local_hits = 0;
+    size_t global_hits = 0;
+    stack.push_back(Scope{cfg.entry(), 0, false});
+    while (!stack.empty()) {
+        Scope& scope = stack.back();
+        if (scope.entered) {
+            while (undo.size() > scope.undo_size) {
+                table.erase(undo.back());
+                undo.pop_back();
+            }
+            stack.pop_back();
+            continue;
+        }
+        scope.entered = true;
+        scope.undo_size = undo.size();
+        const uint32_t b = scope.block;
+
+        for (PackedInstruction& instr : cfg.block(b).code) {
+            if (instr.kind(P::RESULT) != PackedKind::SLOT) {
+                continue;
+            }
+            const uint32_t result = instr.operand(P::RESULT);
+            def_block[result] = b;
+            if (instr.op == IROpCode::ASSIGN && instr.kind(P::ARG1) == PackedKind::SLOT) {
+                number[result] = number[instr.operand(P::ARG1)];
+                continue;
+            }
+            if (!isBinaryOp(instr.op)) {
+                continue;
+            }
+            auto operand = [&](int field) {
+                const uint32_t value = instr.operand(field);
+                return std::pair<uint8_t, uint32_t>((uint8_t)instr.kind(field),
+                                                    instr.kind(field) == PackedKind::SLOT ? number[value] : value);
+            };
+            IROpCode op = instr.op;
+            std::pair<uint8_t, uint32_t> a = operand(P::ARG1);
+            std::pair<uint8_t, uint32_t> c = operand(P::ARG2);
+            if (op == IROpCode::CMP_GT) {
+                op = IROpCode::CMP_LT;
+                std::swap(a, c);
+            } else if (isCommutative(op) && c < a) {
+                std::swap(a, c);
+            }
+            const ValueKey key{op, (uint8_t)(a.first << 2 | c.first << 4), a.second, c.second};
+            const auto [it, inserted] = table.try_emplace(key, result);
+            if (inserted) {
+                undo.push_back(key);
+                continue;
+            }
+            (def_block[it->second] == b ? local_hits : global_hits) += 1;
+            number[result] = number[it->second];
+            instr.op = IROpCode::ASSIGN;
+            instr.set(P::ARG1, PackedKind::SLOT, it->second);
+            instr.clear(P::ARG2);
+        }
+
+        const auto children = cfg.dominatorChildren(b);
+        for (auto child = children.rbegin(); child != children.rend(); ++child) {
+            stack.push_back(Scope{*child, 0, false});
+        }
+    }
+
+    std::cout << "[GVN] " << local_hits + global_hits << " redundant expressions replaced (" << local_hits
+              << " within a block, " << global_hits << " across dominators).\n";
+}
+
+// Распространение копий на SSA-форме: чтения результата копии x = y заменяются чтениями
+// y, и копия удаляется. Так ASSIGN var, Tn после вычисления выражения исчезает: выражение
+// пишет прямо в слот, который выход из SSA назначит общему классу Tn и var. φ-функция,
+// все аргументы которой (кроме неё самой) — одно значение y, тоже копия y: y доминирует
+// над её блоком. Определение доминирует над чтениями, поэтому замена корректна всюду
+void IROptimizer::copyPropagationPass(ControlFlowGraph& cfg, SSAForm& ssa) {
+    const uint32_t value_count = (uint32_t)ssa.valueCount();
+    std::pmr::vector<uint32_t> forward(value_count);
+    for (uint32_t v = 0; v < value_count; ++v) {
+        forward[v] = v;
+    }
+    auto resolve = [&forward](uint32_t v) {
+        while (forward[v] != v) {
+            forward[v] = forward[forward[v]];
+            v = forward[v];
+        }
+        return v;
+    };
+
+    size_t copies = 0;
+    for (uint32_t b : cfg.reversePostorder()) {
+        for (const PackedInstruction& instr : cfg.block(b).code) {
+            if (instr.op == IROpCode::ASSIGN && instr.kind(P::ARG1) == PackedKind::SLOT) {
+                forward[instr.operand(P::RESULT)] = instr.operand(P::ARG1);
+                ++copies;
+            }
+        }
+    }
+
+    // Тривиальные φ-функции: проходы до неподвижной точки (удаление одной может сделать
+    // тривиальной другую)
+    size_t trivial_phis = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t b : cfg.reversePostorder()) {
+            for (const PhiNode& phi : cfg.block(b).phis) {
+                if (forward[phi.result] != phi.result) {
+                    continue;
+                }
+                uint32_t same = SSAForm::NO_VALUE;
+                bool trivial = true;
+                for (const PhiOperand& arg : phi.args) {
+                    const uint32_t value = arg.kind == PackedKind::SLOT ? resolve(arg.value) : SSAForm::NO_VALUE;
+                    if (value == phi.result) {
+                        continue;
+                    }
+                    if (value == SSAForm::NO_VALUE || (same != SSAForm::NO_VALUE && value != same)) {
+                        trivial = false;
+                        break;
+                    }
+                    same = value;
+                }
+                if (trivial && same != SSAForm::NO_VALUE) {
+                    forward[phi.result] = same;
+                    ++trivial_phis;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    for (uint32_t b : cfg.reversePostorder()) {
+        BasicBlock& block = cfg.block(b);
+        std::erase_if(block.phis, [&](const PhiNode& phi) { return forward[phi.result] != phi.result; });
+        for (PhiNode& phi : block.phis) {
+            for (PhiOperand& arg : phi.args) {
+                if (arg.kind == PackedKind::SLOT) {
+                    arg.value = resolve(arg.value);
+                }
+            }
+        }
+        std::erase_if(block.code, [](const PackedInstruction& instr) {
+            return instr.op == IROpCode::ASSIGN && instr.kind(P::ARG1) == PackedKind::SLOT;
+        });
+        for (PackedInstruction& instr : block.code) {
+            for (int field : {P::ARG1, P::ARG2}) {
+                if (instr.kind(field) == PackedKind::SLOT) {
+                    instr.operands[field] = resolve(instr.operand(field));
+                }
+            }
+        }
+        if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+            block.branch.operands[P::ARG1] = resolve(block.branch.operand(P::ARG1));
+        }
+    }
+
+    std::cout << "[COPY] " << copies << " copies propagated, " << trivial_phis << " trivial PHI nodes removed.\n";
+}
+
+// Удаление мёртвого кода на SSA-форме: значение живо, если его читает PRINT, условие
+// перехода, деление, которое может упасть (делитель не ненулевой литерал), или живая
+// инструкция либо φ-функция. Живые значения размечаются от этих корней по цепочкам
+// определений, остальные инструкции и φ-функции удаляются. Это касается и временных, и
+// присваиваний переменным, которые дальше не читаются. Код недостижимых блоков
+// очищается, условный переход с одинаковыми преемниками становится безусловным; после
+// этого его условие может умереть, поэтому проход повторяется до неподвижной точки
+void IROptimizer::deadCodeEliminationPass(ControlFlowGraph& cfg, SSAForm& ssa, const PackedIR& code) {
+    constexpr uint32_t NONE = UINT32_MAX;
+    constexpr uint32_t PHI_SITE = 0x80000000u;
+    const uint32_t block_count = (uint32_t)cfg.blockCount();
+    const uint32_t value_count = (uint32_t)ssa.valueCount();
+    auto mayTrap = [&code](const PackedInstruction& instr) {
+        return instr.op == IROpCode::DIV &&
+               (instr.kind(P::ARG2) != PackedKind::CONST || code.constant(instr.operand(P::ARG2)) == 0);
+    };
+    auto hasEffect = [&](const PackedInstruction& instr) {
+        return instr.kind(P::RESULT) != PackedKind::SLOT || mayTrap(instr);
+    };
+
+    std::pmr::vector<uint32_t> def_block(value_count);
+    std::pmr::vector<uint32_t> def_index(value_count);
+    std::pmr::vector<uint8_t> live(value_count);
+    std::pmr::vector<uint32_t> worklist;
+    size_t removed_instructions = 0;
+    size_t removed_phis = 0;
+    size_t cleared_blocks = 0;
+    size_t simplified_branches = 0;
+    size_t rounds = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        ++rounds;
+
+        // Недостижимые блоки: тело и φ-функции больше не нужны, выход ведёт прямо в конец
+        bool detached = false;
+        for (uint32_t b = 0; b < block_count; ++b) {
+            BasicBlock& block = cfg.block(b);
+            if (cfg.reachable(b) || b == cfg.exit() || (block.code.empty() && block.phis.empty() && !block.isConditional())) {
+                continue;
+            }
+            block.code.clear();
+            block.phis.clear();
+            block.branch = PackedInstruction();
+            block.branch.op = IROpCode::JMP;
+            block.next = cfg.exit();
+            block.target = ControlFlowGraph::NO_BLOCK;
+            ++cleared_blocks;
+            detached = true;
+        }
+        if (detached) {
+            removeDeletedEdges(cfg);
+        }
+
+        std::fill(def_block.begin(), def_block.end(), NONE);
+        std::fill(live.begin(), live.end(), 0);
+        worklist.clear();
+        auto markLive = [&](PackedKind kind, uint32_t value) {
+            if (kind == PackedKind::SLOT && !live[value]) {
+                live[value] = 1;
+                worklist.push_back(value);
+            }
+        };
+        for (uint32_t b : cfg.reversePostorder()) {
+            const BasicBlock& block = cfg.block(b);
+            for (uint32_t k = 0; k < block.phis.size(); ++k) {
+                def_block[block.phis[k].result] = b;
+                def_index[block.phis[k].result] = PHI_SITE | k;
+            }
+            for (uint32_t i = 0; i < block.code.size(); ++i) {
+                const PackedInstruction& instr = block.code[i];
+                if (instr.kind(P::RESULT) == PackedKind::SLOT) {
+                    def_block[instr.operand(P::RESULT)] = b;
+                    def_index[instr.operand(P::RESULT)] = i;
+                }
+                if (hasEffect(instr)) {
+                    markLive(instr.kind(P::ARG1), instr.operand(P::ARG1));
+                    markLive(instr.kind(P::ARG2), instr.operand(P::ARG2));
+                }
+            }
+            if (block.isConditional()) {
+                markLive(block.branch.kind(P::ARG1), block.branch.operand(P::ARG1));
+            }
+        }
+        while (!worklist.empty()) {
+            const uint32_t v = worklist.back();
+            worklist.pop_back();
+            if (def_block[v] == NONE) {
+                continue;
+            }
+            const BasicBlock& block = cfg.block(def_block[v]);
+            if (def_index[v] & PHI_SITE) {
+                for (const PhiOperand& arg : block.phis[def_index[v] & ~PHI_SITE].args) {
+                    markLive(arg.kind, arg.value);
+                }
+            } else {
+                const PackedInstruction& instr = block.code[def_index[v]];
+                markLive(instr.kind(P::ARG1), instr.operand(P::ARG1));
+                markLive(instr.kind(P::ARG2), instr.operand(P::ARG2));
+            }
+        }
+
+        for (uint32_t b : cfg.reversePostorder()) {
+            BasicBlock& block = cfg.block(b);
+            const size_t phi_count = block.phis.size();
+            std::erase_if(block.phis, [&](const PhiNode& phi) { return !live[phi.result]; });
+            removed_phis += phi_count - block.phis.size();
+            const size_t instruction_count = block.code.size();
+            std::erase_if(block.code, [&](const PackedInstruction& instr) {
+                return !hasEffect(instr) && !live[instr.operand(P::RESULT)];
+            });
+            removed_instructions += instruction_count - block.code.size();
+        }
+
+        // Переход с одинаковыми преемниками: условие больше не нужно
+        bool simplified = false;
+        for (uint32_t b : cfg.reversePostorder()) {
+            BasicBlock& block = cfg.block(b);
+            if (block.isConditional() && block.next == block.target) {
+                block.branch = PackedInstruction();
+                block.branch.op = IROpCode::JMP;
+                block.target = ControlFlowGraph::NO_BLOCK;
+                ++simplified_branches;
+                simplified = true;
+            }
+        }
+        if (simplified) {
+            removeDeletedEdges(cfg);
+            changed = true;
+        }
+    }
+
+    std::cout << "[DCE] " << removed_instructions << " instructions and " << removed_phis << " PHI nodes removed, "
+              << simplified_branches << " branches simplified, " << cleared_blocks << " unreachable blocks cleared ("
+              << rounds << " rounds).\n";
+}
+
+// Вынос инвариантов циклов на SSA-форме. Инструкция инвариантна в цикле, если каждый
+// её операнд — литерал или значение, определённое вне цикла (в SSA значение не
+// переопределяется, так что это и значит «не меняется в цикле»), в том числе уже
+// вынесенной инструкцией. Инвариантная инструкция переносится в конец предзаголовка;
+// недостающие предзаголовки создаются заранее, одним проходом по графу. Циклы
+// обрабатываются от внутренних к внешним, поэтому вынесенное из внутреннего цикла
+// может уйти и дальше. Перенос выполняет вычисление и тогда, когда тело не выполнится
+// ни разу, поэтому DIV переносится, только если делитель — ненулевой литерал
+void IROptimizer::loopInvariantCodeMotionPass(ControlFlowGraph& cfg, SSAForm& ssa, const PackedIR& code) {
+    constexpr uint32_t NO_BLOCK = ControlFlowGraph::NO_BLOCK;
+    constexpr uint32_t NO_LOOP = ControlFlowGraph::NO_LOOP;
+    const size_t created = cfg.ensurePreheaders();
+    const uint32_t value_count = (uint32_t)ssa.valueCount();
+    const auto& loops = cfg.loops();
+    const uint32_t loop_count = (uint32_t)loops.size();
+
+    // Нумерация дерева циклов: цикл m лежит в l, если его номера входа и выхода внутри l.
+    // Объемлющий цикл создаётся позже вложенного, поэтому дети собираются обратным проходом
+    std::pmr::vector<uint32_t> child_offsets(loop_count + 2, 0);
+    for (const Loop& loop : loops) {
+        ++child_offsets[(loop.parent == NO_LOOP ? loop_count : loop.parent) + 1];
+    }
+    for (uint32_t l = 0; l <= loop_count; ++l) {
+        child_offsets[l + 1] += child_offsets[l];
+    }
+    std::pmr::vector<uint32_t> children(loop_count);
+    {
+        std::pmr::vector<uint32_t> fill(child_offsets.begin(), child_offsets.end() - 1);
+        for (uint32_t l = 0; l < loop_count; ++l) {
+            children[fill[loops[l].parent == NO_LOOP ? loop_count : loops[l].parent]++] = l;
+        }
+    }
+    std::pmr::vector<uint32_t> pre(loop_count + 1, 0);
+    std::pmr::vector<uint32_t> post(loop_count + 1, 0);
+    {
+        uint32_t counter = 0;
+        std::pmr::vector<std::pair<uint32_t, uint32_t>> stack{{loop_count, child_offsets[loop_count]}};
+        pre[loop_count] = counter++;
+        while (!stack.empty()) {
+            auto& [l, next] = stack.back();
+            if (next == child_offsets[l + 1]) {
+                post[l] = counter++;
+                stack.pop_back();
+                continue;
+            }
+            const uint32_t child = children[next++];
+            pre[child] = counter++;
+            stack.emplace_back(child, child_offsets[child]);
+        }
+    }
+    auto inLoop = [&](uint32_t b, uint32_t l) {
+        const uint32_t m = cfg.loopOf(b);
+        return m != NO_LOOP && pre[l] <= pre[m] && post[m] <= post[l];
+    };
+
+    // Блоки по самому внутреннему циклу в обратном постпорядке и места определений
+    std::pmr::vector<uint32_t> bucket_offsets(loop_count + 1, 0);
+    std::pmr::vector<uint32_t> def_block(value_count, NO_BLOCK);
+    for (uint32_t b : cfg.reversePostorder()) {
+        if (cfg.loopOf(b) != NO_LOOP) {
+            ++bucket_offsets[cfg.loopOf(b) + 1];
+        }
+        const BasicBlock& block = cfg.block(b);
+        for (const PhiNode& phi : block.phis) {
+            def_block[phi.result] = b;
+        }
+        for (const PackedInstruction& instr : block.code) {
+            if (instr.kind(P::RESULT) == PackedKind::SLOT) {
+                def_block[instr.operand(P::RESULT)] = b;
+            }
+        }
+    }
+    for (uint32_t l = 0; l < loop_count; ++l) {
+        bucket_offsets[l + 1] += bucket_offsets[l];
+    }
+    std::pmr::vector<uint32_t> buckets(bucket_offsets[loop_count]);
+    {
+        std::pmr::vector<uint32_t> fill(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (uint32_t b : cfg.reversePostorder()) {
+            if (cfg.loopOf(b) != NO_LOOP) {
+                buckets[fill[cfg.loopOf(b)]++] = b;
+            }
+        }
+    }
+
+    auto hoistable = [&code](const PackedInstruction& instr) {
+        return instr.op != IROpCode::DIV ||
+               (instr.kind(P::ARG2) == PackedKind::CONST && code.constant(instr.operand(P::ARG2)) != 0);
+    };
+    size_t hoisted = 0;
+    size_t kept_divisions = 0;
+    for (uint32_t l = 0; l < loop_count; ++l) {
+        const uint32_t preheader = loops[l].preheader;
+        if (preheader == NO_BLOCK) {
+            continue;
+        }
+        auto invariant = [&](const PackedInstruction& instr) {
+            for (int field : {P::ARG1, P::ARG2}) {
+                if (instr.kind(field) == PackedKind::SLOT) {
+                    const uint32_t b = def_block[instr.operand(field)];
+                    if (b != NO_BLOCK && inLoop(b, l)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+        std::pmr::vector<PackedInstruction>& target = cfg.block(preheader).code;
+        for (uint32_t i = bucket_offsets[l]; i < bucket_offsets[l + 1]; ++i) {
+            const uint32_t b = buckets[i];
+            std::erase_if(cfg.block(b).code, [&](const PackedInstruction& instr) {
+                if (!isBinaryOp(instr.op) || !invariant(instr)) {
+                    return false;
+                }
+                if (!hoistable(instr)) {
+                    ++kept_divisions;
+                    return false;
+                }
+                target.push_back(instr);
+                def_block[instr.operand(P::RESULT)] = preheader;
+                ++hoisted;
+                return true;
+            });
+        }
+    }
+
+    std::cout << "[LICM] " << hoisted << " invariant instructions hoisted, " << kept_divisions
+              << " divisions kept in place, " << created << " preheaders created.\n";
+}
+
+// Понижение силы операций над индуктивными переменными на SSA-форме.
+// Базовая индуктивная переменная цикла — φ-функция заголовка i = φ(i0, i + c): значение
+// из предзаголовка и приращение на единственном обратном ребре, где шаг c — литерал
+// или значение, определённое до цикла (для SUB — только литерал). Производные —
+// t = i ± d и u = (i ± d) * k или i * k с d и k, известными до цикла. Для каждого
+// произведения заводится новая переменная s = φ((i0 ± d) * k, s + c * k): начальное
+// значение и шаг считаются в предзаголовке (или сворачиваются), сложение ставится в
+// конец обратного ребра, а u заменяется на s. Значения i и s меняются вместе при каждом
+// входе в заголовок, поэтому равенство верно всюду, где читается i, в том числе после
+// цикла; арифметика по модулю 2^32 сохраняет его и при переполнении.
+// Замена проверки выхода (LFTR): условие заголовка i < n (или i > n) с литералом n
+// переписывается в s < n * k для s = i * k, если k > 0, i0 и c — литералы, i движется
+// к границе и ни одно значение i * k от i0 до выхода не переполняется. После этого
+// базовая переменная, которую читает только её приращение, удаляется вместе с ним
+void IROptimizer::inductionVariablePass(ControlFlowGraph& cfg, SSAForm& ssa, PackedIR& code) {
+    constexpr uint32_t NONE = UINT32_MAX;
+    constexpr uint32_t NO_BLOCK = ControlFlowGraph::NO_BLOCK;
+    const uint32_t block_count = (uint32_t)cfg.blockCount();
+    const uint32_t value_count = (uint32_t)ssa.valueCount();
+
+    // Места определений: у инструкции — блок и номер, у φ-функции — только блок
+    std::pmr::vector<uint32_t> def_block(value_count, NO_BLOCK);
+    std::pmr::vector<uint32_t> def_index(value_count, NONE);
+    for (uint32_t b : cfg.reversePostorder()) {
+        const BasicBlock& block = cfg.block(b);
+        for (const PhiNode& phi : block.phis) {
+            def_block[phi.result] = b;
+        }
+        for (uint32_t i = 0; i < block.code.size(); ++i) {
+            if (block.code[i].kind(P::RESULT) == PackedKind::SLOT) {
+                def_block[block.code[i].operand(P::RESULT)] = b;
+                def_index[block.code[i].operand(P::RESULT)] = i;
+            }
+        }
+    }
+    // Операнд известен до цикла, если он литерал или его определение доминирует над
+    // предзаголовком (значения версии 0 определены на входе в программу)
+    auto availableBefore = [&](PackedKind kind, uint32_t value, uint32_t preheader) {
+        if (kind == PackedKind::CONST) {
+            return true;
+        }
+        return kind == PackedKind::SLOT &&
+               (def_block[value] == NO_BLOCK || cfg.dominates(def_block[value], preheader));
+    };
+
+    // 1. Базовые индуктивные переменные
+    struct BasicVariable {
+        uint32_t header;
+        uint32_t preheader;
+        uint32_t latch;
+        uint32_t phi;         // Значение φ-функции
+        uint32_t next;        // Значение приращения
+        PhiOperand init;
+        PhiOperand step;      // Для SUB литерал шага уже взят с обратным знаком
+        int factor = 0;       // Первая производная с литералом k > 0 (для LFTR)
+        uint32_t scaled = NONE;
+    };
+    std::pmr::vector<BasicVariable> basics;
+    std::pmr::vector<uint32_t> basic_of(value_count, NONE);
+    auto basicOf = [&](PackedKind kind, uint32_t value) {
+        return kind == PackedKind::SLOT && value < value_count ? basic_of[value] : NONE;
+    };
+    for (const Loop& loop : cfg.loops()) {
+        if (loop.preheader == NO_BLOCK) {
+            continue;
+        }
+        const auto preds = cfg.predecessors(loop.header);
+        if (preds.size() != 2 || preds[0] == preds[1]) {
+            continue;
+        }
+        const size_t entry_arg = preds[0] == loop.preheader ? 0 : 1;
+        const uint32_t latch = preds[1 - entry_arg];
+        for (const PhiNode& phi : cfg.block(loop.header).phis) {
+            const PhiOperand& back = phi.args[1 - entry_arg];
+            if (back.kind != PackedKind::SLOT || def_index[back.value] == NONE) {
+                continue;
+            }
+            const PackedInstruction& instr = cfg.block(def_block[back.value]).code[def_index[back.value]];
+            const bool add = instr.op == IROpCode::ADD;
+            if (!add && instr.op != IROpCode::SUB) {
+                continue;
+            }
+            // Операнд шага: другой операнд сложения или вычитаемое
+            int field = -1;
+            if (instr.kind(P::ARG1) == PackedKind::SLOT && instr.operand(P::ARG1) == phi.result) {
+                field = P::ARG2;
+            } else if (add && instr.kind(P::ARG2) == PackedKind::SLOT && instr.operand(P::ARG2) == phi.result) {
+                field = P::ARG1;
+            }
+            if (field < 0 || !availableBefore(instr.kind(field), instr.operand(field), loop.preheader)) {
+                continue;
+            }
+            PhiOperand step{instr.kind(field), instr.operand(field)};
+            if (!add) {
+                const int value = step.kind == PackedKind::CONST ? code.constant(step.value) : INT_MIN;
+                if (value == INT_MIN) {
+                    continue;
+                }
+                step.value = code.addConstant(-value);
+            }
+            // Начальное значение из загрузки литерала само считается литералом
+            PhiOperand init = phi.args[entry_arg];
+            if (init.kind == PackedKind::SLOT && def_index[init.value] != NONE) {
+                const PackedInstruction& load = cfg.block(def_block[init.value]).code[def_index[init.value]];
+                if ((load.op == IROpCode::LOAD_IMM || load.op == IROpCode::ASSIGN) && load.kind(P::ARG1) == PackedKind::CONST) {
+                    init = PhiOperand{PackedKind::CONST, load.operand(P::ARG1)};
+                }
+            }
+            basic_of[phi.result] = (uint32_t)basics.size();
+            basics.push_back(BasicVariable{loop.header, loop.preheader, latch, phi.result, back.value, init, step});
+        }
+    }
+
+    // 2. Производные: t = i + d или t = i - d с d, известным до цикла (только
+    // запоминаются), и произведения u = t * k или u = i * k. На каждую тройку (i, d, k)
+    // заводится переменная s = φ((i0 ± d) * k, s + c * k), а u заменяется на s
+    auto constantOperand = [&code](int value) { return PhiOperand{PackedKind::CONST, code.addConstant(value)}; };
+    auto isConstant = [&code](const PhiOperand& operand, int value) {
+        return operand.kind == PackedKind::CONST && code.constant(operand.value) == value;
+    };
+    // a op b в предзаголовке: литералы сворачиваются, нейтральные операнды пропускаются
+    auto emit = [&](IROpCode op, const PhiOperand& a, const PhiOperand& b, uint32_t preheader) -> PhiOperand {
+        if (a.kind == PackedKind::CONST && b.kind == PackedKind::CONST) {
+            return constantOperand(evaluateConstant(op, code.constant(a.value), code.constant(b.value)));
+        }
+        if (op == IROpCode::MUL) {
+            if (isConstant(a, 0) || isConstant(b, 0)) {
+                return constantOperand(0);
+            }
+            if (isConstant(a, 1) || isConstant(b, 1)) {
+                return isConstant(a, 1) ? b : a;
+            }
+        } else if (isConstant(b, 0) || (op == IROpCode::ADD && isConstant(a, 0))) {
+            return isConstant(b, 0) ? a : b;
+        }
+        const uint32_t result = ssa.addTemporary();
+        PackedInstruction instr;
+        instr.op = op;
+        instr.set(P::RESULT, PackedKind::SLOT, result);
+        instr.set(P::ARG1, a.kind, a.value);
+        instr.set(P::ARG2, b.kind, b.value);
+        cfg.block(preheader).code.push_back(instr);
+        return PhiOperand{PackedKind::SLOT, result};
+    };
+
+    // Линейная форма значения: базовая переменная плюс или минус смещение
+    struct Linear {
+        uint32_t basic = NONE;
+        PhiOperand offset{PackedKind::NONE, 0};
+        bool negate = false;
+    };
+    std::pmr::vector<Linear> linear(value_count);
+    for (uint32_t v = 0; v < value_count; ++v) {
+        linear[v].basic = basic_of[v];
+    }
+    auto linearOf = [&](PackedKind kind, uint32_t value) {
+        return kind == PackedKind::SLOT && value < value_count ? linear[value] : Linear{};
+    };
+    auto available = [&](PackedKind kind, uint32_t value, uint32_t preheader) {
+        return (kind != PackedKind::SLOT || value < value_count) && availableBefore(kind, value, preheader);
+    };
+
+    using ScaledKey = std::tuple<uint32_t, uint8_t, uint32_t, bool, uint8_t, uint32_t>;
+    std::pmr::map<ScaledKey, uint32_t> scaled;
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> replaced;   // u -> s
+    // Инструкции читаются по номеру: сложение s может попасть в конец того же блока
+    for (uint32_t b : cfg.reversePostorder()) {
+        for (size_t i = 0; i < cfg.block(b).code.size(); ++i) {
+            const PackedInstruction instr = cfg.block(b).code[i];
+            if (instr.kind(P::RESULT) != PackedKind::SLOT || instr.operand(P::RESULT) >= value_count) {
+                continue;
+            }
+            // t = i ± d (d + i тоже); смещённые значения дальше не сдвигаются
+            if (instr.op == IROpCode::ADD || instr.op == IROpCode::SUB) {
+                for (int field : {P::ARG1, P::ARG2}) {
+                    const int other = field == P::ARG1 ? P::ARG2 : P::ARG1;
+                    const uint32_t index = basicOf(instr.kind(field), instr.operand(field));
+                    if (index != NONE && (instr.op == IROpCode::ADD || field == P::ARG1) &&
+                        available(instr.kind(other), instr.operand(other), basics[index].preheader)) {
+                        linear[instr.operand(P::RESULT)] =
+                            Linear{index, PhiOperand{instr.kind(other), instr.operand(other)}, instr.op == IROpCode::SUB};
+                        break;
+                    }
+                }
+                continue;
+            }
+            if (instr.op != IROpCode::MUL) {
+                continue;
+            }
+            // u = t * k или k * t; у row * col во вложенном цикле базовые оба, подходит col
+            Linear term;
+            PhiOperand k;
+            for (int field : {P::ARG1, P::ARG2}) {
+                const int other = field == P::ARG1 ? P::ARG2 : P::ARG1;
+                const Linear candidate = linearOf(instr.kind(field), instr.operand(field));
+                if (candidate.basic != NONE && available(instr.kind(other), instr.operand(other), basics[candidate.basic].preheader)) {
+                    term = candidate;
+                    k = PhiOperand{instr.kind(other), instr.operand(other)};
+                    break;
+                }
+            }
+            if (term.basic == NONE) {
+                continue;
+            }
+            const ScaledKey key{term.basic, (uint8_t)term.offset.kind, term.offset.value, term.negate, (uint8_t)k.kind, k.value};
+            auto [it, inserted] = scaled.try_emplace(key, NONE);
+            if (inserted) {
+                BasicVariable& basic = basics[term.basic];
+                const uint32_t s = ssa.addTemporary();
+                const uint32_t s_next = ssa.addTemporary();
+                PhiOperand start = basic.init;
+                if (term.offset.kind != PackedKind::NONE) {
+                    start = emit(term.negate ? IROpCode::SUB : IROpCode::ADD, start, term.offset, basic.preheader);
+                }
+                const PhiOperand init = emit(IROpCode::MUL, start, k, basic.preheader);
+                PackedInstruction increment;
+                increment.set(P::RESULT, PackedKind::SLOT, s_next);
+                increment.set(P::ARG1, PackedKind::SLOT, s);
+                if (isConstant(basic.step, -1)) {
+                    increment.op = IROpCode::SUB;
+                    increment.set(P::ARG2, k.kind, k.value);
+                } else {
+                    const PhiOperand step = emit(IROpCode::MUL, basic.step, k, basic.preheader);
+                    increment.op = IROpCode::ADD;
+                    increment.set(P::ARG2, step.kind, step.value);
+                }
+                cfg.block(basic.latch).code.push_back(increment);
+                PhiNode phi{s, {}};
+                phi.args.resize(2);
+                const bool entry_first = cfg.predecessors(basic.header)[0] == basic.preheader;
+                phi.args[entry_first ? 0 : 1] = init;
+                phi.args[entry_first ? 1 : 0] = PhiOperand{PackedKind::SLOT, s_next};
+                cfg.block(basic.header).phis.push_back(std::move(phi));
+                it->second = s;
+                if (term.offset.kind == PackedKind::NONE && k.kind == PackedKind::CONST && code.constant(k.value) > 0 &&
+                    basic.scaled == NONE) {
+                    basic.factor = code.constant(k.value);
+                    basic.scaled = s;
+                }
+            }
+            replaced.emplace_back(instr.operand(P::RESULT), it->second);
+        }
+    }
+
+    // Замещённые умножения удаляются, их чтения переходят на s
+    std::pmr::vector<uint32_t> forward(ssa.valueCount());
+    for (uint32_t v = 0; v < forward.size(); ++v) {
+        forward[v] = v;
+    }
+    for (const auto& [from, to] : replaced) {
+        forward[from] = to;
+    }
+    std::pmr::vector<uint32_t> uses(ssa.valueCount(), 0);
+    auto rewrite = [&](PackedKind kind, uint32_t& value) {
+        if (kind == PackedKind::SLOT) {
+            value = forward[value];
+            ++uses[value];
+        }
+    };
+    for (uint32_t b = 0; b < block_count; ++b) {
+        BasicBlock& block = cfg.block(b);
+        if (!cfg.reachable(b)) {
+            continue;
+        }
+        std::erase_if(block.code, [&](const PackedInstruction& instr) {
+            return instr.kind(P::RESULT) == PackedKind::SLOT && forward[instr.operand(P::RESULT)] != instr.operand(P::RESULT);
+        });
+        for (PhiNode& phi : block.phis) {
+            for (PhiOperand& arg : phi.args) {
+                rewrite(arg.kind, arg.value);
+            }
+        }
+        for (PackedInstruction& instr : block.code) {
+            rewrite(instr.kind(P::ARG1), instr.operands[P::ARG1]);
+            rewrite(instr.kind(P::ARG2), instr.operands[P::ARG2]);
+        }
+        if (block.isConditional()) {
+            rewrite(block.branch.kind(P::ARG1), block.branch.operands[P::ARG1]);
+        }
+    }
+
+    // 3. Замена проверки выхода: условие заголовка, которое читает только переход
+    size_t replaced_tests = 0;
+    for (BasicVariable& basic : basics) {
+        const BasicBlock& header = cfg.block(basic.header);
+        if (basic.scaled == NONE || basic.init.kind != PackedKind::CONST || basic.step.kind != PackedKind::CONST ||
+            !header.isConditional() || header.branch.kind(P::ARG1) != PackedKind::SLOT) {
+            continue;
+        }
+        const uint32_t condition = header.branch.operand(P::ARG1);
+        if (condition >= value_count || def_block[condition] != basic.header || uses[condition] != 1) {
+            continue;
+        }
+        std::pmr::vector<PackedInstruction>& body = cfg.block(basic.header).code;
+        auto found = std::find_if(body.begin(), body.end(), [&](const PackedInstruction& instr) {
+            return instr.kind(P::RESULT) == PackedKind::SLOT && instr.operand(P::RESULT) == condition;
+        });
+        if (found == body.end() || (found->op != IROpCode::CMP_LT && found->op != IROpCode::CMP_GT)) {
+            continue;
+        }
+        PackedInstruction& test = *found;
+        const bool left = test.kind(P::ARG1) == PackedKind::SLOT && test.operand(P::ARG1) == basic.phi;
+        const bool right = test.kind(P::ARG2) == PackedKind::SLOT && test.operand(P::ARG2) == basic.phi;
+        const int bound_field = left ? P::ARG2 : P::ARG1;
+        if (left == right || test.kind(bound_field) != PackedKind::CONST) {
+            continue;
+        }
+        // i < n: шаг положителен, значения i лежат в [min(i0, n), max(i0, n + c)];
+        // i > n — симметрично
+        const int64_t init = code.constant(basic.init.value);
+        const int64_t step = code.constant(basic.step.value);
+        const int64_t bound = code.constant(test.operand(bound_field));
+        const bool less = (test.op == IROpCode::CMP_LT) == left;
+        if ((less && step <= 0) || (!less && step >= 0)) {
+            continue;
+        }
+        const int64_t low = less ? std::min(init, bound) : std::min(init, bound + step);
+        const int64_t high = less ? std::max(init, bound + step) : std::max(init, bound);
+        const int64_t factor = basic.factor;
+        if (low * factor < INT_MIN || high * factor > INT_MAX) {
+            continue;
+        }
+        test.set(left ? P::ARG1 : P::ARG2, PackedKind::SLOT, basic.scaled);
+        test.set(bound_field, PackedKind::CONST, code.addConstant((int)(bound * factor)));
+        --uses[basic.phi];
+        ++uses[basic.scaled];
+        ++replaced_tests;
+    }
+
+    // 4. Базовые переменные, которые читает только их приращение, вместе с загрузкой
+    // начального значения, если больше её никто не читает
+    // Номера инструкций после удалений устарели, определение ищется в блоке
+    auto definition = [&](uint32_t value) {
+        std::pmr::vector<PackedInstruction>& body = cfg.block(def_block[value]).code;
+        return std::find_if(body.begin(), body.end(), [&](const PackedInstruction& instr) {
+            return instr.kind(P::RESULT) == PackedKind::SLOT && instr.operand(P::RESULT) == value;
+        });
+    };
+    size_t removed = 0;
+    for (const BasicVariable& basic : basics) {
+        if (uses[basic.phi] != 1 || uses[basic.next] != 1) {
+            continue;
+        }
+        const BasicBlock& header = cfg.block(basic.header);
+        const auto preds = cfg.predecessors(basic.header);
+        const PhiOperand init = std::find_if(header.phis.begin(), header.phis.end(), [&](const PhiNode& phi) {
+            return phi.result == basic.phi;
+        })->args[preds[0] == basic.preheader ? 0 : 1];
+        std::erase_if(cfg.block(basic.header).phis, [&](const PhiNode& phi) { return phi.result == basic.phi; });
+        cfg.block(def_block[basic.next]).code.erase(definition(basic.next));
+        if (init.kind == PackedKind::SLOT && --uses[init.value] == 0 && def_index[init.value] != NONE) {
+            const auto load = definition(init.value);
+            if (load->op == IROpCode::LOAD_IMM || load->op == IROpCode::ASSIGN) {
+                cfg.block(def_block[init.value]).code.erase(load);
+            }
+        }
+        ++removed;
+    }
+
+    std::cout << "[IV] " << basics.size() << " basic induction variables, " << replaced.size() << " multiplications reduced to "
+              << scaled.size() << " additive variables, " << replaced_tests << " exit tests replaced, " << removed
+              << " basic variables removed.\n";
+}
+
+// Упрощение потока управления после выхода из SSA (φ-функций уже нет):
+// - JMP_IF_ZERO по литералу становится безусловным переходом;
+// - переход в пустой блок продолжается сразу к его преемнику (цепочки JMP);
+// - условный переход с одинаковыми преемниками становится безусловным;
+// - переход назад к заголовку цикла, который только сравнивает и ветвится, заменяется
+//   копией сравнения с обратным результатом: на каждой итерации вместо сравнения,
+//   JMP_IF_ZERO и JMP остаются сравнение и JMP_IF_ZERO. Слот условия переиспользуется,
+//   поэтому его не должна читать никакая другая инструкция;
+// - блок с единственным предшественником, который в него безусловно переходит,
+//   присоединяется к предшественнику.
+// Переходы на следующий блок не выводит linearize()
+void IROptimizer::controlFlowSimplificationPass(ControlFlowGraph& cfg, PackedIR& code) {
+    constexpr uint32_t NO_BLOCK = ControlFlowGraph::NO_BLOCK;
+    const uint32_t block_count = (uint32_t)cfg.blockCount();
+    auto makeJump = [](BasicBlock& block, uint32_t next) {
+        block.branch = PackedInstruction();
+        block.branch.op = IROpCode::JMP;
+        block.next = next;
+        block.target = NO_BLOCK;
+    };
+    auto isForwarder = [&cfg](uint32_t b) {
+        const BasicBlock& block = cfg.block(b);
+        return b != cfg.exit() && block.code.empty() && !block.isConditional() && block.next != b;
+    };
+
+    size_t folded_branches = 0;
+    size_t threaded_jumps = 0;
+    size_t replicated_tests = 0;
+    size_t merged_blocks = 0;
+    for (uint32_t b : cfg.reversePostorder()) {
+        BasicBlock& block = cfg.block(b);
+        if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::CONST) {
+            makeJump(block, code.constant(block.branch.operand(P::ARG1)) == 0 ? block.target : block.next);
+            ++folded_branches;
+        }
+        for (uint32_t* successor : {&block.next, &block.target}) {
+            if (*successor == NO_BLOCK || !isForwarder(*successor)) {
+                continue;
+            }
+            // Цикл из пустых блоков (бесконечный пустой цикл) не разворачивается дальше себя
+            uint32_t to = *successor;
+            for (uint32_t steps = 0; isForwarder(to) && steps < block_count; ++steps) {
+                to = cfg.block(to).next;
+            }
+            *successor = to;
+            ++threaded_jumps;
+        }
+        if (block.isConditional() && block.next == block.target) {
+            makeJump(block, block.next);
+            ++folded_branches;
+        }
+    }
+    cfg.analyze();
+
+    // Чтения слотов во всём коде: условие заголовка должно читаться только его переходом
+    std::pmr::vector<uint32_t> reads(code.slotCount(), 0);
+    for (uint32_t b : cfg.reversePostorder()) {
+        const BasicBlock& block = cfg.block(b);
+        for (const PackedInstruction& instr : block.code) {
+            for (int field : {P::ARG1, P::ARG2}) {
+                if (instr.kind(field) == PackedKind::SLOT) {
+                    ++reads[instr.operand(field)];
+                }
+            }
+        }
+        if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+            ++reads[block.branch.operand(P::ARG1)];
+        }
+    }
+    for (const Loop& loop : cfg.loops()) {
+        const BasicBlock& header = cfg.block(loop.header);
+        if (!header.isConditional() || header.code.size() != 1 || header.branch.kind(P::ARG1) != PackedKind::SLOT ||
+            header.code[0].kind(P::RESULT) != PackedKind::SLOT ||
+            header.code[0].operand(P::RESULT) != header.branch.operand(P::ARG1) ||
+            reads[header.branch.operand(P::ARG1)] != 1) {
+            continue;
+        }
+        PackedInstruction test = header.code[0];
+        if (!invertComparison(test, code)) {
+            continue;
+        }
+        for (uint32_t latch : cfg.predecessors(loop.header)) {
+            BasicBlock& block = cfg.block(latch);
+            if (!cfg.reachable(latch) || block.isConditional() || !cfg.dominates(loop.header, latch)) {
+                continue;
+            }
+            block.code.push_back(test);
+            block.branch = header.branch;
+            block.target = header.next;
+            block.next = header.target;
+            ++replicated_tests;
+        }
+    }
+    cfg.analyze();
+
+    for (uint32_t b : cfg.reversePostorder()) {
+        BasicBlock& block = cfg.block(b);
+        while (!block.isConditional() && block.next != NO_BLOCK && block.next != b && block.next != cfg.exit() &&
+               block.next != cfg.entry() && cfg.predecessors(block.next).size() == 1) {
+            BasicBlock& next = cfg.block(block.next);
+            block.code.insert(block.code.end(), next.code.begin(), next.code.end());
+            block.branch = next.branch;
+            block.target = next.target;
+            const uint32_t after = next.next;
+            next.code.clear();
+            makeJump(next, cfg.exit());
+            block.next = after;
+            ++merged_blocks;
+        }
+    }
+    cfg.analyze();
+
+    std::cout << "[CFlow] " << folded_branches << " branches folded, " << threaded_jumps << " jumps threaded, "
+              << replicated_tests << " loop tests replicated, " << merged_blocks << " blocks merged.\n";
+}
@@ -3,6 +3,21 @@
 #include <iomanip>
 #include <algorithm>
 #include <fstream>
+#include <map>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <cstring>
+#include <thread>
+#include <memory>
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEXER_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#define LEXER_SIMD_SSE2 0
+#endif
 
 // Вспомогательные функции для преобразования типов токенов в строки
 namespace {
@@ -48,12 +63,290 @@ std::string Token::classToString() const {
     return "UNKNOWN_CLASS";
 }
 
+// Таблицы классов символов, ключевых слов и векторные примитивы сканирования
+namespace {
+    // Классы символов для диспетчеризации в горячем цикле
+    enum CharKind : uint8_t {
+        KIND_OTHER,      // Неизвестный символ
+        KIND_SPACE,      // ' ', '\t', '\r', '\n'
+        KIND_DIGIT,      // 0-9
+        KIND_ALPHA,      // a-z, A-Z, '_'
+        KIND_SIMPLE,     // Односимвольный токен
+        KIND_SLASH,      // '/' или начало комментария
+        KIND_EQUAL,      // '=' или '=='
+        KIND_BANG        // '!='
+    };
+
+    struct CharTable {
+        CharKind kind[256] = {};
+        bool ident[256] = {};               // Допустим внутри идентификатора
+        TokenType simple_type[256] = {};    // Тип односимвольного токена
+        TokenClass simple_class[256] = {};  // Класс односимвольного токена
+    };
+
+    constexpr CharTable makeCharTable() {
+        CharTable t;
+        for (int c = 0; c < 256; ++c) {
+            t.kind[c] = KIND_OTHER;
+            t.simple_type[c] = TokenType::TOKEN_UNKNOWN;
+            t.simple_class[c] = TokenClass::UNKNOWN;
+        }
+        for (unsigned char c : {' ', '\t', '\r', '\n'}) t.kind[c] = KIND_SPACE;
+        for (int c = '0'; c <= '9'; ++c) { t.kind[c] = KIND_DIGIT; t.ident[c] = true; }
+        for (int c = 'a'; c <= 'z'; ++c) { t.kind[c] = KIND_ALPHA; t.ident[c] = true; }
+        for (int c = 'A'; c <= 'Z'; ++c) { t.kind[c] = KIND_ALPHA; t.ident[c] = true; }
+        t.kind['_'] = KIND_ALPHA;
+        t.ident['_'] = true;
+
+        struct Simple { char c; TokenType type; TokenClass token_class; };
+        const Simple simple[] = {
+            {'+', TokenType::TOKEN_PLUS, TokenClass::OPERATOR},
+            {'-', TokenType::TOKEN_MINUS, TokenClass::OPERATOR},
+            {'*', TokenType::TOKEN_MULTIPLY, TokenClass::OPERATOR},
+            {'<', TokenType::TOKEN_LESS, TokenClass::OPERATOR},
+            {'>', TokenType::TOKEN_GREATER, TokenClass::OPERATOR},
+            {';', TokenType::TOKEN_SEMICOLON, TokenClass::PUNCTUATION},
+            {'(', TokenType::TOKEN_LPAREN, TokenClass::PUNCTUATION},
+            {')', TokenType::TOKEN_RPAREN, TokenClass::PUNCTUATION},
+            {'{', TokenType::TOKEN_LBRACE, TokenClass::PUNCTUATION},
+            {'}', TokenType::TOKEN_RBRACE, TokenClass::PUNCTUATION}
+        };
+        for (const Simple& entry : simple) {
+            unsigned char c = (unsigned char)entry.c;
+            t.kind[c] = KIND_SIMPLE;
+            t.simple_type[c] = entry.type;
+            t.simple_class[c] = entry.token_class;
+        }
+        t.kind['/'] = KIND_SLASH;
+        t.kind['='] = KIND_EQUAL;
+        t.kind['!'] = KIND_BANG;
+        return t;
+    }
+
+    constexpr CharTable CHAR_TABLE = makeCharTable();
+
+    inline CharKind kindOf(char c) { return CHAR_TABLE.kind[(unsigned char)c]; }
+    inline bool isIdentChar(char c) { return CHAR_TABLE.ident[(unsigned char)c]; }
+
+    // Совершенная хеш-таблица ключевых слов, строится на этапе компиляции
+    struct KeywordEntry {
+        std::string_view text;
+        TokenType type = TokenType::TOKEN_IDENTIFIER;
+    };
+
+    constexpr size_t KEYWORD_TABLE_SIZE = 8;
+
+    constexpr size_t keywordHash(const char* s, size_t len) {
+        return (((size_t)(unsigned char)s[0] << 1) + (unsigned char)s[len - 1]) & (KEYWORD_TABLE_SIZE - 1);
+    }
+
+    struct KeywordTable {
+        KeywordEntry slots[KEYWORD_TABLE_SIZE] = {};
+        bool collision = false;
+    };
+
+    constexpr KeywordTable makeKeywordTable() {
+        const KeywordEntry keywords[] = {
+            {"int", TokenType::TOKEN_INT},
+            {"if", TokenType::TOKEN_IF},
+            {"else", TokenType::TOKEN_ELSE},
+            {"while", TokenType::TOKEN_WHILE},
+            {"print", TokenType::TOKEN_PRINT}
+        };
+        KeywordTable table;
+        for (const KeywordEntry& kw : keywords) {
+            size_t h = keywordHash(kw.text.data(), kw.text.size());
+            if (!table.slots[h].text.empty()) {
+                table.collision = true;
+            }
+            table.slots[h] = kw;
+        }
+        return table;
+    }
+
+    constexpr KeywordTable KEYWORD_TABLE = makeKeywordTable();
+    static_assert(!KEYWORD_TABLE.collision, "Keyword hash is not perfect: adjust keywordHash");
+
+    inline TokenType lookupKeyword(std::string_view word) {
+        const KeywordEntry& entry = KEYWORD_TABLE.slots[keywordHash(word.data(), word.size())];
+        return entry.text == word ? entry.type : TokenType::TOKEN_IDENTIFIER;
+    }
+
+    // Векторные примитивы: 16 байт за шаг (SSE2), скалярный хвост через таблицу
+#if LEXER_SIMD_SSE2
+    inline unsigned whitespaceMask(__m128i v) {
+        __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        return (unsigned)_mm_movemask_epi8(m);
+    }
+
+    inline unsigned identMask(__m128i v) {
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        return (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), under));
+    }
+
+    inline unsigned digitMask(__m128i v) {
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        return (unsigned)_mm_movemask_epi8(digit);
+    }
+
+    inline unsigned newlineMask(__m128i v) {
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    }
+
+    // Длина серии байтов, для которых mask_fn даёт единичный бит
+    template <typename MaskFn, typename ScalarFn>
+    inline size_t runLength(const char* p, const char* end, MaskFn mask_fn, ScalarFn scalar_fn) {
+        const char* start = p;
+        while (end - p >= 16) {
+            unsigned mask = mask_fn(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if (mask != 0xFFFFu) {
+                return (size_t)(p - start) + (size_t)std::countr_one(mask);
+            }
+            p += 16;
+        }
+        while (p < end && scalar_fn(*p)) ++p;
+        return (size_t)(p - start);
+    }
+#else
+    template <typename ScalarFn>
+    inline size_t scalarRunLength(const char* p, const char* end, ScalarFn scalar_fn) {
+        const char* start = p;
+        while (p < end && scalar_fn(*p)) ++p;
+        return (size_t)(p - start);
+    }
+#endif
+
+    inline size_t whitespaceRun(const char* p, const char* end) {
+        auto scalar = [](char c) { return kindOf(c) == KIND_SPACE; };
+#if LEXER_SIMD_SSE2
+        return runLength(p, end, whitespaceMask, scalar);
+#else
+        return scalarRunLength(p, end, scalar);
+#endif
+    }
+
+    inline size_t identifierRun(const char* p, const char* end) {
+#if LEXER_SIMD_SSE2
+        return runLength(p, end, identMask, isIdentChar);
+#else
+        return scalarRunLength(p, end, isIdentChar);
+#endif
+    }
+
+    inline size_t digitRun(const char* p, const char* end) {
+        auto scalar = [](char c) { return kindOf(c) == KIND_DIGIT; };
+#if LEXER_SIMD_SSE2
+        return runLength(p, end, digitMask, scalar);
+#else
+        return scalarRunLength(p, end, scalar);
+#endif
+    }
+
+    // Длина серии до ближайшего '\n' (тело комментария)
+    inline size_t untilNewline(const char* p, const char* end) {
+        auto scalar = [](char c) { return c != '\n'; };
+#if LEXER_SIMD_SSE2
+        return runLength(p, end, [](__m128i v) { return ~newlineMask(v) & 0xFFFFu; }, scalar);
+#else
+        return scalarRunLength(p, end, scalar);
+#endif
+    }
+
+    // Число переводов строк в [p, end) и позиция последнего из них
+    inline size_t countNewlines(const char* p, const char* end, const char** last_newline) {
+        size_t count = 0;
+#if LEXER_SIMD_SSE2
+        while (end - p >= 16) {
+            unsigned mask = newlineMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if (mask) {
+                count += (size_t)std::popcount(mask);
+                *last_newline = p + 31 - std::countl_zero(mask);
+            }
+            p += 16;
+        }
+#endif
+        for (; p < end; ++p) {
+            if (*p == '\n') {
+                ++count;
+                *last_newline = p;
+            }
+        }
+        return count;
+    }
+}
+
+// Простой пул потоков: задачи [0, count) разбираются рабочими по атомарному счётчику
+namespace {
+    template <typename Fn>
+    void parallelFor(size_t count, unsigned thread_count, Fn fn) {
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                fn(i);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        unsigned extra = (unsigned)std::min<size_t>(thread_count, count) - 1;
+        workers.reserve(extra);
+        for (unsigned t = 0; t < extra; ++t) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& w : workers) {
+            w.join();
+        }
+    }
+}
+
+// Форматирование таблицы токенов (общая часть для полной таблицы и потокового вывода)
+namespace {
+    void writeTokenTableHeader(std::ostream& os) {
+        os << "## Token Table \n\n";
+        os << "| Номер Строки | Позиция | Имя Лексемы | Класс Лексемы | Значение |\n";
+        os << "| :----------: | :-----: | :---------: | :-----------: | :------: |\n";
+    }
+
+    void writeTokenTableRow(std::ostream& os, const Token& token) {
+        const int LINE_WIDTH = 12;
+        const int POS_WIDTH = 7;
+        const int TYPE_WIDTH = 11;
+        const int CLASS_WIDTH = 13;
+        const int VALUE_CELL_WIDTH = 8;
+
+        std::string_view value = token.value.empty() ? std::string_view("\u00A0") : token.value;
+
+        os << "| " << std::setw(LINE_WIDTH) << std::right << token.line
+           << " | " << std::setw(POS_WIDTH) << token.position
+           << " | " << std::setw(TYPE_WIDTH) << std::left << token.typeToString()
+           << " | " << std::setw(CLASS_WIDTH) << token.classToString()
+           << " | `" << std::setw(VALUE_CELL_WIDTH - 2) << value << "` |\n";
+        os << std::right;
+    }
+}
+
 // Реализация методов лексического анализатора
-Lexer::Lexer(const std::string& source_code, ErrorHandler* handler)
+Lexer::Lexer(std::string_view source_code, ErrorHandler* handler)
     : source_code_(source_code),
       error_handler_(handler) {
 }
 
+// Потоковый режим: исходный код читается фрагментами по мере запроса токенов
+Lexer::Lexer(std::istream& input, ErrorHandler* handler, size_t chunk_size)
+    : error_handler_(handler),
+      input_(&input),
+      chunk_size_(std::max<size_t>(chunk_size, 16)) {
+    window_.resize(chunk_size_);
+}
+
 bool Lexer::isAtEnd() const {
     return current_index_ >= source_code_.length();
 }
@@ -66,135 +359,168 @@ char Lexer::peek(size_t offset) const {
     return source_code_[index];
 }
 
+// Токены не содержат переводов строк, поэтому сдвиг не проверяет '\n'
 void Lexer::advance(size_t count) {
-    for (size_t i = 0; i < count; ++i) {
-        if (isAtEnd()) break;
-        if (source_code_[current_index_] == '\n') {
-            current_line_++;
-            line_start_pos_ = current_index_ + 1;
-        }
-        current_index_++;
+    current_index_ = std::min(current_index_ + count, source_code_.length());
+}
+
+// Подкачка следующего фрагмента: байты до keep_from освобождаются,
+// хвост [keep_from, конец) переносится в начало окна (незавершённый токен)
+bool Lexer::refill(size_t keep_from) {
+    if (!input_ || input_exhausted_) {
+        return false;
+    }
+
+    size_t kept = source_code_.length() - keep_from;
+    if (kept > 0 && keep_from > 0) {
+        std::memmove(window_.data(), window_.data() + keep_from, kept);
+    }
+    window_offset_ += keep_from;
+    current_index_ -= keep_from;
+
+    // Окно растёт только если один токен длиннее фрагмента
+    if (window_.size() < kept + chunk_size_) {
+        window_.resize(kept + chunk_size_);
+    }
+
+    input_->read(window_.data() + kept, (std::streamsize)chunk_size_);
+    size_t received = (size_t)input_->gcount();
+    if (received < chunk_size_) {
+        input_exhausted_ = true;
+    }
+
+    source_code_ = std::string_view(window_.data(), kept + received);
+    return received > 0;
+}
+
+// Гарантия count байт после текущей позиции (если поток не исчерпан)
+void Lexer::ensureLookahead(size_t count) {
+    if (input_ && current_index_ + count > source_code_.length()) {
+        refill(current_index_);
+    }
+}
+
+// Векторный подсчёт строк в пропущенном диапазоне
+void Lexer::countLines(size_t from, size_t to) {
+    const char* base = source_code_.data();
+    const char* last_newline = nullptr;
+    size_t count = countNewlines(base + from, base + to, &last_newline);
+    if (count) {
+        current_line_ += (int)count;
+        line_start_pos_ = window_offset_ + (size_t)(last_newline - base) + 1;
     }
 }
 
 void Lexer::skipWhitespace() {
-    while (!isAtEnd()) {
-        char c = peek();
-        if (c == ' ' || c == '\r' || c == '\t' || c == '\n') {
-            advance();
-        } else {
+    for (;;) {
+        const char* base = source_code_.data();
+        size_t start = current_index_;
+        current_index_ += whitespaceRun(base + start, base + source_code_.length());
+        countLines(start, current_index_);
+        if (!isAtEnd() || !refill(current_index_)) {
             break;
         }
     }
 }
 
 void Lexer::skipComment() {
-    if (peek() == '/' && peek(1) == '/') {
-        advance(2);
-        while (!isAtEnd() && peek() != '\n') {
-            advance();
+    advance(2);
+    for (;;) {
+        const char* base = source_code_.data();
+        current_index_ += untilNewline(base + current_index_, base + source_code_.length());
+        if (!isAtEnd() || !refill(current_index_)) {
+            break;
         }
-        skipWhitespace();
     }
 }
 
-bool Lexer::isDigit(char c) const {
-    return c >= '0' && c <= '9';
-}
-
-bool Lexer::isAlpha(char c) const {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+// Пропуск любой последовательности пробелов и комментариев
+void Lexer::skipTrivia() {
+    for (;;) {
+        skipWhitespace();
+        ensureLookahead(2);
+        if (peek() == '/' && peek(1) == '/') {
+            skipComment();
+            continue;
+        }
+        break;
+    }
 }
 
-bool Lexer::isAlphaNumeric(char c) const {
-    return isAlpha(c) || isDigit(c);
+// Сканирование серии символов токена; при подкачке начало токена переезжает в начало окна
+template <typename RunFn>
+size_t Lexer::scanRun(RunFn run) {
+    size_t token_start = window_offset_ + current_index_;
+    for (;;) {
+        const char* base = source_code_.data();
+        current_index_ += run(base + current_index_, base + source_code_.length());
+        if (!isAtEnd() || !refill(token_start - window_offset_)) {
+            return token_start - window_offset_;
+        }
+    }
 }
 
 // Сканирование числового литерала
-void Lexer::scanNumber() {
-    size_t start_index = current_index_;
-    while (isDigit(peek())) {
-        advance();
-    }
+bool Lexer::scanNumber(Token& token) {
+    size_t start_index = scanRun(digitRun);
 
-    std::string value = source_code_.substr(start_index, current_index_ - start_index);
-    tokens_.push_back({
+    token = Token(
         TokenType::TOKEN_INT_LITERAL,
         TokenClass::LITERAL,
-        value,
+        source_code_.substr(start_index, current_index_ - start_index),
         current_line_,
-        (int)(start_index - line_start_pos_)
-    });
+        (int)(window_offset_ + start_index - line_start_pos_)
+    );
+    return true;
 }
 
 // Сканирование идентификатора или ключевого слова
-void Lexer::scanIdentifierOrKeyword() {
-    size_t start_index = current_index_;
-    while (isAlphaNumeric(peek())) {
-        advance();
-    }
+bool Lexer::scanIdentifierOrKeyword(Token& token) {
+    size_t start_index = scanRun(identifierRun);
 
-    std::string value = source_code_.substr(start_index, current_index_ - start_index);
-    TokenType type;
-    TokenClass token_class;
+    std::string_view value = source_code_.substr(start_index, current_index_ - start_index);
+    TokenType type = lookupKeyword(value);
+    const bool is_identifier = (type == TokenType::TOKEN_IDENTIFIER);
 
-    if (keywords_.count(value)) {
-        type = keywords_.at(value);
-        token_class = TokenClass::KEYWORD;
-    } else {
-        type = TokenType::TOKEN_IDENTIFIER;
-        token_class = TokenClass::IDENTIFIER;
-    }
-
-    tokens_.push_back({
+    token = Token(
         type,
-        token_class,
+        is_identifier ? TokenClass::IDENTIFIER : TokenClass::KEYWORD,
         value,
         current_line_,
-        (int)(start_index - line_start_pos_)
-    });
+        (int)(window_offset_ + start_index - line_start_pos_),
+        is_identifier ? interner_->intern(value) : SymbolInterner::NO_SYMBOL
+    );
+    return true;
 }
 
-// Сканирование одного токена
-void Lexer::scanToken() {
-    skipWhitespace();
-    skipComment();
-    skipWhitespace();
+// Сканирование одного токена; false, если токен не получен (конец или ошибка)
+bool Lexer::scanToken(Token& token) {
+    skipTrivia();
 
     if (isAtEnd()) {
-        return;
+        return false;
     }
 
-    char c = peek();
+    char c = source_code_[current_index_];
     size_t start_index = current_index_;
     TokenType type = TokenType::TOKEN_UNKNOWN;
     TokenClass token_class = TokenClass::UNKNOWN;
     size_t len = 1;
 
-    if (isDigit(c)) {
-        scanNumber();
-        return;
-    }
-    if (isAlpha(c)) {
-        scanIdentifierOrKeyword();
-        return;
-    }
-
-    switch (c) {
-        case '+': type = TokenType::TOKEN_PLUS; token_class = TokenClass::OPERATOR; break;
-        case '-': type = TokenType::TOKEN_MINUS; token_class = TokenClass::OPERATOR; break;
-        case '*': type = TokenType::TOKEN_MULTIPLY; token_class = TokenClass::OPERATOR; break;
-        case '/':
+    switch (kindOf(c)) {
+        case KIND_DIGIT:
+            return scanNumber(token);
+        case KIND_ALPHA:
+            return scanIdentifierOrKeyword(token);
+        case KIND_SIMPLE:
+            type = CHAR_TABLE.simple_type[(unsigned char)c];
+            token_class = CHAR_TABLE.simple_class[(unsigned char)c];
+            break;
+        case KIND_SLASH:
             type = TokenType::TOKEN_DIVIDE;
             token_class = TokenClass::OPERATOR;
             break;
-        case ';': type = TokenType::TOKEN_SEMICOLON; token_class = TokenClass::PUNCTUATION; break;
-        case '(': type = TokenType::TOKEN_LPAREN; token_class = TokenClass::PUNCTUATION; break;
-        case ')': type = TokenType::TOKEN_RPAREN; token_class = TokenClass::PUNCTUATION; break;
-        case '{': type = TokenType::TOKEN_LBRACE; token_class = TokenClass::PUNCTUATION; break;
-        case '}': type = TokenType::TOKEN_RBRACE; token_class = TokenClass::PUNCTUATION; break;
-
-        case '=':
+        case KIND_EQUAL:
             if (peek(1) == '=') {
                 type = TokenType::TOKEN_EQUAL;
                 len = 2;
@@ -203,27 +529,14 @@ void Lexer::scanToken() {
             }
             token_class = TokenClass::OPERATOR;
             break;
-        case '!':
+        case KIND_BANG:
             if (peek(1) == '=') {
                 type = TokenType::TOKEN_NOT_EQUAL;
                 len = 2;
-            } else {
-                type = TokenType::TOKEN_UNKNOWN;
             }
             token_class = TokenClass::OPERATOR;
             break;
-        case '<':
-            type = TokenType::TOKEN_LESS;
-            token_class = TokenClass::OPERATOR;
-            break;
-        case '>':
-            type = TokenType::TOKEN_GREATER;
-            token_class = TokenClass::OPERATOR;
-            break;
-
         default:
-            type = TokenType::TOKEN_UNKNOWN;
-            token_class = TokenClass::UNKNOWN;
             break;
     }
 
@@ -233,45 +546,318 @@ void Lexer::scanToken() {
                 "Lexical",
                 "Unknown symbol: '" + std::string(1, c) + "'",
                 current_line_,
-                (int)(current_index_ - line_start_pos_)
+                (int)(window_offset_ + current_index_ - line_start_pos_)
             );
         }
         advance(len);
-        return;
+        return false;
     }
 
-    std::string value = source_code_.substr(start_index, len);
-    tokens_.push_back({
+    token = Token(
         type,
         token_class,
-        value,
+        source_code_.substr(start_index, len),
         current_line_,
-        (int)(start_index - line_start_pos_)
-    });
+        (int)(window_offset_ + start_index - line_start_pos_)
+    );
 
     advance(len);
+    return true;
+}
+
+// Токен конца файла в текущей позиции
+Token Lexer::makeEofToken() const {
+    return Token(
+        TokenType::TOKEN_EOF,
+        TokenClass::END_OF_FILE,
+        "EOF",
+        current_line_,
+        (int)(window_offset_ + current_index_ - line_start_pos_)
+    );
 }
 
-// Основной метод лексического анализа
+// Основной метод лексического анализа (режим буфера; в потоковом режиме токены выдаются по запросу)
 void Lexer::runLexer() {
+    if (input_) {
+        return;
+    }
+
     token_index_ = 0;
     tokens_.clear();
+    tokens_.rebase(source_code_.data());
+    // Оценка сверху (~3 байта исходника на токен) для таблицы блоков
+    tokens_.reserve(source_code_.size() / 3 + 1);
 
+    Token token;
     while (!isAtEnd()) {
-        scanToken();
+        if (scanToken(token)) {
+            tokens_.push_back(token);
+        }
     }
 
-    tokens_.push_back({
-        TokenType::TOKEN_EOF,
-        TokenClass::END_OF_FILE,
-        "EOF",
-        current_line_,
-        (int)(current_index_ - line_start_pos_)
+    tokens_.setEof(makeEofToken());
+}
+
+// Параллельный лексический анализ (режим буфера).
+// Фрагменты начинаются сразу после '\n', а токены и комментарии '//' не содержат
+// переводов строк, поэтому каждый фрагмент лексируется независимо и точно:
+// спекуляция на границе не требуется, остаётся сдвинуть номера строк.
+void Lexer::runLexerParallel(unsigned thread_count, size_t min_chunk_bytes) {
+    if (input_) {
+        return;
+    }
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const size_t size = source_code_.size();
+    const size_t chunk_count = std::min<size_t>((size_t)thread_count * CHUNKS_PER_THREAD,
+                                                size / std::max<size_t>(min_chunk_bytes, 1));
+    if (thread_count <= 1 || chunk_count <= 1) {
+        runLexer();
+        return;
+    }
+
+    // Границы фрагментов по переводам строк
+    std::vector<size_t> bounds = {0};
+    for (size_t i = 1; i < chunk_count; ++i) {
+        size_t target = std::max(size / chunk_count * i, bounds.back());
+        size_t newline = source_code_.find('\n', target);
+        if (newline == std::string_view::npos || newline + 1 >= size) {
+            break;
+        }
+        if (newline + 1 > bounds.back()) {
+            bounds.push_back(newline + 1);
+        }
+    }
+    bounds.push_back(size);
+    const size_t chunks = bounds.size() - 1;
+
+    struct ChunkResult {
+        TokenStore tokens;                      // EOF нужен только от последнего фрагмента
+        ErrorHandler errors;
+        int newlines = 0;
+        std::unique_ptr<SymbolInterner> names;  // Имена фрагмента (локальные номера)
+        std::vector<SymbolId> remap;            // Локальный номер -> номер в общей таблице
+    };
+    std::vector<ChunkResult> results(chunks);
+
+    // Этап 1: независимый лексический анализ фрагментов; имена интернируются
+    // в локальную таблицу фрагмента, чтобы потоки не делили общую
+    parallelFor(chunks, thread_count, [&](size_t i) {
+        ChunkResult& result = results[i];
+        result.names = std::make_unique<SymbolInterner>();
+        Lexer chunk_lexer(source_code_.substr(bounds[i], bounds[i + 1] - bounds[i]), &result.errors);
+        chunk_lexer.interner_ = result.names.get();
+        chunk_lexer.runLexer();
+        result.newlines = chunk_lexer.current_line_ - 1;
+        result.tokens = std::move(chunk_lexer.tokens_);
+    });
+
+    // Этап 2: смещения токенов и номеров строк (префиксные суммы)
+    std::vector<size_t> token_base(chunks);
+    std::vector<int> line_base(chunks);
+    size_t total_tokens = 0;
+    int total_lines = 0;
+    for (size_t i = 0; i < chunks; ++i) {
+        token_base[i] = total_tokens;
+        line_base[i] = total_lines;
+        total_tokens += results[i].tokens.size() - 1;
+        total_lines += results[i].newlines;
+
+        // Различные имена фрагмента переводятся в общую таблицу (по одному разу на имя)
+        const SymbolInterner& names = *results[i].names;
+        results[i].remap.resize(names.size());
+        for (SymbolId id = 0; id < names.size(); ++id) {
+            results[i].remap[id] = interner_->intern(names.name(id));
+        }
+    }
+
+    // Этап 3: слияние с пересчётом номеров строк и номеров имён
+    token_index_ = 0;
+    tokens_.clear();
+    tokens_.rebase(source_code_.data());
+    tokens_.resize(total_tokens);
+    parallelFor(chunks, thread_count, [&](size_t i) {
+        const TokenStore& chunk = results[i].tokens;
+        const std::vector<SymbolId>& remap = results[i].remap;
+        for (size_t j = 0; j + 1 < chunk.size(); ++j) {
+            Token& out = tokens_.slot(token_base[i] + j);
+            out = chunk[j];
+            out.line += line_base[i];
+            if (out.symbol != SymbolInterner::NO_SYMBOL) {
+                out.symbol = remap[out.symbol];
+            }
+        }
     });
+    Token eof = results.back().tokens.back();
+    eof.line += line_base.back();
+    tokens_.setEof(eof);
+
+    // Ошибки сохраняются в порядке исходного кода
+    for (size_t i = 0; i < chunks; ++i) {
+        for (const CompilerError& err : results[i].errors.getErrors()) {
+            if (error_handler_) {
+                error_handler_->registerError(err.type, err.message, err.line + line_base[i], err.position);
+            }
+        }
+    }
+
+    current_index_ = size;
+    current_line_ = total_lines + 1;
+}
+
+// Потоковый режим: распознавание следующего токена по запросу парсера
+const Token& Lexer::pullToken() {
+    if (stream_finished_) {
+        return stream_token_;
+    }
+
+    while (!scanToken(stream_token_)) {
+        if (isAtEnd()) {
+            stream_token_ = makeEofToken();
+            stream_finished_ = true;
+            break;
+        }
+    }
+
+    if (token_table_stream_) {
+        writeTokenTableRow(*token_table_stream_, stream_token_);
+    }
+    return stream_token_;
+}
+
+// Инкрементальный лексический анализ после правки.
+// Окно начинается с токена перед правкой (соседний токен может слиться со вставкой,
+// например '=' + '=') и заканчивается на первом новом токене за правкой, который
+// начинается там же, где сдвинутый старый токен: дальше тексты совпадают, а лексер
+// не хранит состояния между токенами, поэтому хвост совпал бы и при полном анализе.
+// Хвост не переписывается: его сдвиг копится в заголовках блоков TokenStore, и сразу
+// пересчитываются только позиции в строке синхронизации
+RelexResult Lexer::relex(std::string_view new_source, const TextEdit& edit) {
+    RelexResult result;
+    if (input_) {
+        return result;
+    }
+    if (tokens_.empty()) {
+        source_code_ = new_source;
+        runLexer();
+        result.new_end_token = tokens_.size();
+        return result;
+    }
+
+    const size_t old_size = source_code_.size();
+    const size_t eof_index = tokens_.size() - 1;
+    const std::ptrdiff_t delta = (std::ptrdiff_t)edit.inserted_text.size() - (std::ptrdiff_t)edit.removed_length;
+    const size_t old_edit_end = edit.offset + edit.removed_length;
+    const size_t new_edit_end = edit.offset + edit.inserted_text.size();
+
+    auto offsetOf = [&](size_t i) -> size_t {
+        return i == eof_index ? old_size : tokens_.offsetOf(i);
+    };
+
+    // Первый токен, конец которого не левее начала правки, и один токен перед ним
+    size_t lo = 0;
+    size_t hi = eof_index;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (offsetOf(mid) + tokens_[mid].value.size() < edit.offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const size_t first = lo > 0 ? lo - 1 : 0;
+
+    // Ошибки окна собираются отдельно: сначала снимаются ошибки заменённого окна.
+    // Окно старого текста — от начала повторного сканирования до токена синхронизации
+    ErrorHandler window_errors;
+    Lexer window(new_source, &window_errors);
+    SourcePos window_begin{1, 0};
+    if (offsetOf(first) <= edit.offset) {
+        window.current_index_ = offsetOf(first);
+        window.current_line_ = tokens_[first].line;
+        window.line_start_pos_ = window.current_index_ - (size_t)tokens_[first].position;
+        window_begin = tokens_[first].where();
+    }
+
+    std::vector<Token> fresh;
+    size_t sync = eof_index;       // Старый токен, с которого поток переиспользуется
+    size_t candidate = first;
+    bool synced = false;
+    Token token;
+    while (!window.isAtEnd()) {
+        if (!window.scanToken(token)) {
+            continue;
+        }
+        const size_t pos = (size_t)(token.value.data() - new_source.data());
+        if (pos >= new_edit_end) {
+            while (candidate < eof_index &&
+                   (offsetOf(candidate) < old_edit_end ||
+                    (std::ptrdiff_t)offsetOf(candidate) + delta < (std::ptrdiff_t)pos)) {
+                ++candidate;
+            }
+            if (candidate < eof_index &&
+                (std::ptrdiff_t)offsetOf(candidate) + delta == (std::ptrdiff_t)pos &&
+                tokens_[candidate].type == token.type &&
+                tokens_[candidate].value.size() == token.value.size()) {
+                sync = candidate;
+                synced = true;
+                break;
+            }
+        }
+        fresh.push_back(token);
+    }
+
+    // Токены переезжают в новый буфер лениво, хвост сдвигается блоками (TokenStore);
+    // позиции в строке меняются только в строке синхронизации
+    tokens_.rebase(new_source.data());
+    SourcePos window_end{std::numeric_limits<int>::max(), 0};
+    int line_delta = 0;
+    int column_delta = 0;
+    if (synced) {
+        window_end = tokens_[sync].where();
+        line_delta = window.current_line_ - window_end.line;
+        tokens_.shift(sync, delta, line_delta);
+        size_t i = sync;
+        for (; i <= eof_index && tokens_[i].line == window_end.line + line_delta; ++i) {
+            Token& t = tokens_[i];
+            const size_t offset = i == eof_index ? new_source.size() : (size_t)(t.value.data() - new_source.data());
+            t.position = (int)(offset - window.line_start_pos_);
+        }
+        column_delta = tokens_[sync].position - window_end.position;
+        result.sync_line = window_end.line + line_delta;
+        result.line_end_token = first + fresh.size() + (i - sync);
+    } else {
+        tokens_.setEof(window.makeEofToken());
+    }
+    tokens_.replace(first, sync, fresh);
+
+    if (error_handler_) {
+        error_handler_->retractErrors("Lexical", window_begin.line, window_begin.position, window_end.line,
+                                      window_end.position, line_delta, column_delta);
+        for (const CompilerError& err : window_errors.getErrors()) {
+            error_handler_->registerError(err.type, err.message, err.line, err.position);
+        }
+    }
+
+    source_code_ = new_source;
+    token_index_ = 0;
+
+    result.first_token = first;
+    result.old_end_token = sync;
+    result.new_end_token = first + fresh.size();
+    result.line_delta = line_delta;
+    result.column_delta = column_delta;
+    return result;
 }
 
 // Получение следующего токена для парсера
-Token Lexer::getNextToken() {
+const Token& Lexer::getNextToken() {
+    if (input_) {
+        return pullToken();
+    }
+
     if (token_index_ < tokens_.size()) {
         return tokens_[token_index_++];
     }
@@ -280,34 +866,24 @@ Token Lexer::getNextToken() {
         return tokens_.back();
     }
 
-    return Token(TokenType::TOKEN_ERROR, TokenClass::UNKNOWN, "Empty Token Stream", 0, 0);
+    static const Token empty_stream_token(TokenType::TOKEN_ERROR, TokenClass::UNKNOWN, "Empty Token Stream", 0, 0);
+    return empty_stream_token;
+}
+
+// Потоковая таблица токенов: строки пишутся по мере выдачи токенов парсеру
+void Lexer::setTokenTableStream(std::ostream* os) {
+    token_table_stream_ = os;
+    if (token_table_stream_) {
+        writeTokenTableHeader(*token_table_stream_);
+    }
 }
 
 // Вывод таблицы токенов
 void Lexer::printTokenTable(std::ostream& os) const {
-    os << "## Token Table \n\n";
-    os << "| Номер Строки | Позиция | Имя Лексемы | Класс Лексемы | Значение |\n";
-    os << "| :----------: | :-----: | :---------: | :-----------: | :------: |\n";
-
-    const int LINE_WIDTH = 12;
-    const int POS_WIDTH = 7;
-    const int TYPE_WIDTH = 11;
-    const int CLASS_WIDTH = 13;
-    const int VALUE_CELL_WIDTH = 8;
-
-    os << std::left;
-
-    for (const auto& token : tokens_) {
-        std::string value = token.value.empty() ? "\u00A0" : token.value;
-
-        os << "| " << std::setw(LINE_WIDTH) << std::right << token.line
-           << " | " << std::setw(POS_WIDTH) << token.position
-           << " | " << std::setw(TYPE_WIDTH) << std::left << token.typeToString()
-           << " | " << std::setw(CLASS_WIDTH) << token.classToString()
-           << " | `" << std::setw(VALUE_CELL_WIDTH - 2) << value << "` |\n";
+    writeTokenTableHeader(os);
+    for (size_t i = 0; i < tokens_.size(); ++i) {
+        writeTokenTableRow(os, tokens_[i]);
     }
-
-    os << std::right;
 }
 
 // Запись таблицы токенов в файл
@@ -0,0 +1,53 @@
+#include "MemoryStats.h"
+#include <atomic>
+#include <fstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+    std::atomic<size_t> heap_allocations{0};
+}
+
+void MemoryStats::countHeapAllocation() noexcept {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t MemoryStats::heapAllocations() {
+    return heap_allocations.load(std::memory_order_relaxed);
+}
+
+// Пик RSS: VmHWM из /proc/self/status (сбрасывается resetPeakRss), иначе ru_maxrss
+size_t MemoryStats::peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmHWM:") {
+            size_t kb = 0;
+            status >> kb;
+            return kb;
+        }
+        status.ignore(4096, '\n');
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return (size_t)usage.ru_maxrss / 1024;
+#else
+        return (size_t)usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+// Запись "5" в clear_refs сбрасывает VmHWM до текущего RSS (Linux 4.0+)
+void MemoryStats::resetPeakRss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs.is_open()) {
+        clear_refs << "5";
+    }
+}
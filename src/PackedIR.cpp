@@ -0,0 +1,202 @@
+#include "PackedIR.h"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+std::string packedKindToString(PackedKind kind) {
+    switch (kind) {
+        case PackedKind::NONE: return "NONE";
+        case PackedKind::SLOT: return "SLOT";
+        case PackedKind::CONST: return "CONST";
+        case PackedKind::LABEL: return "LABEL";
+    }
+    return "UNKNOWN_KIND";
+}
+
+// --- Преобразования ---
+
+PackedIR PackedIR::fromCode(const IRCode& code) {
+    PackedIR ir;
+    ir.code_.reserve(code.size());
+
+    auto pack = [&ir](PackedInstruction& packed, int field, const Operand& op) {
+        switch (op.type) {
+            case OperandType::NONE:
+                packed.clear(field);
+                return;
+            case OperandType::VARIABLE:
+            case OperandType::TEMPORARY: {
+                if (op.slot < 0) {
+                    throw std::runtime_error("IR Packing Error: Variable/Temp '" + op.toString() +
+                                             "' has no memory slot (semantic analysis was not run).");
+                }
+                const size_t slot = (size_t)op.slot;
+                if (ir.slots_.size() <= slot) {
+                    ir.slots_.resize(slot + 1);
+                }
+                ir.slots_[slot] = PackedSlot{op.type, op.id};
+                packed.set(field, PackedKind::SLOT, (uint32_t)slot);
+                return;
+            }
+            case OperandType::LITERAL:
+                packed.set(field, PackedKind::CONST, ir.addConstant(op.value));
+                return;
+            case OperandType::LABEL:
+                packed.set(field, PackedKind::LABEL, op.id);
+                return;
+        }
+    };
+
+    for (const Instruction& instr : code) {
+        PackedInstruction packed;
+        packed.op = instr.op;
+        pack(packed, PackedInstruction::RESULT, instr.result);
+        pack(packed, PackedInstruction::ARG1, instr.arg1);
+        pack(packed, PackedInstruction::ARG2, instr.arg2);
+        ir.code_.push_back(packed);
+    }
+    ir.rebuildLabels();
+    return ir;
+}
+
+IRCode PackedIR::toCode() const {
+    auto unpack = [this](const PackedInstruction& instr, int field) -> Operand {
+        const uint32_t value = instr.operand(field);
+        switch (instr.kind(field)) {
+            case PackedKind::SLOT:
+                return Operand(slots_[value].type, slots_[value].id, (int)value);
+            case PackedKind::CONST:
+                return Operand(constants_[value]);
+            case PackedKind::LABEL:
+                return Operand(OperandType::LABEL, value);
+            case PackedKind::NONE:
+            default:
+                return {};
+        }
+    };
+
+    IRCode code;
+    code.reserve(code_.size());
+    for (size_t i = 0; i < code_.size(); ++i) {
+        const PackedInstruction& instr = code_[i];
+        code.emplace_back(instr.op, unpack(instr, PackedInstruction::RESULT), unpack(instr, PackedInstruction::ARG1),
+                          unpack(instr, PackedInstruction::ARG2));
+        code.back().index = (int)i;
+    }
+    return code;
+}
+
+// --- Таблицы ---
+
+uint32_t PackedIR::addConstant(int value) {
+    auto [it, inserted] = constant_ids_.try_emplace(value, (uint32_t)constants_.size());
+    if (inserted) {
+        constants_.push_back(value);
+    }
+    return it->second;
+}
+
+uint32_t PackedIR::addSlot(PackedSlot slot) {
+    slots_.push_back(slot);
+    return (uint32_t)slots_.size() - 1;
+}
+
+void PackedIR::rebuildLabels() {
+    std::fill(labels_.begin(), labels_.end(), NO_TARGET);
+    for (size_t i = 0; i < code_.size(); ++i) {
+        const PackedInstruction& instr = code_[i];
+        if (instr.op == IROpCode::LABEL && instr.kind(PackedInstruction::ARG1) == PackedKind::LABEL) {
+            const uint32_t label = instr.operand(PackedInstruction::ARG1);
+            if (labels_.size() <= label) {
+                labels_.resize((size_t)label + 1, NO_TARGET);
+            }
+            labels_[label] = (uint32_t)i;
+        }
+    }
+}
+
+uint32_t PackedIR::newLabel() {
+    // Метки нумеруются с 1 (L1, L2, ...)
+    if (labels_.empty()) {
+        labels_.push_back(NO_TARGET);
+    }
+    labels_.push_back(NO_TARGET);
+    return (uint32_t)labels_.size() - 1;
+}
+
+size_t PackedIR::memoryBytes() const {
+    return code_.capacity() * sizeof(PackedInstruction) + slots_.capacity() * sizeof(PackedSlot) +
+           constants_.capacity() * sizeof(int) + labels_.capacity() * sizeof(uint32_t);
+}
+
+PackedIRView PackedIR::view() const {
+    const SymbolInterner& interner = SymbolInterner::global();
+    PackedIRView view;
+    view.code = code_.data();
+    view.size = code_.size();
+    view.slots = slots_.data();
+    view.slot_count = slots_.size();
+    view.constants = constants_.data();
+    view.constant_count = constants_.size();
+    view.labels = labels_.data();
+    view.label_count = labels_.size();
+    view.names = interner.nameTable();
+    view.name_count = interner.size();
+    return view;
+}
+
+// --- Вывод ---
+
+void PackedIRView::printSlot(std::ostream& os, uint32_t slot) const {
+    if (slots[slot].type != OperandType::VARIABLE) {
+        os << 'T' << slots[slot].id;
+    } else if (slots[slot].id < name_count) {
+        os << names[slots[slot].id];
+    } else {
+        os << '?';
+    }
+}
+
+void PackedIRView::printOperand(std::ostream& os, const PackedInstruction& instr, int field) const {
+    const uint32_t value = instr.operand(field);
+    switch (instr.kind(field)) {
+        case PackedKind::SLOT:
+            printSlot(os, value);
+            return;
+        case PackedKind::CONST:
+            os << constants[value];
+            return;
+        case PackedKind::LABEL:
+            os << 'L' << value;
+            return;
+        case PackedKind::NONE:
+        default:
+            return;
+    }
+}
+
+void PackedIRView::print(std::ostream& os, size_t index) const {
+    const PackedInstruction& instr = code[index];
+
+    // Метка печатается без индекса: L1: LABEL
+    if (instr.op == IROpCode::LABEL) {
+        printOperand(os, instr, PackedInstruction::ARG1);
+        os << ": " << opCodeToString(instr.op);
+        return;
+    }
+
+    char fill = os.fill('0');
+    os << std::setw(3) << index;
+    os.fill(fill);
+    os << ": ";
+    printInstruction(os, instr, [this](std::ostream& out, const PackedInstruction& in, int field) {
+        printOperand(out, in, field);
+    });
+}
+
+void PackedIRView::print(std::ostream& os) const {
+    for (size_t i = 0; i < size; ++i) {
+        print(os, i);
+        os << '\n';
+    }
+}
@@ -1,7 +1,12 @@
 #include "Parser.h"
+#include "IRGenerator.h"
+#include "SemanticAnalyzer.h"
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
+#include <charconv>
+#include <vector>
+#include <algorithm>
 
 using std::move;
 
@@ -12,17 +17,39 @@ std::ostream& operator<<(std::ostream& os, const TokenType& type) {
     return os;
 }
 
+// Преобразование литерала без промежуточной std::string
+static int parseIntLiteral(std::string_view text) {
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || ptr != text.data() + text.size()) {
+        throw std::out_of_range("Integer literal out of range: " + std::string(text));
+    }
+    return value;
+}
+
 Parser::Parser(Lexer* lexer, ErrorHandler* handler)
     : lexer_(lexer), error_handler_(handler) {
-    current_token_ = lexer_->getNextToken();
+    current_token_ = &lexer_->getNextToken();
 }
 
 void Parser::consume() {
-    current_token_ = lexer_->getNextToken();
+    current_token_ = &lexer_->getNextToken();
+    ++token_position_;
+}
+
+void Parser::seek(size_t token_index) {
+    lexer_->seekToken(token_index);
+    token_position_ = token_index;
+    current_token_ = &lexer_->getNextToken();
+}
+
+bool Parser::isStatementStart() {
+    return check(TokenType::TOKEN_INT) || check(TokenType::TOKEN_IDENTIFIER) ||
+           check(TokenType::TOKEN_PRINT) || check(TokenType::TOKEN_IF) || check(TokenType::TOKEN_WHILE);
 }
 
 bool Parser::check(TokenType type) {
-    return current_token_.type == type;
+    return current_token_->type == type;
 }
 
 void Parser::match(TokenType expected_type) {
@@ -31,16 +58,19 @@ void Parser::match(TokenType expected_type) {
     } else {
         std::stringstream ss;
         ss << "Expected token type " << expected_type
-           << " but found " << current_token_.type
-           << " ('" << current_token_.value << "') at line "
-           << current_token_.line << ", pos " << current_token_.position;
+           << " but found " << current_token_->type
+           << " ('" << current_token_->value << "') at line "
+           << current_token_->line << ", pos " << current_token_->position;
         parseError(ss.str());
     }
 }
 
 void Parser::parseError(const std::string& message) {
     std::string err_msg = "Syntax Error: " + message;
-    error_handler_->registerError("Syntax", err_msg, current_token_.line, current_token_.position);
+    if (speculative_) {
+        throw std::runtime_error(err_msg);
+    }
+    error_handler_->registerError("Syntax", err_msg, current_token_->line, current_token_->position);
     throw std::runtime_error("Parsing aborted due to Syntax Error.");
 }
 
@@ -64,204 +94,643 @@ std::unique_ptr<ASTNode> Parser::parseProgram() {
     }
 }
 
-// Разбор фактора
-std::unique_ptr<ASTNode> Parser::parseFactor() {
-    Token token = current_token_;
-
-    if (check(TokenType::TOKEN_LPAREN)) {
-        match(TokenType::TOKEN_LPAREN);
-        std::unique_ptr<ASTNode> expr = parseExpr();
-        match(TokenType::TOKEN_RPAREN);
-        return expr;
+// Приоритет бинарной операции выражения (0 — не операция)
+static int precedenceOf(TokenType type) {
+    switch (type) {
+        case TokenType::TOKEN_PLUS:
+        case TokenType::TOKEN_MINUS:
+            return 1;
+        case TokenType::TOKEN_MULTIPLY:
+        case TokenType::TOKEN_DIVIDE:
+            return 2;
+        default:
+            return 0;
     }
-    else if (check(TokenType::TOKEN_IDENTIFIER)) {
+}
+
+namespace {
+    // Построитель AST по событиям разбора
+    class AstBuilder {
+    private:
+        std::vector<ProgramNode*> blocks_;               // Открытые блоки (внизу — внешний список)
+        std::vector<std::unique_ptr<ASTNode>> owners_;   // Незавершённые операторы if/while
+
+        void append(std::unique_ptr<ASTNode> stmt, size_t token_count) {
+            blocks_.back()->statements.push_back(move(stmt), (uint32_t)token_count);
+        }
+
+        void closeBlock(size_t token_count) {
+            blocks_.pop_back();
+            std::unique_ptr<ASTNode> owner = move(owners_.back());
+            owners_.pop_back();
+            append(move(owner), token_count);
+        }
+
+    public:
+        using Value = std::unique_ptr<ASTNode>;
+        std::vector<Value> operands;                     // Стек операндов выражения
+
+        explicit AstBuilder(ProgramNode& outer) { blocks_.push_back(&outer); }
+
+        Value literal(int value) { return std::make_unique<IntLiteralNode>(value); }
+        Value identifier(SymbolId name, SourcePos pos) { return std::make_unique<IdentifierNode>(name, pos); }
+        Value binary(TokenType op, Value left, Value right) {
+            return std::make_unique<BinaryOpNode>(op, move(left), move(right));
+        }
+
+        void varDecl(SymbolId name, SourcePos pos, size_t token_count) {
+            append(std::make_unique<VarDeclNode>(name, TokenType::TOKEN_INT, pos), token_count);
+        }
+        void assign(SymbolId name, SourcePos pos, Value value, size_t token_count) {
+            append(std::make_unique<AssignStmtNode>(name, move(value), pos), token_count);
+        }
+        void print(Value value, size_t token_count) {
+            append(std::make_unique<PrintStmtNode>(move(value)), token_count);
+        }
+
+        void beginIf() {}
+        void beginThen(Value condition, uint32_t body_offset) {
+            std::unique_ptr<IfStmtNode> if_node = std::make_unique<IfStmtNode>();
+            if_node->condition = move(condition);
+            if_node->then_body = std::make_unique<ProgramNode>();
+            if_node->then_body->token_offset = body_offset;
+            blocks_.push_back(if_node->then_body.get());
+            owners_.push_back(move(if_node));
+        }
+        void beginElse(uint32_t else_offset) {
+            IfStmtNode* if_node = static_cast<IfStmtNode*>(owners_.back().get());
+            if_node->else_body = std::make_unique<ProgramNode>();
+            if_node->else_body->token_offset = else_offset;
+            blocks_.back() = if_node->else_body.get();
+        }
+        void endIf(size_t token_count) { closeBlock(token_count); }
+
+        void beginWhile() {}
+        void beginWhileBody(Value condition, uint32_t body_offset) {
+            std::unique_ptr<WhileStmtNode> while_node = std::make_unique<WhileStmtNode>();
+            while_node->condition = move(condition);
+            while_node->body = std::make_unique<ProgramNode>();
+            while_node->body->token_offset = body_offset;
+            blocks_.push_back(while_node->body.get());
+            owners_.push_back(move(while_node));
+        }
+        void endWhile(size_t token_count) { closeBlock(token_count); }
+    };
+
+    // Синтаксически управляемая трансляция: IR выдаётся по мере распознавания правил.
+    // Порядок событий совпадает с обходом IRGenerator (метки if/while создаются до
+    // условия, временная переменная — после обоих операндов), поэтому нумерация та же
+    class IrEmitter {
+    private:
+        struct Frame {
+            Operand first_label;    // else (if) или начало цикла (while)
+            Operand end_label;      // Конец оператора
+            bool has_else = false;
+        };
+        IRBuilder& ir_;
+        SemanticAnalyzer* semantics_;   // Проверки и слоты по ходу трансляции (может отсутствовать)
+        std::vector<Frame> frames_;
+
+    public:
+        using Value = Operand;
+        std::vector<Value> operands;
+
+        IrEmitter(IRBuilder& ir, SemanticAnalyzer* semantics) : ir_(ir), semantics_(semantics) {}
+
+        Value literal(int value) { return Operand(value); }
+        Value identifier(SymbolId name, SourcePos pos) {
+            return Operand(OperandType::VARIABLE, name, semantics_ ? semantics_->use(name, pos) : SymbolTable::NO_SLOT);
+        }
+        Value binary(TokenType op, Value left, Value right) { return ir_.emitBinary(op, left, right); }
+
+        void varDecl(SymbolId name, SourcePos pos, size_t) {
+            if (semantics_) {
+                semantics_->declare(name, pos);
+            }
+        }
+        void assign(SymbolId name, SourcePos pos, Value value, size_t) {
+            const int slot = semantics_ ? semantics_->assign(name, pos) : SymbolTable::NO_SLOT;
+            ir_.emitAssign(Operand(OperandType::VARIABLE, name, slot), value);
+        }
+        void print(Value value, size_t) { ir_.emit(IROpCode::PRINT, {}, value); }
+
+        void beginIf() {
+            Operand label_else = ir_.makeLabel();
+            Operand label_end = ir_.makeLabel();
+            frames_.push_back(Frame{move(label_else), move(label_end)});
+        }
+        void beginThen(Value condition, uint32_t) {
+            ir_.emit(IROpCode::JMP_IF_ZERO, {}, condition, frames_.back().first_label);
+            if (semantics_) {
+                semantics_->beginBranch();
+            }
+        }
+        void beginElse(uint32_t) {
+            Frame& frame = frames_.back();
+            ir_.emit(IROpCode::JMP, {}, frame.end_label);
+            ir_.emit(IROpCode::LABEL, {}, frame.first_label);
+            frame.has_else = true;
+            if (semantics_) {
+                semantics_->beginElse();
+            }
+        }
+        void endIf(size_t) {
+            Frame& frame = frames_.back();
+            if (!frame.has_else) {
+                ir_.emit(IROpCode::LABEL, {}, frame.first_label);
+            }
+            ir_.emit(IROpCode::LABEL, {}, frame.end_label);
+            frames_.pop_back();
+            if (semantics_) {
+                semantics_->endIf();
+            }
+        }
+
+        void beginWhile() {
+            Operand label_start = ir_.makeLabel();
+            Operand label_end = ir_.makeLabel();
+            ir_.emit(IROpCode::LABEL, {}, label_start);
+            frames_.push_back(Frame{move(label_start), move(label_end)});
+        }
+        void beginWhileBody(Value condition, uint32_t) {
+            ir_.emit(IROpCode::JMP_IF_ZERO, {}, condition, frames_.back().end_label);
+            if (semantics_) {
+                semantics_->beginLoop();
+            }
+        }
+        void endWhile(size_t) {
+            Frame& frame = frames_.back();
+            ir_.emit(IROpCode::JMP, {}, frame.first_label);
+            ir_.emit(IROpCode::LABEL, {}, frame.end_label);
+            frames_.pop_back();
+            if (semantics_) {
+                semantics_->endWhile();
+            }
+        }
+    };
+
+    // Построитель плоского AST: узлы добавляются в массивы по мере распознавания,
+    // операторы открытых блоков копятся на общем стеке и переносятся при закрытии блока
+    class FlatBuilder {
+    private:
+        struct Frame {
+            FlatAST::NodeIndex condition;
+            FlatAST::NodeIndex then_body = FlatAST::NO_NODE;  // Закрытый блок then (при else)
+            size_t list_start;                                // Начало операторов блока на стеке
+        };
+        FlatAST& ast_;
+        std::vector<FlatAST::NodeIndex> pending_;             // Операторы открытых блоков
+        std::vector<Frame> frames_;
+
+        void append(FlatAST::NodeIndex stmt) { pending_.push_back(stmt); }
+
+        FlatAST::NodeIndex closeList(size_t start) {
+            FlatAST::NodeIndex program = ast_.addProgram(
+                std::span<const FlatAST::NodeIndex>(pending_.data() + start, pending_.size() - start));
+            pending_.resize(start);
+            return program;
+        }
+
+    public:
+        using Value = FlatAST::NodeIndex;
+        std::vector<Value> operands;
+
+        explicit FlatBuilder(FlatAST& ast) : ast_(ast) {}
+
+        // Корень программы из операторов внешнего уровня
+        FlatAST::NodeIndex finish() { return closeList(0); }
+
+        Value literal(int value) { return ast_.addLiteral(value); }
+        Value identifier(SymbolId name, SourcePos pos) { return ast_.addIdentifier(name, pos); }
+        Value binary(TokenType op, Value left, Value right) {
+            return ast_.addNode(FlatNodeKind::BINARY_OP, left, right, (uint32_t)op);
+        }
+
+        void varDecl(SymbolId name, SourcePos pos, size_t) {
+            append(ast_.addNamed(FlatNodeKind::VAR_DECL, name, (uint32_t)TokenType::TOKEN_INT, pos));
+        }
+        void assign(SymbolId name, SourcePos pos, Value value, size_t) {
+            append(ast_.addNamed(FlatNodeKind::ASSIGN_STMT, name, value, pos));
+        }
+        void print(Value value, size_t) { append(ast_.addNode(FlatNodeKind::PRINT_STMT, value)); }
+
+        void beginIf() {}
+        void beginThen(Value condition, uint32_t) { frames_.push_back(Frame{condition, FlatAST::NO_NODE, pending_.size()}); }
+        void beginElse(uint32_t) {
+            Frame& frame = frames_.back();
+            frame.then_body = closeList(frame.list_start);
+        }
+        void endIf(size_t) {
+            Frame frame = frames_.back();
+            frames_.pop_back();
+            FlatAST::NodeIndex last_body = closeList(frame.list_start);
+            if (frame.then_body == FlatAST::NO_NODE) {
+                append(ast_.addNode(FlatNodeKind::IF_STMT, frame.condition, last_body));
+            } else {
+                append(ast_.addNode(FlatNodeKind::IF_STMT, frame.condition, frame.then_body, last_body));
+            }
+        }
+
+        void beginWhile() {}
+        void beginWhileBody(Value condition, uint32_t) { frames_.push_back(Frame{condition, FlatAST::NO_NODE, pending_.size()}); }
+        void endWhile(size_t) {
+            Frame frame = frames_.back();
+            frames_.pop_back();
+            FlatAST::NodeIndex body = closeList(frame.list_start);
+            append(ast_.addNode(FlatNodeKind::WHILE_STMT, frame.condition, body));
+        }
+    };
+}
+
+// Разбор операнда (идентификатор или литерал; скобки обрабатывает parseExprWith)
+template <typename Builder>
+typename Builder::Value Parser::parseFactorWith(Builder& builder) {
+    if (check(TokenType::TOKEN_IDENTIFIER)) {
+        // Значение извлекается до consume(): в потоковом режиме токен перезаписывается
+        typename Builder::Value identifier = builder.identifier(current_token_->symbol, current_token_->where());
         consume();
-        return std::make_unique<IdentifierNode>(token.value);
+        return identifier;
     }
     else if (check(TokenType::TOKEN_INT_LITERAL)) {
+        int value = parseIntLiteral(current_token_->value);
         consume();
-        return std::make_unique<IntLiteralNode>(std::stoi(token.value));
+        return builder.literal(value);
     }
     else {
         parseError("Expected factor (ID, INT_LITERAL, or '(')");
-        return nullptr;
+        return {};
     }
 }
 
-// Разбор терма
-std::unique_ptr<ASTNode> Parser::parseTerm() {
-    std::unique_ptr<ASTNode> left_term = parseFactor();
-    return parseTermRest(move(left_term));
-}
-
-// Продолжение разбора терма
-std::unique_ptr<ASTNode> Parser::parseTermRest(std::unique_ptr<ASTNode> left_term) {
-    if (check(TokenType::TOKEN_MULTIPLY) || check(TokenType::TOKEN_DIVIDE)) {
-        Token op = current_token_;
-        consume();  // Потребляем оператор (* или /)
-        std::unique_ptr<ASTNode> right_factor = parseFactor();
-
-        std::unique_ptr<ASTNode> new_left = std::make_unique<BinaryOpNode>(
-            op.type,
-            move(left_term),
-            move(right_factor)
-        );
-        return parseTermRest(move(new_left));
-    }
-    return left_term;
-}
+// Разбор выражения подъёмом по приоритетам на явных стеках операндов и операций:
+// глубина вызовов не зависит ни от длины цепочки a + b + ..., ни от вложенности скобок.
+// Операции левоассоциативны, дерево совпадает с грамматикой expr -> term {(+|-) term}
+template <typename Builder>
+typename Builder::Value Parser::parseExprWith(Builder& builder) {
+    auto& operands = builder.operands;
+    const size_t operand_base = operands.size();
+    const size_t operator_base = expr_operators_.size();
+    size_t open_parens = 0;
+
+    auto reduce = [&]() {
+        typename Builder::Value right = move(operands.back());
+        operands.pop_back();
+        typename Builder::Value& left = operands.back();
+        left = builder.binary(expr_operators_.back(), move(left), move(right));
+        expr_operators_.pop_back();
+    };
+
+    // При синтаксической ошибке стеки очищаются до исходного уровня
+    struct StackGuard {
+        std::vector<typename Builder::Value>& operands;
+        std::vector<TokenType>& operators;
+        size_t operand_base;
+        size_t operator_base;
+        ~StackGuard() {
+            operands.resize(operand_base);
+            operators.resize(operator_base);
+        }
+    } guard{operands, expr_operators_, operand_base, operator_base};
 
-// Разбор выражения
-std::unique_ptr<ASTNode> Parser::parseExpr() {
-    std::unique_ptr<ASTNode> left_expr = parseTerm();
-    return parseExprRest(move(left_expr));
-}
+    for (;;) {
+        while (check(TokenType::TOKEN_LPAREN)) {
+            consume();
+            expr_operators_.push_back(TokenType::TOKEN_LPAREN);
+            ++open_parens;
+        }
+        operands.push_back(parseFactorWith(builder));
+
+        // После операнда: закрывающие скобки, затем операция или конец выражения
+        int precedence = precedenceOf(current_token_->type);
+        while (precedence == 0 && open_parens > 0) {
+            match(TokenType::TOKEN_RPAREN);
+            while (expr_operators_.back() != TokenType::TOKEN_LPAREN) {
+                reduce();
+            }
+            expr_operators_.pop_back();
+            --open_parens;
+            precedence = precedenceOf(current_token_->type);
+        }
+        if (precedence == 0) {
+            break;
+        }
 
-// Продолжение разбора выражения
-std::unique_ptr<ASTNode> Parser::parseExprRest(std::unique_ptr<ASTNode> left_expr) {
-    if (check(TokenType::TOKEN_PLUS) || check(TokenType::TOKEN_MINUS)) {
-        Token op = current_token_;
+        while (expr_operators_.size() > operator_base && precedenceOf(expr_operators_.back()) >= precedence) {
+            reduce();
+        }
+        expr_operators_.push_back(current_token_->type);
         consume();
+    }
 
-        std::unique_ptr<ASTNode> right_term = parseTerm();
-
-        std::unique_ptr<ASTNode> new_left = std::make_unique<BinaryOpNode>(
-            op.type,
-            move(left_expr),
-            move(right_term)
-        );
-        return parseExprRest(move(new_left));
+    while (expr_operators_.size() > operator_base) {
+        reduce();
     }
-    return left_expr;
+    return move(operands.back());
 }
 
 // Разбор условия
-std::unique_ptr<ASTNode> Parser::parseCondition() {
-    std::unique_ptr<ASTNode> left_expr = parseExpr();
+template <typename Builder>
+typename Builder::Value Parser::parseConditionWith(Builder& builder) {
+    typename Builder::Value left_expr = parseExprWith(builder);
 
     if (check(TokenType::TOKEN_EQUAL) || check(TokenType::TOKEN_LESS) ||
         check(TokenType::TOKEN_GREATER) || check(TokenType::TOKEN_NOT_EQUAL)) {
 
-        Token op = current_token_;
+        TokenType op = current_token_->type;
         consume();
 
-        std::unique_ptr<ASTNode> right_expr = parseExpr();
-
-        return std::make_unique<BinaryOpNode>(
-            op.type,
-            move(left_expr),
-            move(right_expr)
-        );
+        typename Builder::Value right_expr = parseExprWith(builder);
+        return builder.binary(op, move(left_expr), move(right_expr));
     }
     else {
         parseError("Expected relational operator ('==', '!=', '<', or '>') in condition.");
-        return nullptr;
+        return {};
     }
 }
 
-// Разбор else-ветки
-std::unique_ptr<ASTNode> Parser::parseStmtElse() {
-    if (check(TokenType::TOKEN_ELSE)) {
-        match(TokenType::TOKEN_ELSE);
-        match(TokenType::TOKEN_LBRACE);
-        std::unique_ptr<ASTNode> else_body = parseStmtList();
+// Разбор последовательности операторов. Вложенные блоки if/while не вызывают рекурсию:
+// открытый блок кладётся на явный стек, а построитель получает события начала и конца
+// конструкций. single_statement — разобрать ровно один оператор внешнего уровня
+template <typename Builder>
+void Parser::parseStatementsWith(Builder& builder, bool single_statement) {
+    std::vector<BlockFrame> stack;
+    stack.push_back(BlockFrame{BlockKind::OUTER, 0, 0});
+
+    for (;;) {
+        if (single_statement && stack.size() == 1 && stack.back().statement_count > 0) {
+            return;
+        }
+
+        if (isStatementStart()) {
+            const size_t stmt_start = token_position_;
+
+            if (check(TokenType::TOKEN_IF)) {
+                match(TokenType::TOKEN_IF);
+                builder.beginIf();
+                match(TokenType::TOKEN_LPAREN);
+                typename Builder::Value condition = parseConditionWith(builder);
+                match(TokenType::TOKEN_RPAREN);
+                match(TokenType::TOKEN_LBRACE);
+                builder.beginThen(move(condition), (uint32_t)(token_position_ - stmt_start));
+                stack.push_back(BlockFrame{BlockKind::IF_THEN, stmt_start, 0});
+            }
+            else if (check(TokenType::TOKEN_WHILE)) {
+                match(TokenType::TOKEN_WHILE);
+                builder.beginWhile();
+                match(TokenType::TOKEN_LPAREN);
+                typename Builder::Value condition = parseConditionWith(builder);
+                match(TokenType::TOKEN_RPAREN);
+                match(TokenType::TOKEN_LBRACE);
+                builder.beginWhileBody(move(condition), (uint32_t)(token_position_ - stmt_start));
+                stack.push_back(BlockFrame{BlockKind::WHILE, stmt_start, 0});
+            }
+            else if (check(TokenType::TOKEN_INT)) {
+                match(TokenType::TOKEN_INT);
+                const SymbolId name = current_token_->symbol;
+                const SourcePos name_pos = current_token_->where();
+                match(TokenType::TOKEN_IDENTIFIER);
+                match(TokenType::TOKEN_SEMICOLON);
+                builder.varDecl(name, name_pos, token_position_ - stmt_start);
+                ++stack.back().statement_count;
+            }
+            else if (check(TokenType::TOKEN_IDENTIFIER)) {
+                const SymbolId name = current_token_->symbol;
+                const SourcePos name_pos = current_token_->where();
+                match(TokenType::TOKEN_IDENTIFIER);
+                match(TokenType::TOKEN_ASSIGN);
+                typename Builder::Value expr = parseExprWith(builder);
+                match(TokenType::TOKEN_SEMICOLON);
+                builder.assign(name, name_pos, move(expr), token_position_ - stmt_start);
+                ++stack.back().statement_count;
+            }
+            else {
+                match(TokenType::TOKEN_PRINT);
+                typename Builder::Value expr = parseExprWith(builder);
+                match(TokenType::TOKEN_SEMICOLON);
+                builder.print(move(expr), token_position_ - stmt_start);
+                ++stack.back().statement_count;
+            }
+            continue;
+        }
+
+        // Первый оператор блока обязателен, если блок не пуст
+        if ((stack.back().statement_count == 0 && !check(TokenType::TOKEN_RBRACE) && !check(TokenType::TOKEN_EOF)) ||
+            (single_statement && stack.size() == 1)) {
+            parseError("Expected statement (INT, ID, PRINT, IF, or WHILE)");
+        }
+
+        // Конец внешнего списка: '}' или EOF проверяет вызывающий
+        if (stack.size() == 1) {
+            return;
+        }
+
         match(TokenType::TOKEN_RBRACE);
-        return else_body;
+        BlockFrame& frame = stack.back();
+
+        // После ветки then может следовать else: блок else начинается после 'else' и '{'
+        if (frame.kind == BlockKind::IF_THEN && check(TokenType::TOKEN_ELSE)) {
+            const size_t else_offset = token_position_ + 2 - frame.owner_start;
+            match(TokenType::TOKEN_ELSE);
+            match(TokenType::TOKEN_LBRACE);
+            builder.beginElse((uint32_t)else_offset);
+            frame.kind = BlockKind::IF_ELSE;
+            frame.statement_count = 0;
+            continue;
+        }
+
+        const size_t token_count = token_position_ - frame.owner_start;
+        if (frame.kind == BlockKind::WHILE) {
+            builder.endWhile(token_count);
+        } else {
+            builder.endIf(token_count);
+        }
+        stack.pop_back();
+        ++stack.back().statement_count;
     }
-    return nullptr;
 }
 
-// Разбор оператора
+// Разбор одного оператора
 std::unique_ptr<ASTNode> Parser::parseStmt() {
-    if (check(TokenType::TOKEN_INT)) {
-        match(TokenType::TOKEN_INT);
-        Token id_token = current_token_;
-        match(TokenType::TOKEN_IDENTIFIER);
-        match(TokenType::TOKEN_SEMICOLON);
-        return std::make_unique<VarDeclNode>(id_token.value, TokenType::TOKEN_INT);
-    }
-    else if (check(TokenType::TOKEN_IDENTIFIER)) {
-        Token id_token = current_token_;
-        match(TokenType::TOKEN_IDENTIFIER);
-        match(TokenType::TOKEN_ASSIGN);
-
-        std::unique_ptr<ASTNode> expr = parseExpr();
-        match(TokenType::TOKEN_SEMICOLON);
-        return std::make_unique<AssignStmtNode>(id_token.value, move(expr));
-    }
-    else if (check(TokenType::TOKEN_PRINT)) {
-        match(TokenType::TOKEN_PRINT);
-        std::unique_ptr<ASTNode> expr = parseExpr();
-        match(TokenType::TOKEN_SEMICOLON);
-        return std::make_unique<PrintStmtNode>(move(expr));
-    }
-    else if (check(TokenType::TOKEN_IF)) {
-        match(TokenType::TOKEN_IF);
-        match(TokenType::TOKEN_LPAREN);
-        std::unique_ptr<ASTNode> condition = parseCondition();
-        match(TokenType::TOKEN_RPAREN);
-        match(TokenType::TOKEN_LBRACE);
-
-        std::unique_ptr<ProgramNode> then_body(dynamic_cast<ProgramNode*>(parseStmtList().release()));
-        match(TokenType::TOKEN_RBRACE);
+    ProgramNode holder;
+    AstBuilder builder(holder);
+    parseStatementsWith(builder, true);
+    return move(holder.statements.front());
+}
 
-        std::unique_ptr<ASTNode> else_body_ast = parseStmtElse();
+// Разбор списка операторов
+std::unique_ptr<ASTNode> Parser::parseStmtList() {
+    std::unique_ptr<ProgramNode> list_node = std::make_unique<ProgramNode>();
+    AstBuilder builder(*list_node);
+    parseStatementsWith(builder, false);
+    return list_node;
+}
 
-        std::unique_ptr<IfStmtNode> if_node = std::make_unique<IfStmtNode>();
-        if_node->condition = move(condition);
-        if_node->then_body = move(then_body);
-        if_node->else_body.reset(dynamic_cast<ProgramNode*>(else_body_ast.release()));
+// Однопроходная трансляция программы в IR без построения AST
+bool Parser::translateProgram(IRCode& ir_code, SemanticAnalyzer* semantics) {
+    try {
+        std::cout << "[INFO] Starting Single-Pass Translation (Parsing to IR)...\n";
+        IRBuilder ir;
+        ir.setSymbols(semantics ? &semantics->symbols() : nullptr);
+        IrEmitter emitter(ir, semantics);
+        parseStatementsWith(emitter, false);
 
-        return if_node;
+        if (check(TokenType::TOKEN_EOF)) {
+            match(TokenType::TOKEN_EOF);
+            std::cout << "[INFO] Translation completed successfully (EOF matched).\n";
+            if (semantics) {
+                semantics->finish();
+            }
+            ir_code = ir.finish();
+            return true;
+        } else {
+            parseError("Expected EOF, but found more tokens.");
+            return false;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Parser error caught: " << e.what() << "\n";
+        return false;
     }
-    else if (check(TokenType::TOKEN_WHILE)) {
-        match(TokenType::TOKEN_WHILE);
-        match(TokenType::TOKEN_LPAREN);
-        std::unique_ptr<ASTNode> condition = parseCondition();
-        match(TokenType::TOKEN_RPAREN);
-        match(TokenType::TOKEN_LBRACE);
-
-        std::unique_ptr<ProgramNode> body(dynamic_cast<ProgramNode*>(parseStmtList().release()));
-        match(TokenType::TOKEN_RBRACE);
+}
+
+// Разбор программы в плоское представление AST
+bool Parser::parseProgramFlat(FlatAST& ast) {
+    ast.clear();
+    try {
+        std::cout << "[INFO] Starting Recursive Descent Parsing (Flat AST)...\n";
+        FlatBuilder builder(ast);
+        parseStatementsWith(builder, false);
 
-        std::unique_ptr<WhileStmtNode> while_node = std::make_unique<WhileStmtNode>();
-        while_node->condition = move(condition);
-        while_node->body = move(body);
-        return while_node;
+        if (check(TokenType::TOKEN_EOF)) {
+            match(TokenType::TOKEN_EOF);
+            std::cout << "[INFO] Parsing completed successfully (EOF matched).\n";
+            ast.setRoot(builder.finish());
+            return true;
+        } else {
+            parseError("Expected EOF, but found more tokens.");
+            return false;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Parser error caught: " << e.what() << "\n";
+        return false;
     }
-    else {
-        parseError("Expected statement (INT, ID, PRINT, IF, or WHILE)");
-        return nullptr;
+}
+
+// Инкрементальный разбор: начиная с корня, выбирается наименьший блок, целиком
+// содержащий изменённые токены. Пробный разбор не регистрирует ошибки; при неудаче
+// выполняется полный разбор, который сообщает о них обычным образом. Дерево есть только
+// после разбора без ошибок, поэтому прежние синтаксические ошибки снимаются лишь перед
+// полным разбором
+bool Parser::reparse(std::unique_ptr<ASTNode>& root, const RelexResult& damage) {
+    if (root && root->node_kind == ASTNodeKind::PROGRAM) {
+        ProgramNode* program = static_cast<ProgramNode*>(root.get());
+        speculative_ = true;
+        const bool reused = reparseBlock(*program, 0, damage);
+        speculative_ = false;
+        if (reused) {
+            return true;
+        }
     }
+
+    // Полный разбор сообщает о синтаксических ошибках заново
+    error_handler_->retractErrors("Syntax");
+    seek(0);
+    root = parseProgram();
+    return false;
 }
 
-// Разбор списка операторов
-std::unique_ptr<ASTNode> Parser::parseStmtList() {
-    if (check(TokenType::TOKEN_RBRACE) || check(TokenType::TOKEN_EOF)) {
-        return std::make_unique<ProgramNode>();
+// Переиспользованные операторы начиная с from_stmt (from_token — его первый токен в новой
+// нумерации) лежат после окна правки: их позиции сдвигаются так же, как их токены
+static void shiftReused(StatementList& statements, size_t from_stmt, size_t from_token, const RelexResult& damage) {
+    statements.shiftLines(from_stmt, damage.line_delta);
+    statements.shiftColumns(from_stmt, from_token, damage.line_end_token, damage.sync_line, damage.column_delta);
+}
+
+// Повторный разбор внутри блока, занимающего токены начиная с block_begin.
+// Если правка целиком внутри тела единственного затронутого оператора if/while,
+// разбор спускается в это тело; иначе заново разбираются затронутые операторы
+// блока, и результат принимается, только если он заканчивается ровно на сдвинутой
+// границе последнего из них
+bool Parser::reparseBlock(ProgramNode& block, size_t block_begin, const RelexResult& damage) {
+    const size_t first = damage.first_token;
+    const size_t old_end = damage.old_end_token;
+    const std::ptrdiff_t delta = (std::ptrdiff_t)damage.new_end_token - (std::ptrdiff_t)old_end;
+    StatementList& statements = block.statements;
+    const size_t count = statements.size();
+    if (first < block_begin) {
+        return false;
     }
 
-    std::unique_ptr<ASTNode> first_stmt = parseStmt();
-    std::unique_ptr<ProgramNode> list_node = std::make_unique<ProgramNode>();
-    if (first_stmt) {
-        list_node->statements.push_back(move(first_stmt));
+    // Затронутые операторы [first_stmt, end_stmt): от содержащего токен first до
+    // содержащего токен old_end - 1. Пустое старое окно на границе оператора — чистая
+    // вставка перед ним (например, в начало файла): старые операторы не заменяются
+    size_t first_start = 0;
+    const size_t first_stmt = statements.find(first - block_begin, first_start);
+    first_start += block_begin;
+    if (first_stmt == count) {
+        return false;
+    }
+    size_t end_stmt = first_stmt;
+    size_t last_end = first_start;
+    if (old_end > first || first_start != first) {
+        size_t last_start = 0;
+        const size_t last_stmt = statements.find(std::max(old_end, first + 1) - 1 - block_begin, last_start);
+        if (last_stmt == count) {
+            return false;
+        }
+        end_stmt = last_stmt + 1;
+        last_end = block_begin + last_start + statements.tokenCount(last_stmt);
     }
 
-    return parseStmtListRest(move(list_node));
-}
+    if (end_stmt == first_stmt + 1) {
+        ASTNode* stmt = statements[first_stmt].get();
+        ProgramNode* bodies[2] = {nullptr, nullptr};
+        if (stmt->node_kind == ASTNodeKind::IF_STMT) {
+            IfStmtNode* if_node = static_cast<IfStmtNode*>(stmt);
+            bodies[0] = if_node->then_body.get();
+            bodies[1] = if_node->else_body.get();
+        } else if (stmt->node_kind == ASTNodeKind::WHILE_STMT) {
+            bodies[0] = static_cast<WhileStmtNode*>(stmt)->body.get();
+        }
 
-// Продолжение разбора списка операторов
-std::unique_ptr<ASTNode> Parser::parseStmtListRest(std::unique_ptr<ASTNode> current_list) {
-    if (check(TokenType::TOKEN_INT) || check(TokenType::TOKEN_IDENTIFIER) ||
-        check(TokenType::TOKEN_PRINT) || check(TokenType::TOKEN_IF) || check(TokenType::TOKEN_WHILE)) {
+        for (int i = 0; i < 2; ++i) {
+            ProgramNode* body = bodies[i];
+            if (!body) {
+                continue;
+            }
+            const size_t body_begin = first_start + body->token_offset;
+            if (body_begin <= first && old_end <= body_begin + body->tokenCount() &&
+                reparseBlock(*body, body_begin, damage)) {
+                statements.setTokenCount(first_stmt, (uint32_t)((std::ptrdiff_t)statements.tokenCount(first_stmt) + delta));
+                if (i == 0 && bodies[1]) {
+                    bodies[1]->token_offset = (uint32_t)((std::ptrdiff_t)bodies[1]->token_offset + delta);
+                    shiftReused(bodies[1]->statements, 0, first_start + bodies[1]->token_offset, damage);
+                }
+                shiftReused(statements, first_stmt + 1, first_start + statements.tokenCount(first_stmt), damage);
+                return true;
+            }
+        }
+    }
 
-        std::unique_ptr<ASTNode> next_stmt = parseStmt();
-        ProgramNode* list_ptr = dynamic_cast<ProgramNode*>(current_list.get());
-        if (list_ptr && next_stmt) {
-            list_ptr->statements.push_back(move(next_stmt));
+    const size_t new_end = (size_t)((std::ptrdiff_t)last_end + delta);
+    std::vector<std::unique_ptr<ASTNode>> fresh;
+    std::vector<uint32_t> fresh_counts;
+    seek(first_start);
+    try {
+        while (token_position_ < new_end && isStatementStart()) {
+            const size_t stmt_start = token_position_;
+            fresh.push_back(parseStmt());
+            fresh_counts.push_back((uint32_t)(token_position_ - stmt_start));
         }
-        return parseStmtListRest(move(current_list));
+    } catch (const std::runtime_error&) {
+        return false;   // Блок уровнем выше попробует разобрать больший диапазон
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    if (token_position_ != new_end) {
+        return false;
     }
 
-    return current_list;
-}
\ No newline at end of file
+    statements.replace(first_stmt, end_stmt, fresh, fresh_counts);
+    shiftReused(statements, first_stmt + fresh.size(), new_end, damage);
+    return true;
+}
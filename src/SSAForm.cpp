@@ -0,0 +1,841 @@
+#include "SSAForm.h"
+#include <algorithm>
+#include <map>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    using P = PackedInstruction;
+    constexpr uint32_t NONE = UINT32_MAX;
+
+    // Поле результата определяет слот (значение), поля аргументов его читают
+    bool definesSlot(const PackedInstruction& instr) {
+        return instr.kind(P::RESULT) == PackedKind::SLOT;
+    }
+
+    template <typename F>
+    void forEachUse(PackedInstruction& instr, F&& use) {
+        for (int field : {P::ARG1, P::ARG2}) {
+            if (instr.kind(field) == PackedKind::SLOT) {
+                use(instr.operands[field]);
+            }
+        }
+    }
+
+    // Группировка пар (ключ, элемент) по ключу: элементы ключа k — [offsets[k], offsets[k + 1])
+    void groupByKey(const std::pmr::vector<std::pair<uint32_t, uint32_t>>& pairs, size_t key_count,
+                    std::pmr::vector<uint32_t>& offsets, std::pmr::vector<uint32_t>& items) {
+        offsets.assign(key_count + 1, 0);
+        for (const auto& [key, item] : pairs) {
+            ++offsets[key + 1];
+        }
+        for (size_t k = 0; k < key_count; ++k) {
+            offsets[k + 1] += offsets[k];
+        }
+        items.resize(pairs.size());
+        std::pmr::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (const auto& [key, item] : pairs) {
+            items[fill[key]++] = item;
+        }
+    }
+
+    PackedInstruction copyInstruction(uint32_t result, const PhiOperand& source) {
+        PackedInstruction instr;
+        instr.op = source.kind == PackedKind::CONST ? IROpCode::LOAD_IMM : IROpCode::ASSIGN;
+        instr.set(P::RESULT, PackedKind::SLOT, result);
+        instr.set(P::ARG1, source.kind, source.value);
+        return instr;
+    }
+}
+
+SSAForm::SSAForm(ControlFlowGraph& cfg, PackedIR& code) : cfg_(cfg), code_(code) {
+    const uint32_t slot_count = (uint32_t)code_.slotCount();
+    values_.resize(slot_count);
+    for (uint32_t slot = 0; slot < slot_count; ++slot) {
+        values_[slot] = SSAValue{slot, 0};
+    }
+    next_version_.assign(slot_count, 1);
+    entry_values_ = slot_count;
+    placePhis();
+    rename();
+}
+
+uint32_t SSAForm::newValue(uint32_t slot) {
+    values_.push_back(SSAValue{slot, next_version_[slot]++});
+    return (uint32_t)values_.size() - 1;
+}
+
+uint32_t SSAForm::addTemporary() {
+    if (next_temp_ == 0) {
+        next_temp_ = 1;
+        for (const PackedSlot& slot : code_.slots()) {
+            if (slot.type == OperandType::TEMPORARY) {
+                next_temp_ = std::max(next_temp_, slot.id + 1);
+            }
+        }
+    }
+    const uint32_t slot = code_.addSlot(PackedSlot{OperandType::TEMPORARY, next_temp_++});
+    next_version_.push_back(1);
+    return newValue(slot);
+}
+
+// --- Построение ---
+
+// φ-функция слота ставится в блоки итерированной границы доминирования его
+// определений, но только если слот там жив на входе (иначе она была бы мёртвой)
+void SSAForm::placePhis() {
+    const uint32_t block_count = (uint32_t)cfg_.blockCount();
+    const uint32_t slot_count = (uint32_t)code_.slotCount();
+
+    // Блоки с определениями слота и блоки, где слот читается до определения
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> def_pairs;
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> use_pairs;
+    std::pmr::vector<uint32_t> defined_in(slot_count, NONE);
+    std::pmr::vector<uint32_t> used_in(slot_count, NONE);
+    for (uint32_t b : cfg_.reversePostorder()) {
+        BasicBlock& block = cfg_.block(b);
+        auto use = [&](uint32_t& slot) {
+            if (defined_in[slot] != b && used_in[slot] != b) {
+                used_in[slot] = b;
+                use_pairs.emplace_back(slot, b);
+            }
+        };
+        for (PackedInstruction& instr : block.code) {
+            forEachUse(instr, use);
+            if (definesSlot(instr)) {
+                const uint32_t slot = instr.operand(P::RESULT);
+                if (defined_in[slot] != b) {
+                    defined_in[slot] = b;
+                    def_pairs.emplace_back(slot, b);
+                }
+            }
+        }
+        if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+            use(block.branch.operands[P::ARG1]);
+        }
+    }
+    std::pmr::vector<uint32_t> def_offsets, def_blocks, use_offsets, use_blocks;
+    groupByKey(def_pairs, slot_count, def_offsets, def_blocks);
+    groupByKey(use_pairs, slot_count, use_offsets, use_blocks);
+
+    // Границы доминирования: от каждого предшественника блока слияния вверх по дереву
+    // доминаторов до непосредственного доминатора блока
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> frontier_pairs;
+    std::pmr::vector<uint32_t> last_join(block_count, NONE);
+    for (uint32_t b : cfg_.reversePostorder()) {
+        const auto preds = cfg_.predecessors(b);
+        if (preds.size() < 2) {
+            continue;
+        }
+        for (uint32_t p : preds) {
+            if (!cfg_.reachable(p)) {
+                continue;
+            }
+            for (uint32_t runner = p; runner != cfg_.idom(b); runner = cfg_.idom(runner)) {
+                if (last_join[runner] != b) {
+                    last_join[runner] = b;
+                    frontier_pairs.emplace_back(runner, b);
+                }
+            }
+        }
+    }
+    std::pmr::vector<uint32_t> frontier_offsets, frontier;
+    groupByKey(frontier_pairs, block_count, frontier_offsets, frontier);
+
+    // Отметки по номеру текущего слота (без очистки между слотами)
+    std::pmr::vector<uint32_t> def_mark(block_count, NONE);
+    std::pmr::vector<uint32_t> live_mark(block_count, NONE);
+    std::pmr::vector<uint32_t> phi_mark(block_count, NONE);
+    std::pmr::vector<uint32_t> work_mark(block_count, NONE);
+    std::pmr::vector<uint32_t> worklist;
+    for (uint32_t slot = 0; slot < slot_count; ++slot) {
+        // Слот, который читается только после записи в том же блоке (как большинство
+        // временных), ни на каком входе в блок не жив и φ-функций не получает
+        if (def_offsets[slot] == def_offsets[slot + 1] || use_offsets[slot] == use_offsets[slot + 1]) {
+            continue;
+        }
+
+        // Блоки, на входе в которые слот жив
+        for (uint32_t i = def_offsets[slot]; i < def_offsets[slot + 1]; ++i) {
+            def_mark[def_blocks[i]] = slot;
+        }
+        for (uint32_t i = use_offsets[slot]; i < use_offsets[slot + 1]; ++i) {
+            live_mark[use_blocks[i]] = slot;
+            worklist.push_back(use_blocks[i]);
+        }
+        while (!worklist.empty()) {
+            const uint32_t b = worklist.back();
+            worklist.pop_back();
+            for (uint32_t p : cfg_.predecessors(b)) {
+                if (cfg_.reachable(p) && def_mark[p] != slot && live_mark[p] != slot) {
+                    live_mark[p] = slot;
+                    worklist.push_back(p);
+                }
+            }
+        }
+
+        // Итерированная граница доминирования определений. Блок без φ-функции (слот там
+        // мёртв) дальше не распространяется: любой путь из него к блоку, где слот жив,
+        // проходит через другое определение, и оно уже в рабочем списке
+        for (uint32_t i = def_offsets[slot]; i < def_offsets[slot + 1]; ++i) {
+            work_mark[def_blocks[i]] = slot;
+            worklist.push_back(def_blocks[i]);
+        }
+        while (!worklist.empty()) {
+            const uint32_t x = worklist.back();
+            worklist.pop_back();
+            for (uint32_t i = frontier_offsets[x]; i < frontier_offsets[x + 1]; ++i) {
+                const uint32_t y = frontier[i];
+                if (phi_mark[y] == slot) {
+                    continue;
+                }
+                phi_mark[y] = slot;
+                if (live_mark[y] != slot) {
+                    continue;
+                }
+                // До переименования результат и аргументы — значения версии 0 (номер слота)
+                cfg_.block(y).phis.push_back(PhiNode{slot, std::pmr::vector<PhiOperand>(
+                    cfg_.predecessors(y).size(), PhiOperand{PackedKind::SLOT, slot})});
+                ++phi_count_;
+                if (work_mark[y] != slot) {
+                    work_mark[y] = slot;
+                    worklist.push_back(y);
+                }
+            }
+        }
+    }
+}
+
+// Переименование обходом дерева доминаторов: текущее значение слота хранится в
+// current, при выходе из поддерева прежние значения восстанавливаются из журнала.
+// Недостижимые блоки не переименовываются: их операнды остаются значениями версии 0
+void SSAForm::rename() {
+    const uint32_t slot_count = (uint32_t)code_.slotCount();
+    std::pmr::vector<uint32_t> current(slot_count);
+    std::iota(current.begin(), current.end(), 0u);
+
+    struct Saved {
+        uint32_t slot;
+        uint32_t value;
+    };
+    std::pmr::vector<Saved> saved;
+    auto define = [&](uint32_t slot) {
+        const uint32_t value = newValue(slot);
+        saved.push_back(Saved{slot, current[slot]});
+        current[slot] = value;
+        return value;
+    };
+
+    struct Frame {
+        uint32_t block;
+        uint32_t next_child;
+        size_t saved_mark;
+    };
+    std::pmr::vector<Frame> stack;
+    auto enter = [&](uint32_t b) {
+        stack.push_back(Frame{b, 0, saved.size()});
+        BasicBlock& block = cfg_.block(b);
+        for (PhiNode& phi : block.phis) {
+            phi.result = define(values_[phi.result].slot);
+        }
+        for (PackedInstruction& instr : block.code) {
+            forEachUse(instr, [&current](uint32_t& slot) { slot = current[slot]; });
+            if (definesSlot(instr)) {
+                instr.operands[P::RESULT] = define(instr.operand(P::RESULT));
+            }
+        }
+        if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+            block.branch.operands[P::ARG1] = current[block.branch.operand(P::ARG1)];
+        }
+
+        // Аргументы φ-функций преемников по рёбрам из этого блока
+        for (uint32_t successor : {block.next, block.isConditional() ? block.target : ControlFlowGraph::NO_BLOCK}) {
+            if (successor == ControlFlowGraph::NO_BLOCK) {
+                continue;
+            }
+            const auto preds = cfg_.predecessors(successor);
+            for (PhiNode& phi : cfg_.block(successor).phis) {
+                const uint32_t slot = values_[phi.result].slot;
+                for (size_t i = 0; i < preds.size(); ++i) {
+                    if (preds[i] == b) {
+                        phi.args[i] = PhiOperand{PackedKind::SLOT, current[slot]};
+                    }
+                }
+            }
+        }
+    };
+
+    enter(cfg_.entry());
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const auto children = cfg_.dominatorChildren(frame.block);
+        if (frame.next_child < children.size()) {
+            enter(children[frame.next_child++]);
+            continue;
+        }
+        while (saved.size() > frame.saved_mark) {
+            current[saved.back().slot] = saved.back().value;
+            saved.pop_back();
+        }
+        stack.pop_back();
+    }
+}
+
+// --- Вывод ---
+
+void SSAForm::print(std::ostream& os) const {
+    const PackedIRView view = code_.view();
+    auto printValue = [&](std::ostream& out, uint32_t value) {
+        view.printSlot(out, values_[value].slot);
+        out << '.' << values_[value].version;
+    };
+    auto printOperand = [&](std::ostream& out, const PackedInstruction& instr, int field) {
+        const uint32_t value = instr.operand(field);
+        switch (instr.kind(field)) {
+            case PackedKind::SLOT:
+                printValue(out, value);
+                return;
+            case PackedKind::CONST:
+                out << code_.constant(value);
+                return;
+            case PackedKind::LABEL:
+                out << 'L' << value;
+                return;
+            case PackedKind::NONE:
+            default:
+                return;
+        }
+    };
+
+    for (uint32_t b = 0; b < cfg_.blockCount(); ++b) {
+        const BasicBlock& block = cfg_.block(b);
+        os << 'B' << b;
+        if (block.label != BasicBlock::NO_LABEL) {
+            os << " (L" << block.label << ")";
+        }
+        os << ':';
+        if (!cfg_.reachable(b)) {
+            os << "  ; unreachable";
+        } else if (!cfg_.predecessors(b).empty()) {
+            os << "  ; preds";
+            for (uint32_t p : cfg_.predecessors(b)) {
+                os << " B" << p;
+            }
+        }
+        os << '\n';
+
+        const auto preds = cfg_.predecessors(b);
+        for (const PhiNode& phi : block.phis) {
+            os << "    ";
+            printValue(os, phi.result);
+            os << " = PHI(";
+            for (size_t i = 0; i < phi.args.size(); ++i) {
+                os << (i ? ", " : "");
+                if (phi.args[i].kind == PackedKind::CONST) {
+                    os << code_.constant(phi.args[i].value);
+                } else {
+                    printValue(os, phi.args[i].value);
+                }
+                os << " [B" << preds[i] << "]";
+            }
+            os << ")\n";
+        }
+        for (const PackedInstruction& instr : block.code) {
+            os << "    ";
+            PackedIRView::printInstruction(os, instr, printOperand);
+            os << '\n';
+        }
+        if (block.isConditional()) {
+            os << "    JMP_IF_ZERO ";
+            printOperand(os, block.branch, P::ARG1);
+            os << ", B" << block.target << '\n';
+        }
+        if (block.next != ControlFlowGraph::NO_BLOCK) {
+            os << "    JMP B" << block.next << '\n';
+        }
+    }
+}
+
+// --- Выход из SSA ---
+
+void SSAForm::destruct() {
+    const uint32_t block_count = (uint32_t)cfg_.blockCount();
+    const uint32_t slot_count = (uint32_t)code_.slotCount();
+    const uint32_t first_copy_value = (uint32_t)values_.size();
+
+    // 1. Копии φ-функций: x' = φ(a'_1, ..., a'_n), a'_i = a_i в конце предшественников,
+    // x = x' в начале блока. Новые значения живут только на своих рёбрах, поэтому
+    // φ-функция и её аргументы заведомо получают общий слот
+    for (uint32_t b : cfg_.reversePostorder()) {
+        BasicBlock& block = cfg_.block(b);
+        if (block.phis.empty()) {
+            continue;
+        }
+        const auto preds = cfg_.predecessors(b);
+        std::pmr::vector<PackedInstruction> entry_copies;
+        for (PhiNode& phi : block.phis) {
+            const uint32_t slot = values_[phi.result].slot;
+            const uint32_t resource = newValue(slot);
+            entry_copies.push_back(copyInstruction(phi.result, PhiOperand{PackedKind::SLOT, resource}));
+            phi.result = resource;
+            for (size_t i = 0; i < preds.size(); ++i) {
+                if (!cfg_.reachable(preds[i])) {
+                    continue;
+                }
+                // Кратное ребро: копия уже вставлена по первому вхождению предшественника
+                const size_t first = (size_t)(std::find(preds.begin(), preds.end(), preds[i]) - preds.begin());
+                if (first < i) {
+                    phi.args[i] = phi.args[first];
+                    continue;
+                }
+                const uint32_t arg_copy = newValue(slot);
+                cfg_.block(preds[i]).code.push_back(copyInstruction(arg_copy, phi.args[i]));
+                phi.args[i] = PhiOperand{PackedKind::SLOT, arg_copy};
+                ++copies_inserted_;
+            }
+        }
+        block.code.insert(block.code.begin(), entry_copies.begin(), entry_copies.end());
+        copies_inserted_ += entry_copies.size();
+    }
+
+    // 2. Интервалы жизни в сквозной нумерации позиций: у инструкции k блока чтение в
+    // start + 2k, запись в start + 2k + 1, переход блока читает в start + 2 * size,
+    // аргументы φ-функций преемников — в последней позиции блока. Значения версии 0
+    // определены в позиции 0, φ-функции — в первой позиции блока
+    const uint32_t value_count = (uint32_t)values_.size();
+    std::pmr::vector<uint32_t> block_start(block_count, 0);
+    std::pmr::vector<uint32_t> block_end(block_count, 0);
+    uint32_t position = 1;
+    for (uint32_t b = 0; b < block_count; ++b) {
+        if (cfg_.reachable(b)) {
+            block_start[b] = position;
+            position += 2 * ((uint32_t)cfg_.block(b).code.size() + 1);
+            block_end[b] = position - 1;
+        }
+    }
+
+    std::pmr::vector<uint32_t> def_block(value_count, NONE);
+    std::pmr::vector<uint32_t> def_position(value_count, 0);
+    std::fill(def_block.begin(), def_block.begin() + entry_values_, cfg_.entry());
+
+    // Обход определений и чтений достижимого кода
+    auto scan = [&](auto&& on_def, auto&& on_use) {
+        for (uint32_t b = 0; b < block_count; ++b) {
+            if (!cfg_.reachable(b)) {
+                continue;
+            }
+            BasicBlock& block = cfg_.block(b);
+            for (const PhiNode& phi : block.phis) {
+                on_def(phi.result, b, block_start[b]);
+            }
+            uint32_t at = block_start[b];
+            for (PackedInstruction& instr : block.code) {
+                forEachUse(instr, [&](uint32_t& value) { on_use(value, b, at); });
+                if (definesSlot(instr)) {
+                    on_def(instr.operand(P::RESULT), b, at + 1);
+                }
+                at += 2;
+            }
+            if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+                on_use(block.branch.operand(P::ARG1), b, at);
+            }
+            for (uint32_t successor : {block.next, block.isConditional() ? block.target : ControlFlowGraph::NO_BLOCK}) {
+                if (successor == ControlFlowGraph::NO_BLOCK || (successor == block.target && block.next == block.target)) {
+                    continue;
+                }
+                const auto preds = cfg_.predecessors(successor);
+                const size_t i = (size_t)(std::find(preds.begin(), preds.end(), b) - preds.begin());
+                for (const PhiNode& phi : cfg_.block(successor).phis) {
+                    if (phi.args[i].kind == PackedKind::SLOT) {
+                        on_use(phi.args[i].value, b, block_end[b]);
+                    }
+                }
+            }
+        }
+    };
+
+    struct Use {
+        uint32_t block;
+        uint32_t position;
+    };
+    std::pmr::vector<uint32_t> use_offsets(value_count + 1, 0);
+    scan([&](uint32_t value, uint32_t b, uint32_t at) {
+             def_block[value] = b;
+             def_position[value] = at;
+         },
+         [&](uint32_t value, uint32_t, uint32_t) { ++use_offsets[value + 1]; });
+    for (uint32_t v = 0; v < value_count; ++v) {
+        use_offsets[v + 1] += use_offsets[v];
+    }
+    std::pmr::vector<Use> uses(use_offsets[value_count]);
+    {
+        std::pmr::vector<uint32_t> fill(use_offsets.begin(), use_offsets.end() - 1);
+        scan([](uint32_t, uint32_t, uint32_t) {},
+             [&](uint32_t value, uint32_t b, uint32_t at) { uses[fill[value]++] = Use{b, at}; });
+    }
+
+    // Содержимое значения: копия несёт содержимое источника, загрузки одной константы
+    // совпадают. Пересечение интервалов значений с одинаковым содержимым не мешает им
+    // делить слот. Определение доминирует над чтениями, поэтому хватает прохода в RPO
+    std::pmr::vector<uint32_t> content(value_count);
+    std::iota(content.begin(), content.end(), 0u);
+    for (uint32_t b : cfg_.reversePostorder()) {
+        for (const PackedInstruction& instr : cfg_.block(b).code) {
+            if ((instr.op == IROpCode::ASSIGN || instr.op == IROpCode::LOAD_IMM) && definesSlot(instr)) {
+                const uint32_t source = instr.operand(P::ARG1);
+                if (instr.kind(P::ARG1) == PackedKind::SLOT) {
+                    content[instr.operand(P::RESULT)] = content[source];
+                } else if (instr.kind(P::ARG1) == PackedKind::CONST) {
+                    content[instr.operand(P::RESULT)] = value_count + source;
+                }
+            }
+        }
+    }
+
+    // Отрезки жизни значения: от определения и от начала каждого блока, где значение
+    // живо на входе, до последнего чтения в блоке или до конца блока, если оно живо на
+    // выходе. Соседние по нумерации отрезки склеиваются
+    struct Segment {
+        uint32_t start;
+        uint32_t end;
+        uint32_t content;
+    };
+    std::pmr::vector<uint8_t> appears(value_count, 0);
+    std::pmr::vector<uint32_t> segment_offsets(value_count + 1, 0);
+    std::pmr::vector<Segment> segments;
+    {
+        std::pmr::vector<uint32_t> use_mark(block_count, NONE);
+        std::pmr::vector<uint32_t> last_use(block_count, 0);
+        std::pmr::vector<uint32_t> live_in_mark(block_count, NONE);
+        std::pmr::vector<uint32_t> live_out_mark(block_count, NONE);
+        std::pmr::vector<uint32_t> live_in_blocks;
+        std::pmr::vector<uint32_t> worklist;
+        std::pmr::vector<Segment> local;
+        for (uint32_t v = 0; v < value_count; ++v) {
+            segment_offsets[v] = (uint32_t)segments.size();
+            const uint32_t home = def_block[v];
+            const bool used = use_offsets[v] != use_offsets[v + 1];
+            if (home == NONE || (v < entry_values_ && !used)) {
+                continue;
+            }
+            appears[v] = 1;
+
+            live_in_blocks.clear();
+            for (uint32_t i = use_offsets[v]; i < use_offsets[v + 1]; ++i) {
+                const Use& use = uses[i];
+                if (use_mark[use.block] != v) {
+                    use_mark[use.block] = v;
+                    last_use[use.block] = use.position;
+                } else {
+                    last_use[use.block] = std::max(last_use[use.block], use.position);
+                }
+                if (use.position == block_end[use.block]) {
+                    live_out_mark[use.block] = v;
+                }
+                if (use.block != home && live_in_mark[use.block] != v) {
+                    live_in_mark[use.block] = v;
+                    live_in_blocks.push_back(use.block);
+                    worklist.push_back(use.block);
+                }
+            }
+            while (!worklist.empty()) {
+                const uint32_t b = worklist.back();
+                worklist.pop_back();
+                for (uint32_t p : cfg_.predecessors(b)) {
+                    if (!cfg_.reachable(p)) {
+                        continue;
+                    }
+                    live_out_mark[p] = v;
+                    if (p != home && live_in_mark[p] != v) {
+                        live_in_mark[p] = v;
+                        live_in_blocks.push_back(p);
+                        worklist.push_back(p);
+                    }
+                }
+            }
+
+            local.clear();
+            uint32_t def_end = def_position[v];
+            if (live_out_mark[home] == v) {
+                def_end = block_end[home];
+            } else if (use_mark[home] == v) {
+                def_end = std::max(def_end, last_use[home]);
+            }
+            local.push_back(Segment{def_position[v], def_end, content[v]});
+            for (uint32_t b : live_in_blocks) {
+                const uint32_t end = live_out_mark[b] == v ? block_end[b] : use_mark[b] == v ? last_use[b] : block_start[b];
+                local.push_back(Segment{block_start[b], end, content[v]});
+            }
+            std::sort(local.begin(), local.end(), [](const Segment& a, const Segment& b) { return a.start < b.start; });
+            for (const Segment& segment : local) {
+                if (segments.size() > segment_offsets[v] && segment.start <= segments.back().end + 1) {
+                    segments.back().end = std::max(segments.back().end, segment.end);
+                } else {
+                    segments.push_back(segment);
+                }
+            }
+        }
+        segment_offsets[value_count] = (uint32_t)segments.size();
+    }
+
+    // 3. Классы слияния: система непересекающихся множеств. У одиночного значения
+    // отрезки берутся из его списка, у класса-слота (быстрый путь ниже) — из общего
+    // списка слота, у остальных классов — из упорядоченного множества непересекающихся
+    // отрезков (начало -> конец и содержимое). Слияние проверяет отрезки меньшего класса
+    // по большему. Узлы множеств живут до конца выхода из SSA и берутся из монотонного буфера
+    struct Extent {
+        uint32_t end;
+        uint32_t content;
+    };
+    using SegmentSet = std::pmr::map<uint32_t, Extent>;
+    std::pmr::monotonic_buffer_resource set_memory;
+    std::pmr::vector<SegmentSet> sets(&set_memory);
+    std::pmr::vector<uint32_t> parent(value_count);
+    std::iota(parent.begin(), parent.end(), 0u);
+    std::pmr::vector<uint32_t> class_set(value_count, NONE);
+    std::pmr::vector<uint32_t> class_group(value_count, NONE);
+    std::pmr::vector<uint32_t> group_offsets(1, 0);
+    std::pmr::vector<Segment> group_segments;
+    auto find = [&parent](uint32_t v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+    auto classSize = [&](uint32_t root) -> size_t {
+        if (class_set[root] != NONE) {
+            return sets[class_set[root]].size();
+        }
+        if (class_group[root] != NONE) {
+            return group_offsets[class_group[root] + 1] - group_offsets[class_group[root]];
+        }
+        return segment_offsets[root + 1] - segment_offsets[root];
+    };
+    auto forEachSegment = [&](uint32_t root, auto&& f) {
+        if (class_set[root] != NONE) {
+            for (const auto& [start, extent] : sets[class_set[root]]) {
+                if (!f(start, extent)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        const bool group = class_group[root] != NONE;
+        const Segment* list = group ? group_segments.data() : segments.data();
+        const uint32_t first = group ? group_offsets[class_group[root]] : segment_offsets[root];
+        const uint32_t last = group ? group_offsets[class_group[root] + 1] : segment_offsets[root + 1];
+        for (uint32_t i = first; i < last; ++i) {
+            if (!f(list[i].start, Extent{list[i].end, list[i].content})) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Быстрый путь: версии слота вместе с копиями его φ-функций обычно друг другу не
+    // мешают (сразу после построения — всегда). Это проверяется одним проходом по их
+    // отрезкам, упорядоченным по началу: отрезок пересекается с одним из открытых,
+    // только если пересекается с самым длинным из них. Такой слот сразу становится
+    // одним классом, и его копии сливаются без поиска по множествам
+    {
+        std::pmr::vector<std::pair<uint32_t, uint32_t>> slot_pairs;
+        for (uint32_t v = 0; v < value_count; ++v) {
+            if (appears[v]) {
+                slot_pairs.emplace_back(values_[v].slot, v);
+            }
+        }
+        std::pmr::vector<uint32_t> slot_offsets, slot_values;
+        groupByKey(slot_pairs, slot_count, slot_offsets, slot_values);
+        std::pmr::vector<Segment> sweep;
+        for (uint32_t slot = 0; slot < slot_count; ++slot) {
+            if (slot_offsets[slot + 1] - slot_offsets[slot] < 2) {
+                continue;
+            }
+            sweep.clear();
+            for (uint32_t i = slot_offsets[slot]; i < slot_offsets[slot + 1]; ++i) {
+                const uint32_t v = slot_values[i];
+                sweep.insert(sweep.end(), segments.begin() + segment_offsets[v], segments.begin() + segment_offsets[v + 1]);
+            }
+            std::sort(sweep.begin(), sweep.end(), [](const Segment& a, const Segment& b) { return a.start < b.start; });
+            const size_t base = group_segments.size();
+            bool clean = true;
+            for (const Segment& segment : sweep) {
+                if (group_segments.size() > base && segment.start <= group_segments.back().end) {
+                    if (segment.content != group_segments.back().content) {
+                        clean = false;
+                        break;
+                    }
+                    group_segments.back().end = std::max(group_segments.back().end, segment.end);
+                } else {
+                    group_segments.push_back(segment);
+                }
+            }
+            if (!clean) {
+                group_segments.resize(base);
+                continue;
+            }
+            const uint32_t root = slot_values[slot_offsets[slot]];
+            for (uint32_t i = slot_offsets[slot]; i < slot_offsets[slot + 1]; ++i) {
+                parent[slot_values[i]] = root;
+            }
+            class_group[root] = (uint32_t)group_offsets.size() - 1;
+            group_offsets.push_back((uint32_t)group_segments.size());
+        }
+    }
+
+    // Отрезки множества, пересекающие [start, end], идут подряд перед upper_bound(end)
+    auto conflicts = [](const SegmentSet& set, uint32_t start, const Extent& extent) {
+        for (auto it = set.upper_bound(extent.end); it != set.begin();) {
+            --it;
+            if (it->second.end < start) {
+                break;
+            }
+            if (it->second.content != extent.content) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto insert = [](SegmentSet& set, uint32_t start, Extent extent) {
+        auto it = set.upper_bound(extent.end);
+        while (it != set.begin() && std::prev(it)->second.end >= start) {
+            --it;
+            start = std::min(start, it->first);
+            extent.end = std::max(extent.end, it->second.end);
+            it = set.erase(it);
+        }
+        set.emplace(start, extent);
+    };
+    auto merge = [&](uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return true;
+        }
+        if (classSize(a) < classSize(b)) {
+            std::swap(a, b);
+        }
+        if (class_set[a] == NONE) {
+            SegmentSet& set = sets.emplace_back();
+            forEachSegment(a, [&set](uint32_t start, const Extent& extent) {
+                set.emplace_hint(set.end(), start, extent);
+                return true;
+            });
+            class_set[a] = (uint32_t)sets.size() - 1;
+        }
+        SegmentSet& large = sets[class_set[a]];
+        if (!forEachSegment(b, [&](uint32_t start, const Extent& extent) { return !conflicts(large, start, extent); })) {
+            return false;
+        }
+        forEachSegment(b, [&](uint32_t start, const Extent& extent) {
+            insert(large, start, extent);
+            return true;
+        });
+        if (class_set[b] != NONE) {
+            sets[class_set[b]].clear();
+        }
+        parent[b] = a;
+        return true;
+    };
+
+    for (uint32_t b : cfg_.reversePostorder()) {
+        const auto preds = cfg_.predecessors(b);
+        for (const PhiNode& phi : cfg_.block(b).phis) {
+            for (size_t i = 0; i < preds.size(); ++i) {
+                if (cfg_.reachable(preds[i]) && !merge(phi.result, phi.args[i].value)) {
+                    throw std::runtime_error("SSA Error: PHI copies interfere in block B" + std::to_string(b) + ".");
+                }
+            }
+        }
+    }
+
+    // 4. Слияние копий φ-функций, начиная с самых глубоких циклов; затем версии одного
+    // слота, чтобы значения по возможности вернулись в исходный слот
+    struct Candidate {
+        uint32_t depth;
+        uint32_t result;
+        uint32_t source;
+    };
+    std::pmr::vector<Candidate> candidates;
+    for (uint32_t b : cfg_.reversePostorder()) {
+        for (const PackedInstruction& instr : cfg_.block(b).code) {
+            if (instr.op == IROpCode::ASSIGN && instr.kind(P::ARG1) == PackedKind::SLOT &&
+                (instr.operand(P::RESULT) >= first_copy_value || instr.operand(P::ARG1) >= first_copy_value)) {
+                candidates.push_back(Candidate{cfg_.loopDepth(b), instr.operand(P::RESULT), instr.operand(P::ARG1)});
+            }
+        }
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.depth > b.depth; });
+    for (const Candidate& candidate : candidates) {
+        merge(candidate.result, candidate.source);
+    }
+    std::pmr::vector<uint32_t> slot_anchor(slot_count, NONE);
+    for (uint32_t v = 0; v < value_count; ++v) {
+        if (!appears[v]) {
+            continue;
+        }
+        uint32_t& anchor = slot_anchor[values_[v].slot];
+        if (anchor == NONE) {
+            anchor = v;
+        } else {
+            merge(anchor, v);
+        }
+    }
+
+    // 5. Слоты классов: первый свободный исходный слот участника, иначе новый временный
+    std::pmr::vector<uint32_t> class_slot(value_count, NONE);
+    std::pmr::vector<uint8_t> claimed(slot_count, 0);
+    for (uint32_t v = 0; v < value_count; ++v) {
+        const uint32_t root = find(v);
+        if (appears[v] && class_slot[root] == NONE && !claimed[values_[v].slot]) {
+            class_slot[root] = values_[v].slot;
+            claimed[values_[v].slot] = 1;
+        }
+    }
+    uint32_t next_temp = 1;
+    for (const PackedSlot& slot : code_.slots()) {
+        if (slot.type == OperandType::TEMPORARY) {
+            next_temp = std::max(next_temp, slot.id + 1);
+        }
+    }
+    for (uint32_t v = 0; v < value_count; ++v) {
+        const uint32_t root = find(v);
+        if (appears[v] && class_slot[root] == NONE) {
+            class_slot[root] = code_.addSlot(PackedSlot{OperandType::TEMPORARY, next_temp++});
+        }
+    }
+
+    // 6. Значения заменяются слотами классов, копии внутри одного слота удаляются
+    for (uint32_t b = 0; b < block_count; ++b) {
+        BasicBlock& block = cfg_.block(b);
+        block.phis.clear();
+        if (!cfg_.reachable(b)) {
+            continue;
+        }
+        auto toSlot = [&](uint32_t& value) { value = class_slot[find(value)]; };
+        size_t kept = 0;
+        for (size_t i = 0; i < block.code.size(); ++i) {
+            PackedInstruction instr = block.code[i];
+            const bool inserted = instr.op == IROpCode::ASSIGN && instr.kind(P::ARG1) == PackedKind::SLOT &&
+                (instr.operand(P::RESULT) >= first_copy_value || instr.operand(P::ARG1) >= first_copy_value);
+            forEachUse(instr, toSlot);
+            if (definesSlot(instr)) {
+                toSlot(instr.operands[P::RESULT]);
+            }
+            if (instr.op == IROpCode::ASSIGN && instr.kind(P::ARG1) == PackedKind::SLOT &&
+                instr.operand(P::RESULT) == instr.operand(P::ARG1)) {
+                copies_coalesced_ += inserted;
+                continue;
+            }
+            block.code[kept++] = instr;
+        }
+        block.code.resize(kept);
+        if (block.isConditional() && block.branch.kind(P::ARG1) == PackedKind::SLOT) {
+            toSlot(block.branch.operands[P::ARG1]);
+        }
+    }
+}
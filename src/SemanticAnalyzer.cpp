@@ -0,0 +1,343 @@
+#include "SemanticAnalyzer.h"
+
+namespace {
+    std::string quoted(SymbolId name) {
+        return "'" + std::string(SymbolInterner::global().name(name)) + "'";
+    }
+}
+
+// --- Таблица символов ---
+
+int SymbolTable::declare(SymbolId name) {
+    if (slots_.size() <= name) {
+        slots_.resize((size_t)name + 1, NO_SLOT);
+    }
+    if (slots_[name] != NO_SLOT) {
+        return NO_SLOT;
+    }
+    ++variable_count_;
+    slots_[name] = slot_count_;
+    return slot_count_++;
+}
+
+void SymbolTable::clear() {
+    slots_.clear();
+    checked_.clear();
+    variable_count_ = 0;
+    slot_count_ = 0;
+}
+
+// --- Семантический анализ ---
+
+SemanticAnalyzer::SemanticAnalyzer(SymbolTable& symbols, ErrorHandler* handler)
+    : symbols_(symbols), error_handler_(handler) {
+}
+
+// Массивы состояния растут вместе с числом слотов (временные переменные тоже занимают слоты)
+void SemanticAnalyzer::resize() {
+    const size_t count = (size_t)symbols_.slotCount();
+    if (assigned_.size() < count) {
+        assigned_.resize(count, 0);
+        maybe_.resize(count, 0);
+        reported_.resize(count, 0);
+        marks_.resize(count, 0);
+    }
+}
+
+void SemanticAnalyzer::errorOnce(int slot, SourcePos pos, const std::string& message) {
+    if (!(reported_[slot] & REPORTED_ERROR)) {
+        reported_[slot] |= REPORTED_ERROR;
+        error_handler_->registerError("Semantic", message, pos.line, pos.position);
+    }
+}
+
+// Предупреждение о чтении, которое может опередить присваивание; чтения переменной
+// будут проверяться при выполнении
+void SemanticAnalyzer::warnOnce(int slot, SymbolId name, SourcePos pos) {
+    if (!reported_[slot]) {
+        reported_[slot] = REPORTED_WARNING;
+        symbols_.requireCheck(slot);
+        error_handler_->registerWarning("Semantic", "Variable " + quoted(name) + " may be used before assignment.",
+                                        pos.line, pos.position);
+    }
+}
+
+void SemanticAnalyzer::markAssigned(int slot) {
+    if (!assigned_[slot]) {
+        assigned_[slot] = 1;
+        trail_.push_back(slot);
+    }
+    markMaybe(slot);
+}
+
+void SemanticAnalyzer::markMaybe(int slot) {
+    if (!maybe_[slot]) {
+        maybe_[slot] = 1;
+        maybe_trail_.push_back(slot);
+    }
+}
+
+// Отмена присваиваний, сделанных после позиции журнала trail_start
+void SemanticAnalyzer::rollback(size_t trail_start) {
+    for (size_t i = trail_start; i < trail_.size(); ++i) {
+        assigned_[trail_[i]] = 0;
+    }
+    trail_.resize(trail_start);
+}
+
+void SemanticAnalyzer::rollbackMaybe(size_t maybe_start) {
+    for (size_t i = maybe_start; i < maybe_trail_.size(); ++i) {
+        maybe_[maybe_trail_[i]] = 0;
+    }
+    maybe_trail_.resize(maybe_start);
+}
+
+void SemanticAnalyzer::declare(SymbolId name, SourcePos pos) {
+    if (symbols_.declare(name) == SymbolTable::NO_SLOT) {
+        error_handler_->registerError("Semantic", "Variable " + quoted(name) + " is already declared.", pos.line, pos.position);
+    }
+    resize();
+}
+
+int SemanticAnalyzer::use(SymbolId name, SourcePos pos) {
+    int slot = symbols_.find(name);
+    if (slot == SymbolTable::NO_SLOT) {
+        slot = symbols_.declare(name);
+        resize();
+        errorOnce(slot, pos, "Variable " + quoted(name) + " is not declared.");
+    } else if (!assigned_[slot]) {
+        if (maybe_[slot]) {
+            warnOnce(slot, name, pos);
+        } else if (loop_depth_ > 0) {
+            pending_.push_back(PendingRead{slot, name, pos});
+        } else {
+            errorOnce(slot, pos, "Variable " + quoted(name) + " is used before assignment.");
+        }
+    }
+    return slot;
+}
+
+int SemanticAnalyzer::assign(SymbolId name, SourcePos pos) {
+    int slot = symbols_.find(name);
+    if (slot == SymbolTable::NO_SLOT) {
+        slot = symbols_.declare(name);
+        resize();
+        errorOnce(slot, pos, "Variable " + quoted(name) + " is not declared.");
+    }
+    markAssigned(slot);
+    return slot;
+}
+
+void SemanticAnalyzer::beginBranch() {
+    branches_.push_back(Branch{trail_.size(), saved_.size(), maybe_trail_.size(), maybe_saved_.size(), pending_.size(), false});
+}
+
+// Присвоенное в then откладывается до конца if, ветвь else начинается с состояния до if
+void SemanticAnalyzer::beginElse() {
+    Branch& branch = branches_.back();
+    saved_.insert(saved_.end(), trail_.begin() + (std::ptrdiff_t)branch.trail_start, trail_.end());
+    rollback(branch.trail_start);
+    maybe_saved_.insert(maybe_saved_.end(), maybe_trail_.begin() + (std::ptrdiff_t)branch.maybe_start, maybe_trail_.end());
+    rollbackMaybe(branch.maybe_start);
+    branch.has_else = true;
+}
+
+// После if определённо присвоено только то, что присвоено в обеих ветвях, а возможно
+// присвоенное объединяется
+void SemanticAnalyzer::endIf() {
+    Branch branch = branches_.back();
+    branches_.pop_back();
+    if (!branch.has_else) {
+        rollback(branch.trail_start);
+        return;
+    }
+
+    ++mark_epoch_;
+    for (size_t i = branch.trail_start; i < trail_.size(); ++i) {
+        marks_[trail_[i]] = mark_epoch_;
+    }
+    rollback(branch.trail_start);
+    for (size_t i = branch.saved_start; i < saved_.size(); ++i) {
+        if (marks_[saved_[i]] == mark_epoch_) {
+            markAssigned(saved_[i]);
+        }
+    }
+    saved_.resize(branch.saved_start);
+    for (size_t i = branch.maybe_saved_start; i < maybe_saved_.size(); ++i) {
+        markMaybe(maybe_saved_[i]);
+    }
+    maybe_saved_.resize(branch.maybe_saved_start);
+}
+
+void SemanticAnalyzer::beginLoop() {
+    beginBranch();
+    ++loop_depth_;
+}
+
+// Тело цикла может не выполниться ни разу. Отложенные чтения тела, переменная которых
+// к концу тела возможно присвоена, достижимы из присваивания по обратной дуге; остальные
+// ждут конца внешнего цикла
+void SemanticAnalyzer::endWhile() {
+    Branch branch = branches_.back();
+    branches_.pop_back();
+    --loop_depth_;
+
+    size_t kept = branch.pending_start;
+    for (size_t i = branch.pending_start; i < pending_.size(); ++i) {
+        if (maybe_[pending_[i].slot]) {
+            warnOnce(pending_[i].slot, pending_[i].name, pending_[i].pos);
+        } else {
+            pending_[kept++] = pending_[i];
+        }
+    }
+    pending_.resize(kept);
+    rollback(branch.trail_start);
+}
+
+void SemanticAnalyzer::finish() {
+    for (const PendingRead& read : pending_) {
+        errorOnce(read.slot, read.pos, "Variable " + quoted(read.name) + " is used before assignment.");
+    }
+    pending_.clear();
+}
+
+// --- Обход дерева ---
+
+bool SemanticAnalyzer::analyze(ASTNode& root) {
+    const size_t errors_before = error_handler_->getErrors().size();
+    dispatch(root);
+    finish();
+    return error_handler_->getErrors().size() == errors_before;
+}
+
+// Порядок чтений внутри выражения не важен: все они предшествуют записи оператора
+void SemanticAnalyzer::useExpression(const ASTNode& expression) {
+    expression_stack_.push_back(&expression);
+    while (!expression_stack_.empty()) {
+        const ASTNode* node = expression_stack_.back();
+        expression_stack_.pop_back();
+        if (node->node_kind == ASTNodeKind::IDENTIFIER) {
+            const IdentifierNode* identifier = static_cast<const IdentifierNode*>(node);
+            use(identifier->name, identifier->pos);
+        } else if (node->node_kind == ASTNodeKind::BINARY_OP) {
+            const BinaryOpNode* binary = static_cast<const BinaryOpNode*>(node);
+            expression_stack_.push_back(binary->right.get());
+            expression_stack_.push_back(binary->left.get());
+        }
+    }
+}
+
+void SemanticAnalyzer::visit(ProgramNode& node) {
+    for (const auto& stmt : node.statements) {
+        dispatch(*stmt);
+    }
+}
+
+void SemanticAnalyzer::visit(VarDeclNode& node) {
+    declare(node.name, node.pos);
+}
+
+void SemanticAnalyzer::visit(AssignStmtNode& node) {
+    useExpression(*node.expression);
+    assign(node.identifier_name, node.pos);
+}
+
+void SemanticAnalyzer::visit(PrintStmtNode& node) {
+    useExpression(*node.expression);
+}
+
+void SemanticAnalyzer::visit(IfStmtNode& node) {
+    useExpression(*node.condition);
+    beginBranch();
+    visit(*node.then_body);
+    if (node.else_body) {
+        beginElse();
+        visit(*node.else_body);
+    }
+    endIf();
+}
+
+void SemanticAnalyzer::visit(WhileStmtNode& node) {
+    useExpression(*node.condition);
+    beginLoop();
+    visit(*node.body);
+    endWhile();
+}
+
+void SemanticAnalyzer::visit(BinaryOpNode& node) {
+    useExpression(node);
+}
+
+void SemanticAnalyzer::visit(IntLiteralNode&) {
+}
+
+void SemanticAnalyzer::visit(IdentifierNode& node) {
+    use(node.name, node.pos);
+}
+
+void SemanticAnalyzer::visit(TerminalNode&) {
+}
+
+// --- Обход плоского AST ---
+
+bool SemanticAnalyzer::analyze(const FlatAST& ast) {
+    const size_t errors_before = error_handler_->getErrors().size();
+    if (ast.root() != FlatAST::NO_NODE) {
+        analyzeStatement(ast, ast.root());
+    }
+    finish();
+    return error_handler_->getErrors().size() == errors_before;
+}
+
+void SemanticAnalyzer::useExpression(const FlatAST& ast, FlatAST::NodeIndex node) {
+    flat_stack_.push_back(node);
+    while (!flat_stack_.empty()) {
+        const FlatAST::NodeIndex current = flat_stack_.back();
+        flat_stack_.pop_back();
+        if (ast.kind(current) == FlatNodeKind::IDENTIFIER) {
+            use(ast.symbol(current), ast.position(current));
+        } else if (ast.kind(current) == FlatNodeKind::BINARY_OP) {
+            flat_stack_.push_back(ast.second(current));
+            flat_stack_.push_back(ast.first(current));
+        }
+    }
+}
+
+void SemanticAnalyzer::analyzeStatement(const FlatAST& ast, FlatAST::NodeIndex node) {
+    switch (ast.kind(node)) {
+        case FlatNodeKind::PROGRAM:
+            for (FlatAST::NodeIndex stmt : ast.statements(node)) {
+                analyzeStatement(ast, stmt);
+            }
+            break;
+        case FlatNodeKind::VAR_DECL:
+            declare(ast.symbol(node), ast.position(node));
+            break;
+        case FlatNodeKind::ASSIGN_STMT:
+            useExpression(ast, ast.second(node));
+            assign(ast.symbol(node), ast.position(node));
+            break;
+        case FlatNodeKind::PRINT_STMT:
+            useExpression(ast, ast.first(node));
+            break;
+        case FlatNodeKind::IF_STMT:
+            useExpression(ast, ast.first(node));
+            beginBranch();
+            analyzeStatement(ast, ast.second(node));
+            if (ast.third(node) != FlatAST::NO_NODE) {
+                beginElse();
+                analyzeStatement(ast, ast.third(node));
+            }
+            endIf();
+            break;
+        case FlatNodeKind::WHILE_STMT:
+            useExpression(ast, ast.first(node));
+            beginLoop();
+            analyzeStatement(ast, ast.second(node));
+            endWhile();
+            break;
+        default:
+            useExpression(ast, node);
+            break;
+    }
+}
@@ -0,0 +1,150 @@
+#include "SessionArena.h"
+#include <algorithm>
+#include <new>
+#include <atomic>
+#include <stdexcept>
+
+namespace {
+    thread_local SessionArena* active_arena = nullptr;
+
+    // Область меняет ресурс pmr по умолчанию всего процесса, поэтому области могут
+    // вкладываться в одном потоке, но не быть открытыми в двух потоках одновременно
+    std::atomic<std::thread::id> scope_thread{};
+    thread_local size_t scope_depth = 0;
+
+    size_t alignUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+SessionArena::SessionArena(size_t block_size)
+    : default_block_size_(std::max<size_t>(block_size, 4096)),
+      owner_(std::this_thread::get_id()) {
+}
+
+SessionArena::~SessionArena() {
+    for (const Block& block : blocks_) {
+        ::operator delete(block.data);
+    }
+}
+
+// Новый блок: не меньше запроса и вдвое больше предыдущего (число блоков логарифмично)
+void SessionArena::addBlock(size_t min_size) {
+    size_t size = std::max(default_block_size_, min_size);
+    if (!blocks_.empty()) {
+        size = std::max(size, blocks_.back().size * 2);
+    }
+    char* data = static_cast<char*>(::operator new(size));
+    std::lock_guard<std::mutex> lock(blocks_mutex_);
+    blocks_.push_back(Block{data, size});
+    ++block_allocations_;
+}
+
+bool SessionArena::owns(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    for (const Block& block : blocks_) {
+        if (p >= block.data && p < block.data + block.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void* SessionArena::do_allocate(size_t bytes, size_t alignment) {
+    if (std::this_thread::get_id() != owner_) {
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    bytes = std::max<size_t>(bytes, 1);
+    while (current_block_ < blocks_.size()) {
+        Block& block = blocks_[current_block_];
+        size_t start = alignUp((size_t)(block.data + offset_), alignment) - (size_t)block.data;
+        if (start + bytes <= block.size) {
+            offset_ = start + bytes;
+            bytes_used_ += bytes;
+            peak_bytes_used_ = std::max(peak_bytes_used_, bytes_used_);
+            return block.data + start;
+        }
+        ++current_block_;
+        offset_ = 0;
+    }
+
+    addBlock(bytes + alignment);
+    return do_allocate(bytes, alignment);
+}
+
+// Отдельные объекты арены не освобождаются; память из кучи (чужие потоки) возвращается.
+// Владелец может в это время добавлять блоки, поэтому чужой поток проверяет их под блокировкой
+void SessionArena::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    bool from_arena;
+    if (std::this_thread::get_id() == owner_) {
+        from_arena = owns(ptr);
+    } else {
+        std::lock_guard<std::mutex> lock(blocks_mutex_);
+        from_arena = owns(ptr);
+    }
+    if (!from_arena) {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+}
+
+bool SessionArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+// Сброс: если сеанс занял несколько блоков, они заменяются одним блоком общего
+// размера, чтобы следующий файл того же объёма поместился без новых выделений
+void SessionArena::reset() {
+    if (blocks_.size() > 1) {
+        size_t total = bytesReserved();
+        std::lock_guard<std::mutex> lock(blocks_mutex_);
+        for (const Block& block : blocks_) {
+            ::operator delete(block.data);
+        }
+        blocks_.clear();
+        char* data = static_cast<char*>(::operator new(total));
+        blocks_.push_back(Block{data, total});
+        ++block_allocations_;
+    }
+    current_block_ = 0;
+    offset_ = 0;
+    last_session_bytes_ = bytes_used_;
+    bytes_used_ = 0;
+}
+
+size_t SessionArena::bytesReserved() const {
+    size_t total = 0;
+    for (const Block& block : blocks_) {
+        total += block.size;
+    }
+    return total;
+}
+
+SessionArena* SessionArena::current() {
+    return active_arena;
+}
+
+std::pmr::memory_resource* SessionArena::resource() {
+    return active_arena ? static_cast<std::pmr::memory_resource*>(active_arena) : std::pmr::new_delete_resource();
+}
+
+SessionArena::Scope::Scope(SessionArena& arena) : arena_(arena), previous_arena_(active_arena) {
+    if (scope_depth == 0) {
+        std::thread::id expected{};
+        if (!scope_thread.compare_exchange_strong(expected, std::this_thread::get_id())) {
+            throw std::runtime_error("Session Arena Error: a scope is already active on another thread.");
+        }
+    }
+    ++scope_depth;
+    previous_default_ = std::pmr::set_default_resource(&arena);
+    active_arena = &arena;
+}
+
+SessionArena::Scope::~Scope() {
+    std::pmr::set_default_resource(previous_default_);
+    active_arena = previous_arena_;
+    arena_.reset();
+    if (--scope_depth == 0) {
+        scope_thread.store(std::thread::id{});
+    }
+}
@@ -0,0 +1,96 @@
+#include "SourceBuffer.h"
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_BUFFER_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define SOURCE_BUFFER_HAS_MMAP 0
+#endif
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapped_ = other.mapped_;
+        size_ = other.size_;
+        fallback_ = std::move(other.fallback_);
+        data_ = mapped_ ? other.data_ : fallback_.data();
+
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+// Освобождение отображения или резервного буфера
+void SourceBuffer::release() {
+#if SOURCE_BUFFER_HAS_MMAP
+    if (mapped_ && data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    fallback_.clear();
+}
+
+// Открытие файла: mmap, а при невозможности — однократное чтение в строку
+bool SourceBuffer::open(const std::string& path) {
+    release();
+
+#if SOURCE_BUFFER_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            ::close(fd);
+            data_ = fallback_.data();
+            return true;
+        }
+
+        void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            ::close(fd);
+            madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+            size_ = (size_t)st.st_size;
+            mapped_ = true;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (!ifs.is_open()) {
+        return false;
+    }
+    std::streamsize length = ifs.tellg();
+    ifs.seekg(0, std::ios::beg);
+    fallback_.resize(length > 0 ? (size_t)length : 0);
+    if (length > 0 && !ifs.read(fallback_.data(), length)) {
+        fallback_.clear();
+        return false;
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+    return true;
+}
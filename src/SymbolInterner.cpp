@@ -0,0 +1,108 @@
+#include "SymbolInterner.h"
+#include <algorithm>
+#include <cstring>
+
+SymbolInterner::SymbolInterner() : table_(1024, Slot{0, 0}) {
+}
+
+SymbolInterner& SymbolInterner::global() {
+    static SymbolInterner interner;
+    return interner;
+}
+
+// Хеш словами по 8 байт: имена короткие, и побайтовый FNV-1a тратил на них больше, чем
+// сама проба таблицы. Хвост короче слова читается двумя перекрывающимися загрузками
+// (4..7 байт) или тремя байтами (1..3), поэтому ветвлений по длине почти нет
+uint32_t SymbolInterner::hash(std::string_view name) {
+    constexpr uint64_t K0 = 0x9E3779B97F4A7C15ull;
+    constexpr uint64_t K1 = 0xFF51AFD7ED558CCDull;
+    const unsigned char* p = (const unsigned char*)name.data();
+    const size_t n = name.size();
+
+    uint64_t h = (uint64_t)n * K0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        h = (h ^ word) * K1;
+        h ^= h >> 29;
+    }
+    const size_t rest = n - i;
+    uint64_t tail = 0;
+    if (rest >= 4) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p + i, 4);
+        std::memcpy(&hi, p + i + rest - 4, 4);
+        tail = ((uint64_t)hi << 32) | lo;
+    } else if (rest > 0) {
+        tail = p[i] | ((uint64_t)p[i + rest / 2] << 8) | ((uint64_t)p[i + rest - 1] << 16);
+    }
+    h = (h ^ tail) * K1;
+    // Номер ячейки берётся из младших битов, а у произведения они зависят только от
+    // младших битов слова: без второго перемешивания имена v1, v2, ... ложатся кучно
+    h ^= h >> 32;
+    h *= K0;
+    return (uint32_t)(h ^ (h >> 29));
+}
+
+// Копирование символов имени в блок (длинное имя получает отдельный блок)
+std::string_view SymbolInterner::store(std::string_view name) {
+    if (name.size() > BLOCK_SIZE - block_used_) {
+        blocks_.emplace_back(new char[std::max(name.size(), BLOCK_SIZE)]);
+        block_used_ = 0;
+    }
+    char* dest = blocks_.back().get() + block_used_;
+    if (!name.empty()) {
+        std::memcpy(dest, name.data(), name.size());
+    }
+    block_used_ += name.size();
+    return std::string_view(dest, name.size());
+}
+
+// Удвоение таблицы при заполнении наполовину
+void SymbolInterner::grow() {
+    std::vector<Slot> table(table_.size() * 2, Slot{0, 0});
+    const uint32_t mask = (uint32_t)table.size() - 1;
+    for (const Slot& slot : table_) {
+        if (slot.id_plus_one == 0) {
+            continue;
+        }
+        uint32_t i = slot.hash & mask;
+        while (table[i].id_plus_one != 0) {
+            i = (i + 1) & mask;
+        }
+        table[i] = slot;
+    }
+    table_.swap(table);
+}
+
+SymbolId SymbolInterner::intern(std::string_view name) {
+    const uint32_t h = hash(name);
+    const uint32_t mask = (uint32_t)table_.size() - 1;
+    uint32_t i = h & mask;
+    while (table_[i].id_plus_one != 0) {
+        if (table_[i].hash == h && names_[table_[i].id_plus_one - 1] == name) {
+            return table_[i].id_plus_one - 1;
+        }
+        i = (i + 1) & mask;
+    }
+
+    const SymbolId id = (SymbolId)names_.size();
+    names_.push_back(store(name));
+    table_[i] = Slot{h, id + 1};
+    if (names_.size() * 2 > table_.size()) {
+        grow();
+    }
+    return id;
+}
+
+SymbolId SymbolInterner::find(std::string_view name) const {
+    const uint32_t h = hash(name);
+    const uint32_t mask = (uint32_t)table_.size() - 1;
+    for (uint32_t i = h & mask; table_[i].id_plus_one != 0; i = (i + 1) & mask) {
+        if (table_[i].hash == h && names_[table_[i].id_plus_one - 1] == name) {
+            return table_[i].id_plus_one - 1;
+        }
+    }
+    return NO_SYMBOL;
+}
@@ -0,0 +1,182 @@
+#include "TokenStore.h"
+#include <algorithm>
+
+size_t TokenStore::blockOf(size_t index) const {
+    auto it = std::upper_bound(states_.begin(), states_.end(), index,
+                               [](size_t i, const BlockState& state) { return i < state.start; });
+    return (size_t)(it - states_.begin()) - 1;
+}
+
+// Значения токенов блока переносятся в текущий буфер со сдвигом, номера строк сдвигаются
+void TokenStore::materialize(size_t block) const {
+    BlockState& state = states_[block];
+    if (state.base == base_ && state.offset_shift == 0 && state.line_shift == 0) {
+        return;
+    }
+    for (Token& token : blocks_[block]) {
+        const std::ptrdiff_t offset = (token.value.data() - state.base) + state.offset_shift;
+        token.value = std::string_view(base_ + offset, token.value.size());
+        token.line += state.line_shift;
+    }
+    state.base = base_;
+    state.offset_shift = 0;
+    state.line_shift = 0;
+}
+
+Token& TokenStore::locate(size_t index) const {
+    if (index >= count_) {
+        return eof_;
+    }
+    const size_t block = blockOf(index);
+    materialize(block);
+    cursor_begin_ = states_[block].start;
+    cursor_end_ = cursor_begin_ + blocks_[block].size();
+    cursor_ = blocks_[block].data();
+    return cursor_[index - cursor_begin_];
+}
+
+size_t TokenStore::offsetOf(size_t index) const {
+    const size_t block = blockOf(index);
+    const BlockState& state = states_[block];
+    const Token& token = blocks_[block][index - state.start];
+    return (size_t)((token.value.data() - state.base) + state.offset_shift);
+}
+
+void TokenStore::clear() {
+    resetCursor();
+    blocks_.clear();
+    states_.clear();
+    count_ = 0;
+    eof_ = Token();
+    has_eof_ = false;
+}
+
+void TokenStore::reserve(size_t count) {
+    blocks_.reserve(count / BLOCK_TOKENS + 1);
+    states_.reserve(count / BLOCK_TOKENS + 1);
+}
+
+void TokenStore::push_back(const Token& token) {
+    resetCursor();
+    if (blocks_.empty() || blocks_.back().size() >= BLOCK_TOKENS) {
+        blocks_.emplace_back().reserve(BLOCK_TOKENS);
+        states_.push_back(BlockState{count_, 0, 0, base_});
+    } else {
+        materialize(blocks_.size() - 1);
+    }
+    blocks_.back().push_back(token);
+    ++count_;
+}
+
+void TokenStore::setEof(const Token& token) {
+    resetCursor();
+    eof_ = token;
+    has_eof_ = true;
+}
+
+void TokenStore::resize(size_t count) {
+    resetCursor();
+    blocks_.clear();
+    states_.clear();
+    reserve(count);
+    for (size_t start = 0; start < count; start += BLOCK_TOKENS) {
+        blocks_.emplace_back(std::min(BLOCK_TOKENS, count - start));
+        states_.push_back(BlockState{start, 0, 0, base_});
+    }
+    count_ = count;
+}
+
+void TokenStore::rebase(const char* base) {
+    resetCursor();
+    base_ = base;
+}
+
+// Блок первого сдвигаемого токена правится сразу, следующие — через заголовки
+void TokenStore::shift(size_t from, std::ptrdiff_t offset_delta, int line_delta) {
+    resetCursor();
+    if (from < count_) {
+        const size_t block = blockOf(from);
+        materialize(block);
+        std::pmr::vector<Token>& tokens = blocks_[block];
+        for (size_t i = from - states_[block].start; i < tokens.size(); ++i) {
+            tokens[i].value = std::string_view(tokens[i].value.data() + offset_delta, tokens[i].value.size());
+            tokens[i].line += line_delta;
+        }
+        for (size_t b = block + 1; b < states_.size(); ++b) {
+            states_[b].offset_shift += offset_delta;
+            states_[b].line_shift += line_delta;
+        }
+    }
+    if (has_eof_) {
+        eof_.line += line_delta;
+    }
+}
+
+// Задетые блоки собираются заново и режутся на куски не больше 2 * BLOCK_TOKENS;
+// слишком маленький результат забирает соседний блок, чтобы блоки не мельчали
+void TokenStore::replace(size_t first, size_t last, const std::vector<Token>& fresh) {
+    resetCursor();
+    if (blocks_.empty()) {
+        for (const Token& token : fresh) {
+            push_back(token);
+        }
+        return;
+    }
+
+    size_t lo = first < count_ ? blockOf(first) : blocks_.size() - 1;
+    size_t hi = last > first ? blockOf(last - 1) : lo;
+    auto mergedSize = [&]() {
+        return states_[hi].start + blocks_[hi].size() - states_[lo].start - (last - first) + fresh.size();
+    };
+    if (mergedSize() < BLOCK_TOKENS / 4) {
+        if (hi + 1 < blocks_.size()) {
+            ++hi;
+        } else if (lo > 0) {
+            --lo;
+        }
+    }
+
+    std::vector<Token> merged;
+    merged.reserve(mergedSize());
+    auto copyRange = [&](size_t from, size_t to) {
+        for (size_t b = lo; b <= hi; ++b) {
+            materialize(b);
+            const size_t begin = std::max(from, states_[b].start);
+            const size_t end = std::min(to, states_[b].start + blocks_[b].size());
+            if (begin < end) {
+                merged.insert(merged.end(), blocks_[b].begin() + (std::ptrdiff_t)(begin - states_[b].start),
+                              blocks_[b].begin() + (std::ptrdiff_t)(end - states_[b].start));
+            }
+        }
+    };
+    copyRange(states_[lo].start, first);
+    merged.insert(merged.end(), fresh.begin(), fresh.end());
+    copyRange(last, states_[hi].start + blocks_[hi].size());
+
+    const size_t n = merged.size();
+    const size_t pieces = n == 0 ? 0 : n <= 2 * BLOCK_TOKENS ? 1 : (n + BLOCK_TOKENS - 1) / BLOCK_TOKENS;
+    const size_t old_blocks = hi - lo + 1;
+    if (pieces < old_blocks) {
+        blocks_.erase(blocks_.begin() + (std::ptrdiff_t)(lo + pieces), blocks_.begin() + (std::ptrdiff_t)(hi + 1));
+        states_.erase(states_.begin() + (std::ptrdiff_t)(lo + pieces), states_.begin() + (std::ptrdiff_t)(hi + 1));
+    } else if (pieces > old_blocks) {
+        blocks_.insert(blocks_.begin() + (std::ptrdiff_t)(hi + 1), pieces - old_blocks,
+                       std::pmr::vector<Token>(blocks_.get_allocator()));
+        states_.insert(states_.begin() + (std::ptrdiff_t)(hi + 1), pieces - old_blocks, BlockState{});
+    }
+    for (size_t p = 0; p < pieces; ++p) {
+        blocks_[lo + p].assign(merged.begin() + (std::ptrdiff_t)(n * p / pieces),
+                               merged.begin() + (std::ptrdiff_t)(n * (p + 1) / pieces));
+        states_[lo + p] = BlockState{0, 0, 0, base_};
+    }
+    count_ = count_ - (last - first) + fresh.size();
+    restart(lo);
+}
+
+void TokenStore::restart(size_t from_block) {
+    size_t start = from_block > 0 ? states_[from_block - 1].start + blocks_[from_block - 1].size() : 0;
+    for (size_t b = from_block; b < states_.size(); ++b) {
+        states_[b].start = start;
+        start += blocks_[b].size();
+    }
+}